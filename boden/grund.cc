@@ -27,10 +27,11 @@
 #include "../descriptor/tunnel_desc.h"
 #include "../descriptor/way_desc.h"
 
-#include "../dataobj/freelist.h"
+#include "../dataobj/tile_arena.h"
 #include "../dataobj/loadsave.h"
 #include "../dataobj/translator.h"
 #include "../dataobj/environment.h"
+#include "../dataobj/block_graph.h"
 
 #include "../obj/baum.h"
 #include "../obj/crossing.h"
@@ -165,13 +166,13 @@ PLAYER_COLOR_VAL grund_t::text_farbe() const
 
 void* grund_t::operator new(size_t s)
 {
-	return freelist_t::gimme_node(s);
+	return tile_arena_t::alloc(s);
 }
 
 
 void grund_t::operator delete(void* p, size_t s)
 {
-	return freelist_t::putback_node(s, p);
+	tile_arena_t::free(p, s);
 }
 
 
@@ -583,6 +584,7 @@ void grund_t::take_obj_from(grund_t* other_gr)
 		flags |= has_way2;
 		other_gr->clear_flag(has_way2);
 	}
+	welt->city_tile_changed( pos.get_2d() );
 }
 
 
@@ -732,6 +734,11 @@ void grund_t::set_halt(halthandle_t halt)
 	}
 	// then add or remove halt flag
 	// and record the halt
+	const bool was_halt = (flags & is_halt_flag) != 0;
+	if(  this_halt != halt  ||  was_halt != add  ) {
+		haltestelle_t::halts_changed();
+		block_graph_t::tile_changed(pos);
+	}
 	if(  add  ) {
 		this_halt = halt;
 		flags |= is_halt_flag|dirty;
@@ -741,6 +748,9 @@ void grund_t::set_halt(halthandle_t halt)
 		flags &= ~is_halt_flag;
 		flags |= dirty;
 	}
+	if(  was_halt != add  &&  ist_karten_boden()  ) {
+		welt->city_tile_changed( pos.get_2d() );
+	}
 }
 
 
@@ -1901,6 +1911,9 @@ sint64 grund_t::neuen_weg_bauen(weg_t *weg, ribi_t::ribi ribi, player_t *player,
 			weg->set_pos(pos);
 			objlist.add( weg );
 			flags |= has_way1;
+			if(  ist_karten_boden()  ) {
+				welt->city_tile_changed( pos.get_2d() );
+			}
 		}
 		else
 		{
@@ -2014,6 +2027,9 @@ sint32 grund_t::weg_entfernen(waytype_t wegtyp, bool ribi_rem)
 		}
 		else {
 			flags &= ~has_way1;
+			if(  ist_karten_boden()  ) {
+				welt->city_tile_changed( pos.get_2d() );
+			}
 		}
 
 		calc_image();
@@ -6,6 +6,7 @@
  */
 
 #include "../../simworld.h"
+#include "../../simconvoi.h"
 #include "../../bauer/wegbauer.h"
 #include "../../descriptor/way_desc.h"
 #include "../../dataobj/loadsave.h"
@@ -90,8 +91,8 @@ void runway_t::rdwr(loadsave_t *file)
 
 	if (file->get_extended_version() >= 13 || file->get_extended_revision() >= 20)
 	{
-		uint16 reserved_index = reserved.get_id();
-		file->rdwr_short(reserved_index);
+		uint32 reserved_index = reserved.get_id();
+		convoi_t::rdwr_convoy_id(file, reserved_index, 15);
 		reserved.set_id(reserved_index);
 	}
 }
@@ -35,12 +35,14 @@ bool schiene_t::show_reservations = false;
 schiene_t::schiene_t(waytype_t waytype) : weg_t (waytype)
 {
 	reserved = convoihandle_t();
+	reserved_tiles_index = NOT_LISTED;
 }
 
 
 schiene_t::schiene_t() : weg_t(track_wt)
 {
 	reserved = convoihandle_t();
+	reserved_tiles_index = NOT_LISTED;
 	type = block;
 	set_desc(schiene_t::default_schiene);
 }
@@ -49,11 +51,46 @@ schiene_t::schiene_t() : weg_t(track_wt)
 schiene_t::schiene_t(loadsave_t *file) : weg_t(track_wt)
 {
 	reserved = convoihandle_t();
+	reserved_tiles_index = NOT_LISTED;
 	type = block;
 	rdwr(file);
 }
 
 
+schiene_t::~schiene_t()
+{
+	// do not leave a dangling pointer in the convoy's list
+	set_reserved( convoihandle_t() );
+}
+
+
+void schiene_t::set_reserved(convoihandle_t c)
+{
+	if(  reserved_tiles_index != NOT_LISTED  ) {
+		if(  reserved == c  ) {
+			return;
+		}
+		if(  reserved.is_bound()  ) {
+			// swap the last entry into our place
+			vector_tpl<schiene_t *> &tiles = reserved->access_reserved_tiles();
+			if(  reserved_tiles_index < tiles.get_count()  &&  tiles[reserved_tiles_index] == this  ) {
+				schiene_t *const last = tiles.back();
+				tiles[reserved_tiles_index] = last;
+				last->reserved_tiles_index = reserved_tiles_index;
+				tiles.pop_back();
+			}
+		}
+		reserved_tiles_index = NOT_LISTED;
+	}
+	reserved = c;
+	if(  reserved.is_bound()  ) {
+		vector_tpl<schiene_t *> &tiles = reserved->access_reserved_tiles();
+		reserved_tiles_index = tiles.get_count();
+		tiles.append( this );
+	}
+}
+
+
 void schiene_t::cleanup(player_t *)
 {
 	// removes reservation
@@ -217,7 +254,7 @@ bool schiene_t::reserve(convoihandle_t c, ribi_t::ribi dir, reservation_type t,
 			// is already done, but show that this is reservable. 
 			return true;
 		}
-		reserved = c;
+		set_reserved(c);
 		type = t;
 		direction = dir;
 
@@ -263,7 +300,7 @@ bool schiene_t::unreserve(convoihandle_t c)
 {
 	// is this tile reserved by us?
 	if(reserved.is_bound()  &&  reserved==c) {
-		reserved = convoihandle_t();
+		set_reserved( convoihandle_t() );
 		if(schiene_t::show_reservations) {
 			set_flag( obj_t::dirty );
 		}
@@ -286,7 +323,7 @@ bool schiene_t::unreserve(vehicle_t*)
 		return true;
 	}
 //	if(!welt->lookup(get_pos())->suche_obj(v->get_typ())) {
-		reserved = convoihandle_t();
+		set_reserved( convoihandle_t() );
 		if(schiene_t::show_reservations) {
 			set_flag( obj_t::dirty );
 		}
@@ -379,7 +416,7 @@ void schiene_t::rdwr(loadsave_t *file)
 	if(file->get_extended_version() >= 12)
 #endif
 	{
-		uint16 reserved_index = reserved.get_id();
+		uint32 reserved_index = reserved.get_id();
 		if (file->is_saving())
 		{
 			// Do not save corrupt reservations. We cannot check this on loading, as 
@@ -390,7 +427,7 @@ void schiene_t::rdwr(loadsave_t *file)
 				reserved_index = 0;
 			}
 		}
-		file->rdwr_short(reserved_index); 
+		convoi_t::rdwr_convoy_id(file, reserved_index, 15);
 		reserved.set_id(reserved_index);
 
 		uint8 t = (uint8)type;
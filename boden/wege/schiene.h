@@ -39,6 +39,17 @@ protected:
 	// Additional data for reservations, such as the priority level or direction.
 	ribi_t::ribi direction; 
 
+	// Position of this tile in the reserved_tiles list of the reserving convoy,
+	// or NOT_LISTED if it is not in any such list (e.g. just after loading).
+	uint32 reserved_tiles_index;
+	enum { NOT_LISTED = 0xFFFFFFFFu };
+
+	/**
+	 * Changes the reserving convoy and keeps the reserved_tiles
+	 * lists of the old and the new convoy up to date.
+	 */
+	void set_reserved(convoihandle_t c);
+
 	schiene_t(waytype_t waytype);
 
 	uint8 textlines_in_info_window;
@@ -58,6 +69,8 @@ public:
 
 	schiene_t();
 
+	virtual ~schiene_t();
+
 	//virtual waytype_t get_waytype() const {return track_wt;}
 
 	/**
@@ -133,6 +146,12 @@ public:
 	*/
 	convoihandle_t get_reserved_convoi() const { return reserved; }
 
+	/**
+	 * Adds this tile to the reserved_tiles list of its reserving convoy.
+	 * Needed after loading, as the convoys are loaded after the ways.
+	 */
+	void finish_rd_reservation() { set_reserved(reserved); }
+
 	void rdwr(loadsave_t *file);
 
 	void rotate90();
@@ -38,6 +38,7 @@
 #include "../../player/simplay.h"
 #include "../../obj/wayobj.h"
 #include "../../obj/roadsign.h"
+#include "../../dataobj/block_graph.h"
 #include "../../obj/signal.h"
 #include "../../obj/crossing.h"
 #include "../../obj/bruecke.h"
@@ -67,6 +68,8 @@ static pthread_mutex_t weg_calc_image_mutex = PTHREAD_RECURSIVE_MUTEX_INITIALIZE
  */
 vector_tpl <weg_t *> alle_wege;
 
+uint16 weg_t::stat_month = 0;
+
 /**
  * Get list of all ways
  * @author Hj. Malthaner
@@ -316,6 +319,7 @@ void weg_t::init_statistics()
 			statistics[month][type] = 0;
 		}
 	}
+	statistics_month = stat_month;
 	creation_month_year = welt->get_timeline_year_month();
 }
 
@@ -348,6 +352,9 @@ weg_t::~weg_t()
 	if (!welt->is_destroying())
 	{
 		alle_wege.remove(this);
+		if(  is_rail_type()  ) {
+			block_graph_t::tile_changed(get_pos());
+		}
 		player_t *player = get_owner();
 		if (player  &&  desc)
 		{
@@ -395,12 +402,18 @@ void weg_t::rdwr(loadsave_t *file)
 		}
 	}
 
+	// saved as [0] = actual value; [1] = last month value
+	if(  file->is_loading()  ) {
+		statistics_month = stat_month;
+	}
 	for(  int type=0;  type<MAX_WAY_STATISTICS;  type++  ) {
 		for(  int month=0;  month<MAX_WAY_STAT_MONTHS;  month++  ) {
-			sint32 w = statistics[month][type];
+			sint32 w = get_stat(month, type);
 			file->rdwr_long(w);
-			statistics[month][type] = (sint16)w;
-			// DBG_DEBUG("weg_t::rdwr()", "statistics[%d][%d]=%d", month, type, statistics[month][type]);
+			if(  file->is_loading()  ) {
+				statistics[(uint16)(stat_month - month) % MAX_WAY_STAT_MONTHS][type] = (sint16)w;
+			}
+			// DBG_DEBUG("weg_t::rdwr()", "statistics[%d][%d]=%d", month, type, w);
 		}
 	}
 
@@ -913,13 +926,13 @@ if(  get_waytype() == road_wt  ) {
 
 #if 1
 	//buf.append("\n");
-	buf.printf(translator::translate("convoi passed last\nmonth %i\n"), statistics[1][1]);
+	buf.printf(translator::translate("convoi passed last\nmonth %i\n"), get_stat(1, WAY_STAT_CONVOIS));
 #else
 	// Debug - output stats
 	buf.append("\n");
 	for (int type = 0; type < MAX_WAY_STATISTICS; type++) {
 		for (int month = 0; month < MAX_WAY_STAT_MONTHS; month++) {
-			buf.printf("%d ", statistics[month][type]);
+			buf.printf("%d ", get_stat(month, type));
 		}
 		buf.append("\n");
 	}
@@ -1081,6 +1094,34 @@ void weg_t::rotate90()
 }
 
 
+// only tracks are part of the block graph
+void weg_t::ribi_add(ribi_t::ribi ribi)
+{
+	this->ribi |= (uint8)ribi;
+	if(  is_rail_type()  ) {
+		block_graph_t::tile_changed(get_pos());
+	}
+}
+
+
+void weg_t::ribi_rem(ribi_t::ribi ribi)
+{
+	this->ribi &= (uint8)~ribi;
+	if(  is_rail_type()  ) {
+		block_graph_t::tile_changed(get_pos());
+	}
+}
+
+
+void weg_t::set_ribi(ribi_t::ribi ribi)
+{
+	this->ribi = (uint8)ribi;
+	if(  is_rail_type()  ) {
+		block_graph_t::tile_changed(get_pos());
+	}
+}
+
+
 /**
  * counts signals on this tile;
  * It would be enough for the signals to register and unregister themselves, but this is more secure ...
@@ -1090,6 +1131,9 @@ void weg_t::count_sign()
 {
 	// Either only sign or signal please ...
 	flags &= ~(HAS_SIGN|HAS_SIGNAL|HAS_CROSSING);
+	if(  is_rail_type()  ) {
+		block_graph_t::tile_changed(get_pos());
+	}
 	const grund_t *gr=welt->lookup(get_pos());
 	if(gr) {
 		uint8 i = 1;
@@ -1359,15 +1403,30 @@ void weg_t::check_diagonal()
  * new month
  * @author hsiegeln
  */
-void weg_t::new_month()
+void weg_t::roll_statistics()
 {
-	for (int type=0; type<MAX_WAY_STATISTICS; type++) {
-		for (int month=MAX_WAY_STAT_MONTHS-1; month>0; month--) {
-			statistics[month][type] = statistics[month-1][type];
+	const uint16 passed = stat_month - statistics_month;
+	for(  uint16 i = 1;  i <= passed  &&  i <= MAX_WAY_STAT_MONTHS;  i++  ) {
+		for(  int type=0;  type<MAX_WAY_STATISTICS;  type++  ) {
+			statistics[(uint16)(statistics_month + i) % MAX_WAY_STAT_MONTHS][type] = 0;
 		}
-		statistics[0][type] = 0;
 	}
-	wear_way(desc->get_monthly_base_wear());
+	statistics_month = stat_month;
+}
+
+
+bool weg_t::apply_monthly_wear()
+{
+	return reduce_wear_capacity(desc->get_monthly_base_wear());
+}
+
+
+void weg_t::new_month()
+{
+	if(!renew())
+	{
+		degrade();
+	}
 }
 
 
@@ -1504,29 +1563,33 @@ uint32 weg_t::get_condition_percent() const
 	return (uint32)intermediate_result;
 }
 
-void weg_t::wear_way(uint32 wear)
+bool weg_t::reduce_wear_capacity(uint32 wear)
 {
 	if(!wear || remaining_wear_capacity == UINT32_MAX_VALUE)
 	{
 		// If ways are defined with UINT32_MAX_VALUE,
 		// this feature is intended to be disabled.
-		return;
+		return false;
 	}
 	if(remaining_wear_capacity > wear)
 	{
 		const uint32 degridation_fraction = welt->get_settings().get_way_degradation_fraction();
 		remaining_wear_capacity -= wear;
-		if(remaining_wear_capacity < desc->get_wear_capacity() / degridation_fraction)
-		{
-			if(!renew())
-			{
-				degrade();
-			}
-		}
+		return remaining_wear_capacity < desc->get_wear_capacity() / degridation_fraction;
 	}
 	else if(!is_degraded())
 	{
 		remaining_wear_capacity = 0;
+		return true;
+	}
+	return false;
+}
+
+
+void weg_t::wear_way(uint32 wear)
+{
+	if(reduce_wear_capacity(wear))
+	{
 		if(!renew())
 		{
 			degrade();
@@ -1605,6 +1668,16 @@ bool weg_t::renew()
 	return success;
 }
 
+void weg_t::set_owner(player_t *player)
+{
+	if(  player != get_owner()  ) {
+		obj_t::set_owner( player );
+		// a stop on this tile may now be open to other players (or closed to them)
+		haltestelle_t::halts_changed();
+	}
+}
+
+
 void weg_t::degrade()
 {
 	if(public_right_of_way)
@@ -88,12 +88,25 @@ public:
 private:
 	/**
 	* array for statistical values
-	* MAX_WAY_STAT_MONTHS: [0] = actual value; [1] = last month value
+	* MAX_WAY_STAT_MONTHS: ring buffer of the months, month m is in [m % MAX_WAY_STAT_MONTHS]
+	* (thus MAX_WAY_STAT_MONTHS must divide 65536); use get_stat() for reading
 	* MAX_WAY_STATISTICS: see #define at top of file
 	* @author hsiegeln
 	*/
 	sint16 statistics[MAX_WAY_STAT_MONTHS][MAX_WAY_STATISTICS];
 
+	/**
+	* the month of the newest entry in statistics; the months after that
+	* are only cleared by roll_statistics() when something is booked again
+	*/
+	uint16 statistics_month;
+
+	/// month counter for the statistics of all ways, advanced by next_statistics_month()
+	static uint16 stat_month;
+
+	/// clears the months of the ring buffer which have passed since statistics_month
+	void roll_statistics();
+
 	/**
 	* Way type description
 	* @author Hj. Malthaner
@@ -204,6 +217,12 @@ public:
 	 */
 	void degrade();
 
+	/**
+	 * Reduces the remaining wear capacity
+	 * @return true, if the way must be renewed or degraded now
+	 */
+	bool reduce_wear_capacity(uint32 wear);
+
 	inline weg_t(waytype_t waytype, loadsave_t*) : obj_no_info_t(obj_t::way), wtyp(waytype) { init(); }
 	inline weg_t(waytype_t waytype) : obj_no_info_t(obj_t::way), wtyp(waytype) { init(); }
 
@@ -282,6 +301,9 @@ public:
 
 	virtual void rdwr(loadsave_t *file);
 
+	/// As obj_t::set_owner(), but also tells the stops, since who may use a stop depends on the owner of its ways
+	void set_owner(player_t *player) OVERRIDE;
+
 	/**
 	* Info-text for this way
 	* @author Hj. Malthaner
@@ -322,7 +344,7 @@ public:
 	* zur Reparatur mu folgen).
 	* @param ribi Richtungsbits
 	*/
-	void ribi_add(ribi_t::ribi ribi) { this->ribi |= (uint8)ribi;}
+	void ribi_add(ribi_t::ribi ribi);
 
 	/**
 	* Remove direction bits (ribi) on a way.
@@ -332,7 +354,7 @@ public:
 	* zur Reparatur mu folgen).
 	* @param ribi Richtungsbits
 	*/
-	void ribi_rem(ribi_t::ribi ribi) { this->ribi &= (uint8)~ribi;}
+	void ribi_rem(ribi_t::ribi ribi);
 
 	/**
 	* Set direction bits (ribi) for the way.
@@ -342,7 +364,7 @@ public:
 	* zur Reparatur mu folgen).
 	* @param ribi Richtungsbits
 	*/
-	void set_ribi(ribi_t::ribi ribi) { this->ribi = (uint8)ribi;}
+	void set_ribi(ribi_t::ribi ribi);
 
 	/**
 	* Get the unmasked direction bits (ribi) for the way (without signals or other ribi changer).
@@ -372,17 +394,47 @@ public:
 	* book statistics - is called very often and therefore inline
 	* @author hsiegeln
 	*/
-	void book(int amount, way_statistics type) { statistics[0][type] += amount; }
+	void book(int amount, way_statistics type)
+	{
+		if(  statistics_month != stat_month  ) {
+			roll_statistics();
+		}
+		statistics[stat_month % MAX_WAY_STAT_MONTHS][type] += amount;
+	}
+
+	/**
+	* @return statistics value of the month @p months_ago (0 = this month)
+	*/
+	sint16 get_stat(uint16 months_ago, int type) const
+	{
+		const uint16 unbooked = stat_month - statistics_month;
+		if(  months_ago < unbooked  ||  months_ago - unbooked >= MAX_WAY_STAT_MONTHS  ) {
+			return 0;
+		}
+		return statistics[(uint16)(stat_month - months_ago) % MAX_WAY_STAT_MONTHS][type];
+	}
 
 	/**
 	* return statistics value
 	* always returns last month's value
 	* @author hsiegeln
 	*/
-	int get_statistics(int type) const { return statistics[1][type]; }
+	int get_statistics(int type) const { return get_stat(1, type); }
+
+	/**
+	* Starts a new month for the statistics of all ways; only advances a counter.
+	*/
+	static void next_statistics_month() { stat_month++; }
+
+	/**
+	* Applies the monthly base wear. Only changes this way, so it may be called
+	* for several ways in parallel.
+	* @return true, if the way is worn out and must be renewed or degraded by new_month()
+	*/
+	bool apply_monthly_wear();
 
 	/**
-	* new month
+	* Renews or degrades a way worn out by apply_monthly_wear()
 	* @author hsiegeln
 	*/
 	void new_month();
@@ -1,10 +1,11 @@
 #ifndef convoihandle_t_h
 #define convoihandle_t_h
 
-#include "tpl/quickstone_tpl.h"
+#include "tpl/quickstone32_tpl.h"
 
 class convoi_t;
 
-typedef quickstone_tpl<convoi_t> convoihandle_t;
+// large games have more than 65535 convoys
+typedef quickstone32_tpl<convoi_t> convoihandle_t;
 
 #endif
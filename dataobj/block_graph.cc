@@ -0,0 +1,204 @@
+#include "../simtypes.h"
+#include "../simdebug.h"
+#include "../simworld.h"
+#include "../simhalt.h"
+#include "../boden/grund.h"
+#include "../boden/wege/weg.h"
+#include "../obj/roadsign.h"
+#include "../tpl/inthashtable_tpl.h"
+#include "../utils/for.h"
+#include "block_graph.h"
+
+#ifdef MULTI_THREAD
+#include "../utils/simthread.h"
+// tiles may change while the map is loaded or changed in parallel
+static pthread_mutex_t block_graph_mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+
+// a longer stretch of track without any signal is split in several sections
+#define MAX_SECTION_TILES (4096)
+
+static bool enabled = true;
+
+// all sections; the dropped ones are kept for reuse, since a cursor may still point to them
+static vector_tpl<block_graph_t::section_t *> sections;
+static vector_tpl<uint32> free_sections;
+
+// section index + 1 by signal tile, direction and waytype
+static inthashtable_tpl<uint64, uint32> section_at;
+
+// the sections on a tile (including the signal tile they start at)
+static inthashtable_tpl<uint64, vector_tpl<uint32> > sections_on_tile;
+
+
+static uint64 tile_key(koord3d pos)
+{
+	return ((uint64)(uint16)pos.x << 24) | ((uint64)(uint16)pos.y << 8) | (uint8)pos.z;
+}
+
+
+static void add_to_tile(koord3d pos, uint32 index)
+{
+	const uint64 key = tile_key( pos );
+	vector_tpl<uint32> *list = sections_on_tile.access( key );
+	if(  list == NULL  ) {
+		sections_on_tile.put( key );
+		list = sections_on_tile.access( key );
+	}
+	list->append_unique( index );
+}
+
+
+static void remove_from_tile(koord3d pos, uint32 index)
+{
+	const uint64 key = tile_key( pos );
+	if(  vector_tpl<uint32> *list = sections_on_tile.access( key )  ) {
+		list->remove( index );
+		if(  list->empty()  ) {
+			sections_on_tile.remove( key );
+		}
+	}
+}
+
+
+// to be called with the mutex held (if any)
+static void drop_section(uint32 index)
+{
+	block_graph_t::section_t *s = sections[index];
+	if(  !s->valid  ) {
+		return;
+	}
+	s->valid = false;
+	section_at.remove( s->key );
+	// the signal tile is in the key
+	const koord3d signal_pos( (sint16)(s->key >> 40), (sint16)(s->key >> 24), (sint8)(s->key >> 16) );
+	remove_from_tile( signal_pos, index );
+	FOR( vector_tpl<block_graph_t::tile_t>, const& t, s->tiles ) {
+		remove_from_tile( t.pos, index );
+	}
+	free_sections.append( index );
+}
+
+
+static const block_graph_t::section_t *build_section(uint64 key, koord3d signal_pos, ribi_t::ribi dir, waytype_t wt)
+{
+	const grund_t *gr = world()->lookup( signal_pos );
+	if(  gr == NULL  ||  gr->get_weg( wt ) == NULL  ) {
+		return NULL;
+	}
+
+	uint32 index;
+	if(  free_sections.empty()  ) {
+		index = sections.get_count();
+		sections.append( new block_graph_t::section_t );
+	}
+	else {
+		index = free_sections.pop_back();
+	}
+	block_graph_t::section_t *s = sections[index];
+	s->key = key;
+	s->valid = true;
+	s->tiles.clear();
+	section_at.set( key, index + 1 );
+	add_to_tile( signal_pos, index );
+
+	grund_t *to;
+	while(  s->tiles.get_count() < MAX_SECTION_TILES  &&  gr->get_neighbour( to, wt, dir )  ) {
+		const weg_t *w = to->get_weg( wt );
+		if(  w == NULL  ) {
+			break;
+		}
+		block_graph_t::tile_t t;
+		t.pos = to->get_pos();
+		t.has_roadsign = to->find<roadsign_t>() != NULL;
+		t.halt = haltestelle_t::get_halt( t.pos, NULL );
+		s->tiles.append( t );
+		add_to_tile( t.pos, index );
+
+		// where the track goes on from here
+		const ribi_t::ribi onward = w->get_ribi_unmasked() & ~ribi_t::backward( dir );
+		if(  w->has_signal()  ||  !ribi_t::is_single( onward )  ) {
+			break;
+		}
+		dir = onward;
+		gr = to;
+	}
+	return s;
+}
+
+
+const block_graph_t::section_t *block_graph_t::get_section(koord3d signal_pos, koord3d next_pos, waytype_t wt)
+{
+	if(  !enabled  ) {
+		return NULL;
+	}
+	const ribi_t::ribi dir = ribi_type( signal_pos, next_pos );
+	if(  !ribi_t::is_single( dir )  ) {
+		return NULL;
+	}
+	const uint64 key = (tile_key( signal_pos ) << 16) | ((uint64)(uint8)wt << 4) | dir;
+
+	// no lock: the map does not change while trains reserve
+	const uint32 index = section_at.get( key );
+	return index ? sections[index - 1] : build_section( key, signal_pos, dir, wt );
+}
+
+
+void block_graph_t::tile_changed(koord3d pos)
+{
+#ifdef MULTI_THREAD
+	pthread_mutex_lock( &block_graph_mutex );
+#endif
+	// e.g. nothing built yet while loading
+	if(  !sections_on_tile.empty()  ) {
+		const vector_tpl<uint32> list = sections_on_tile.remove( tile_key( pos ) );
+		FOR( vector_tpl<uint32>, const index, list ) {
+			drop_section( index );
+		}
+	}
+#ifdef MULTI_THREAD
+	pthread_mutex_unlock( &block_graph_mutex );
+#endif
+}
+
+
+void block_graph_t::clear()
+{
+#ifdef MULTI_THREAD
+	pthread_mutex_lock( &block_graph_mutex );
+#endif
+	// the sections themselves are kept for reuse
+	free_sections.clear();
+	for(  uint32 i = 0;  i < sections.get_count();  i++  ) {
+		sections[i]->valid = false;
+		sections[i]->tiles.clear();
+		free_sections.append( i );
+	}
+	section_at.clear();
+	sections_on_tile.clear();
+#ifdef MULTI_THREAD
+	pthread_mutex_unlock( &block_graph_mutex );
+#endif
+}
+
+
+void block_graph_t::set_enabled(bool on)
+{
+	enabled = on;
+	if(  !on  ) {
+		clear();
+	}
+}
+
+
+bool block_graph_t::is_enabled()
+{
+	return enabled;
+}
+
+
+uint32 block_graph_t::get_section_count()
+{
+	return sections.get_count() - free_sections.get_count();
+}
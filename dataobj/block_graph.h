@@ -0,0 +1,92 @@
+#ifndef block_graph_h
+#define block_graph_h
+
+#include "../simtypes.h"
+#include "../halthandle_t.h"
+#include "../tpl/vector_tpl.h"
+#include "koord3d.h"
+
+/**
+ * The sections of track behind the signals.
+ *
+ * A section starts at a signal, in the direction a train leaves it, and runs
+ * up to and including the next signal, junction or end of the track. For every
+ * tile of a section the graph keeps what rail_vehicle_t::block_reserver()
+ * would otherwise look up from the map again on every reservation attempt:
+ * the stop and whether there is a road sign.
+ *
+ * Sections are built when first asked for, and are dropped again by
+ * tile_changed() whenever a tile on them changes (its ways, signs, signals or
+ * stop). Since only the tiles of a section are kept, and every tile is checked
+ * against the route, a section that no longer fits the track is just not used.
+ *
+ * Sections are only asked for on the main thread, while the map is not
+ * changed in parallel. The reservations themselves stay on the schiene_t tiles.
+ */
+class block_graph_t
+{
+public:
+	struct tile_t
+	{
+		koord3d pos;
+		bool has_roadsign;
+		/// as haltestelle_t::get_halt(pos, NULL)
+		halthandle_t halt;
+	};
+
+	struct section_t
+	{
+		uint64 key;
+		bool valid;
+		/// the tiles after the signal, up to and including the last one
+		vector_tpl<tile_t> tiles;
+	};
+
+	/**
+	 * Follows a route through the graph: after enter() at a signal the tiles
+	 * of its section are handed out by advance(), as long as the route stays on it.
+	 */
+	class cursor_t
+	{
+		const section_t *section;
+		uint32 next;
+
+	public:
+		cursor_t() : section(NULL), next(0) {}
+
+		/// To be called at a signal on the route, @p next_pos being the following tile of the route
+		void enter(koord3d signal_pos, koord3d next_pos, waytype_t wt)
+		{
+			section = get_section( signal_pos, next_pos, wt );
+			next = 0;
+		}
+
+		/// @returns the tile at @p pos, or NULL if the route has left the section
+		const tile_t *advance(koord3d pos)
+		{
+			if(  section  &&  section->valid  &&  next < section->tiles.get_count()  &&  section->tiles[next].pos == pos  ) {
+				return &section->tiles[next++];
+			}
+			section = NULL;
+			return NULL;
+		}
+	};
+
+	/// @returns the section leaving the signal at @p signal_pos towards @p next_pos, or NULL
+	static const section_t *get_section(koord3d signal_pos, koord3d next_pos, waytype_t wt);
+
+	/// Drops all sections on @p pos, to be called when its ways, signs, signals or stop change
+	static void tile_changed(koord3d pos);
+
+	/// Drops the whole graph (new, rotated or enlarged map)
+	static void clear();
+
+	/// Without the graph, get_section() always returns NULL (for comparing in benchmarks)
+	static void set_enabled(bool on);
+	static bool is_enabled();
+
+	/// number of sections currently known
+	static uint32 get_section_count();
+};
+
+#endif
@@ -62,13 +62,90 @@ static nodelist_node_t *all_lists[NUM_LIST] = {
 const size_t min_size = sizeof(void *);
 
 
-void *freelist_t::gimme_node(size_t size)
+/* Each thread keeps a small stock ("magazine") of free nodes per size in front of
+ * the shared lists above, so that most requests do not need the mutex.
+ * Nodes are moved between the magazine and the shared list in batches.
+ */
+#define MAGAZINE_BATCH (32)
+
+// counted per size; the last entry counts the nodes too large for the lists
+static uint64 total_gimme[NUM_LIST+1];
+static uint64 total_putback[NUM_LIST+1];
+
+// incremented by free_all_nodes(), which invalidates the magazines of all threads
+static uint32 generation = 0;
+
+// moves up to count nodes from *from to *to; to be called with the mutex held (if any)
+static uint32 move_nodes( nodelist_node_t **from, nodelist_node_t **to, uint32 count )
 {
-	nodelist_node_t ** list = NULL;
-	if(  size == 0  ) {
-		return NULL;
+	uint32 moved = 0;
+	while(  moved < count  &&  *from  ) {
+		nodelist_node_t *tmp = *from;
+		*from = tmp->next;
+		tmp->next = *to;
+		*to = tmp;
+		moved++;
 	}
+	return moved;
+}
+
+struct magazine_t
+{
+	nodelist_node_t *lists[NUM_LIST];
+	uint32 counts[NUM_LIST];
+	uint32 gimme[NUM_LIST+1];
+	uint32 putback[NUM_LIST+1];
+	uint32 generation;
+
+	magazine_t() { clear(); }
+
+	void clear()
+	{
+		for(  int i=0;  i<NUM_LIST;  i++  ) {
+			lists[i] = NULL;
+			counts[i] = 0;
+		}
+		for(  int i=0;  i<=NUM_LIST;  i++  ) {
+			gimme[i] = 0;
+			putback[i] = 0;
+		}
+		generation = ::generation;
+	}
+
+	// adds the local counts to the totals; to be called with the mutex held (if any)
+	void flush_counts()
+	{
+		for(  int i=0;  i<=NUM_LIST;  i++  ) {
+			total_gimme[i] += gimme[i];
+			total_putback[i] += putback[i];
+			gimme[i] = 0;
+			putback[i] = 0;
+		}
+	}
+
+	// gives all nodes back to the shared lists when the thread ends
+	~magazine_t()
+	{
+#ifdef MULTI_THREAD
+		pthread_mutex_lock( &freelist_mutex );
+#endif
+		if(  generation == ::generation  ) {
+			for(  int i=0;  i<NUM_LIST;  i++  ) {
+				move_nodes( &lists[i], &all_lists[i], counts[i] );
+			}
+			flush_counts();
+		}
+#ifdef MULTI_THREAD
+		pthread_mutex_unlock( &freelist_mutex );
+#endif
+	}
+};
+
+static thread_local magazine_t magazine;
+
 
+static size_t round_size( size_t size )
+{
 	// all sizes should be dividable by 4 and at least as large as a pointer
 #ifdef DEBUG_FREELIST
 	size = max( min_size, size + min_size);
@@ -77,19 +154,62 @@ void *freelist_t::gimme_node(size_t size)
 #endif
 	size = (size+3)>>2;
 	size <<= 2;
+	return size;
+}
 
-#ifdef MULTI_THREAD
-	pthread_mutex_lock( &freelist_mutex );
+
+// fills the shared list for this size with a new chunk; to be called with the mutex held (if any)
+static void new_chunk( nodelist_node_t **list, size_t size )
+{
+	int num_elements = 32764/(int)size;
+	char* p = (char*)xmalloc(num_elements * size + sizeof(p));
+
+#ifdef USE_VALGRIND_MEMCHECK
+	// tell valgrind that we still cannot access the pool p
+	VALGRIND_MAKE_MEM_NOACCESS(p, num_elements * size + sizeof(p));
+#endif
+
+	// put the memory into the chunklist for free it
+	nodelist_node_t *chunk = (nodelist_node_t *)p;
+
+#ifdef USE_VALGRIND_MEMCHECK
+	// tell valgrind that we reserved space for one nodelist_node_t
+	VALGRIND_CREATE_MEMPOOL(chunk, 0, false);
+	VALGRIND_MEMPOOL_ALLOC(chunk, chunk, sizeof(*chunk));
+	VALGRIND_MAKE_MEM_UNDEFINED(chunk, sizeof(*chunk));
+#endif
+
+	chunk->next = chunk_list;
+	chunk_list = chunk;
+	p += sizeof(p);
+	// then enter nodes into nodelist
+	for(  int i=0;  i<num_elements;  i++  ) {
+		nodelist_node_t *tmp = (nodelist_node_t *)(p+i*size);
+#ifdef USE_VALGRIND_MEMCHECK
+		// tell valgrind that we reserved space for one nodelist_node_t
+		VALGRIND_CREATE_MEMPOOL(tmp, 0, false);
+		VALGRIND_MEMPOOL_ALLOC(tmp, tmp, sizeof(*tmp));
+		VALGRIND_MAKE_MEM_UNDEFINED(tmp, sizeof(*tmp));
 #endif
+		tmp->next = *list;
+		*list = tmp;
+	}
+}
+
+
+void *freelist_t::gimme_node(size_t size)
+{
+	if(  size == 0  ) {
+		return NULL;
+	}
+	size = round_size( size );
 
 	// hold return value
 	nodelist_node_t *tmp;
 	if(  size > MAX_LIST_INDEX  ) {
 		// too large: just use malloc anyway
 		tmp = (nodelist_node_t *)xmalloc(size);
-#ifdef MULTI_THREAD
-		pthread_mutex_unlock( &freelist_mutex );
-#endif
+		magazine.gimme[NUM_LIST]++;
 #ifdef DEBUG_FREELIST
 		tmp->magic = 0xAA;
 		tmp->free = 0;
@@ -98,48 +218,31 @@ void *freelist_t::gimme_node(size_t size)
 		return tmp;
 	}
 
-
-	list = &(all_lists[size/4]);
-	// need new memory?
-	if(  *list == NULL  ) {
-		int num_elements = 32764/(int)size;
-		char* p = (char*)xmalloc(num_elements * size + sizeof(p));
-
-#ifdef USE_VALGRIND_MEMCHECK
-		// tell valgrind that we still cannot access the pool p
-		VALGRIND_MAKE_MEM_NOACCESS(p, num_elements * size + sizeof(p));
-#endif
-
-		// put the memory into the chunklist for free it
-		nodelist_node_t *chunk = (nodelist_node_t *)p;
-
-#ifdef USE_VALGRIND_MEMCHECK
-		// tell valgrind that we reserved space for one nodelist_node_t
-		VALGRIND_CREATE_MEMPOOL(chunk, 0, false);
-		VALGRIND_MEMPOOL_ALLOC(chunk, chunk, sizeof(*chunk));
-		VALGRIND_MAKE_MEM_UNDEFINED(chunk, sizeof(*chunk));
-#endif
-
-		chunk->next = chunk_list;
-		chunk_list = chunk;
-		p += sizeof(p);
-		// then enter nodes into nodelist
-		for(  int i=0;  i<num_elements;  i++  ) {
-			nodelist_node_t *tmp = (nodelist_node_t *)(p+i*size);
-#ifdef USE_VALGRIND_MEMCHECK
-			// tell valgrind that we reserved space for one nodelist_node_t
-			VALGRIND_CREATE_MEMPOOL(tmp, 0, false);
-			VALGRIND_MEMPOOL_ALLOC(tmp, tmp, sizeof(*tmp));
-			VALGRIND_MAKE_MEM_UNDEFINED(tmp, sizeof(*tmp));
+	const int index = size/4;
+	if(  magazine.generation != generation  ) {
+		// all nodes were freed meanwhile
+		magazine.clear();
+	}
+	if(  magazine.lists[index] == NULL  ) {
+		// refill the magazine from the shared list
+#ifdef MULTI_THREAD
+		pthread_mutex_lock( &freelist_mutex );
 #endif
-			tmp->next = *list;
-			*list = tmp;
+		if(  all_lists[index] == NULL  ) {
+			new_chunk( &all_lists[index], size );
 		}
+		magazine.counts[index] += move_nodes( &all_lists[index], &magazine.lists[index], MAGAZINE_BATCH );
+		magazine.flush_counts();
+#ifdef MULTI_THREAD
+		pthread_mutex_unlock( &freelist_mutex );
+#endif
 	}
 
 	// return first node of list
-	tmp = *list;
-	*list = tmp->next;
+	tmp = magazine.lists[index];
+	magazine.lists[index] = tmp->next;
+	magazine.counts[index]--;
+	magazine.gimme[index]++;
 
 #ifdef USE_VALGRIND_MEMCHECK
 	// tell valgrind that we now have access to a chunk of size bytes
@@ -147,10 +250,6 @@ void *freelist_t::gimme_node(size_t size)
 	VALGRIND_MAKE_MEM_UNDEFINED(tmp, size);
 #endif
 
-#ifdef MULTI_THREAD
-	pthread_mutex_unlock( &freelist_mutex );
-#endif
-
 #ifdef DEBUG_FREELIST
 	tmp->magic = 0x5555;
 	tmp->free = 0;
@@ -162,33 +261,21 @@ void *freelist_t::gimme_node(size_t size)
 
 void freelist_t::putback_node( size_t size, void *p )
 {
-	nodelist_node_t ** list = NULL;
 	if(  size==0  ||  p==NULL  ) {
 		return;
 	}
-	
-	// all sizes should be dividable by 4
-#ifdef DEBUG_FREELIST
-	size = max( min_size, size + min_size );
-#else
-	size = max( min_size, size );
-#endif
-	size = ((size+3)>>2);
-	size <<= 2;
-
-#ifdef MULTI_THREAD
-	pthread_mutex_lock( &freelist_mutex );
-#endif
+	size = round_size( size );
 
 	if(  size > MAX_LIST_INDEX  ) {
 		free(p);
-#ifdef MULTI_THREAD
-		pthread_mutex_unlock( &freelist_mutex );
-#endif
+		magazine.putback[NUM_LIST]++;
 		return;
 	}
 
-	list = &(all_lists[size/4]);
+	const int index = size/4;
+	if(  magazine.generation != generation  ) {
+		magazine.clear();
+	}
 
 #ifdef USE_VALGRIND_MEMCHECK
 	// tell valgrind that we keep access to a nodelist_node_t within the memory chunk
@@ -204,15 +291,47 @@ void freelist_t::putback_node( size_t size, void *p )
 	assert(  tmp->magic == 0x5555  &&  tmp->free == 0  &&  tmp->size == size/4  );
 	tmp->free = 1;
 #endif
-	tmp->next = *list;
-	*list = tmp;
+	tmp->next = magazine.lists[index];
+	magazine.lists[index] = tmp;
+	magazine.counts[index]++;
+	magazine.putback[index]++;
+
+	if(  magazine.counts[index] >= 2*MAGAZINE_BATCH  ) {
+		// too many in stock: return a batch, which other threads can use then
+#ifdef MULTI_THREAD
+		pthread_mutex_lock( &freelist_mutex );
+#endif
+		magazine.counts[index] -= move_nodes( &magazine.lists[index], &all_lists[index], MAGAZINE_BATCH );
+		magazine.flush_counts();
+#ifdef MULTI_THREAD
+		pthread_mutex_unlock( &freelist_mutex );
+#endif
+	}
+}
 
+
+void freelist_t::get_statistics( uint32 size_class, uint32 &node_size, uint64 &gimme, uint64 &putback )
+{
+#ifdef MULTI_THREAD
+	pthread_mutex_lock( &freelist_mutex );
+#endif
+	// the counts of the calling thread are added right away, those of other threads with their next batch
+	magazine.flush_counts();
+	node_size = size_class < NUM_LIST ? size_class*4 : 0;
+	gimme = size_class <= NUM_LIST ? total_gimme[size_class] : 0;
+	putback = size_class <= NUM_LIST ? total_putback[size_class] : 0;
 #ifdef MULTI_THREAD
 	pthread_mutex_unlock( &freelist_mutex );
 #endif
 }
 
 
+uint32 freelist_t::get_size_class_count()
+{
+	return NUM_LIST+1;
+}
+
+
 // clears all list memories
 void freelist_t::free_all_nodes()
 {
@@ -232,5 +351,7 @@ void freelist_t::free_all_nodes()
 	for( int i=0;  i<NUM_LIST;  i++  ) {
 		all_lists[i] = NULL;
 	}
+	// the magazines of all threads point into the freed memory
+	generation++;
 	printf("freelist_t::free_all_nodes(): ok\n");
 }
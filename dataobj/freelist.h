@@ -1,9 +1,14 @@
 #ifndef freelist_t_h
 #define freelist_t_h
 
+#include <stddef.h>
+#include "../simtypes.h"
+
 /**
  * Helper class to organize small memory objects i.e. nodes for linked lists
  * and such.
+ * Each thread keeps a few free nodes of each size for itself, so that threads
+ * rarely have to wait for each other.
  *
  * @author Hanjsjrg Malthaner
  */
@@ -15,6 +20,15 @@ public:
 
 	// clears all list memories
 	static void free_all_nodes();
+
+	/**
+	 * Number of nodes handed out and returned so far for one size class.
+	 * Classes are numbered 0 .. get_size_class_count()-1; the last one counts the
+	 * nodes which are too large for the lists (node_size is 0 for these).
+	 * Other threads report their counts in batches, so these lag slightly behind.
+	 */
+	static void get_statistics( uint32 size_class, uint32 &node_size, uint64 &gimme, uint64 &putback );
+	static uint32 get_size_class_count();
 };
 
 #endif
@@ -42,7 +42,7 @@
 #include "../descriptor/building_desc.h"
 #include "../descriptor/groundobj_desc.h"
 #include "../dataobj/loadsave.h"
-#include "../dataobj/freelist.h"
+#include "../dataobj/tile_arena.h"
 #include "../dataobj/environment.h"
 
 #include "objlist.h"
@@ -134,7 +134,7 @@ static void dl_free(obj_t** p, uint8 size)
 {
 	assert(size > 1);
 	if (size <= 16) {
-		freelist_t::putback_node(sizeof(*p) * size, p);
+		tile_arena_t::free(p, sizeof(*p) * size);
 	}
 	else {
 		guarded_free(p);
@@ -142,12 +142,13 @@ static void dl_free(obj_t** p, uint8 size)
 }
 
 
-static obj_t** dl_alloc(uint8 size)
+// the list is placed next to the ground it belongs to
+static obj_t** dl_alloc(const objlist_t *owner, uint8 size)
 {
 	assert(size > 1);
 	obj_t** p;
 	if (size <= 16) {
-		p = static_cast<obj_t**>(freelist_t::gimme_node(sizeof(*p) * size ));
+		p = static_cast<obj_t**>(tile_arena_t::alloc_near(owner, sizeof(*p) * size ));
 	}
 	else {
 		p = MALLOCN(obj_t*, size);
@@ -218,7 +219,7 @@ void objlist_t::set_capacity(uint16 new_cap)
 	else if(capacity<=1  &&  new_cap>1) {
 		// if we reach here, new_cap>1 and (capacity==0 or capacity>1)
 		obj_t *tmp=obj.one;
-		obj.some = dl_alloc(new_cap);
+		obj.some = dl_alloc(this, new_cap);
 		MEMZERON(obj.some, new_cap);
 		obj.some[0] = tmp;
 		capacity = new_cap;
@@ -229,7 +230,7 @@ void objlist_t::set_capacity(uint16 new_cap)
 		assert(  top<=new_cap  );
 
 		// get memory
-		obj_t **tmp = dl_alloc(new_cap);
+		obj_t **tmp = dl_alloc(this, new_cap);
 
 		// free old memory
 		if(obj.some) {
@@ -44,6 +44,7 @@ void schedule_t::copy_from(const schedule_t *src)
 		return;
 	}
 	entries.clear();
+	stop_table.valid = false;
 	FOR(minivec_tpl<schedule_entry_t>, const& i, src->entries) {
 		entries.append(i);
 	}
@@ -148,6 +149,7 @@ bool schedule_t::insert(const grund_t* gr, uint16 minimum_loading, uint8 waiting
 
 	if(  is_stop_allowed(gr)  ) {
 		entries.insert_at(current_stop, schedule_entry_t(gr->get_pos(), minimum_loading, waiting_time_shift, spacing_shift, -1, wait_for_time));
+		stop_table.valid = false;
 		current_stop ++;
 		make_current_stop_valid();
 		return true;
@@ -186,6 +188,7 @@ bool schedule_t::append(const grund_t* gr, uint16 minimum_loading, uint8 waiting
 
 	if(is_stop_allowed(gr)) {
 		entries.append(schedule_entry_t(gr->get_pos(), minimum_loading, waiting_time_shift, spacing_shift, -1, wait_for_time), 4);
+		stop_table.valid = false;
 		return true;
 	}
 	else {
@@ -201,6 +204,7 @@ bool schedule_t::append(const grund_t* gr, uint16 minimum_loading, uint8 waiting
 // cleanup a schedule
 void schedule_t::cleanup()
 {
+	stop_table.valid = false;
 
 	if(entries.get_count() == 1)
 	{
@@ -246,6 +250,7 @@ void schedule_t::cleanup()
 bool schedule_t::remove()
 {
 	bool ok = entries.remove_at(current_stop);
+	stop_table.valid = false;
 	make_current_stop_valid();
 	return ok;
 }
@@ -256,6 +261,8 @@ void schedule_t::rdwr(loadsave_t *file)
 {
 	xml_tag_t f( file, "schedule_t" );
 
+	stop_table.valid = false;
+
 	make_current_stop_valid();
 
 	uint8 size = entries.get_count();
@@ -394,6 +401,7 @@ void schedule_t::rotate90( sint16 y_size )
 	FOR(minivec_tpl<schedule_entry_t>, & i, entries) {
 		i.pos.rotate90(y_size);
 	}
+	stop_table.valid = false;
 }
 
 
@@ -521,14 +529,127 @@ void schedule_t::increment_index(uint8 *index, bool *reversed) const {
  * @author suitougreentea
  */
 void schedule_t::increment_index_until_next_halt(player_t *player, uint8 *index, bool *reversed) const {
-	uint32 counter = get_count();
-	while (counter --)
-	{
-		increment_index(index, reversed);
-		const koord3d halt_position = entries[*index].pos;
-		const halthandle_t halt = haltestelle_t::get_halt(halt_position, player);
-		if (halt.is_bound()) return;
+	get_stop_table(player).next_halt(index, reversed);
+}
+
+
+static bool id_less(uint16 a, uint16 b)
+{
+	return a < b;
+}
+
+
+const schedule_t::stop_table_t &schedule_t::get_stop_table(const player_t *player) const
+{
+	if(  !stop_table.valid  ||  stop_table.player != player  ||  stop_table.halt_changes != haltestelle_t::get_halt_changes()  ||  stop_table.halts.get_count() != entries.get_count()  ) {
+		update_stop_table(player);
+	}
+	return stop_table;
+}
+
+
+void schedule_t::update_stop_table(const player_t *player) const
+{
+	stop_table_t &t = stop_table;
+	const uint8 count = entries.get_count();
+
+	t.halts.clear();
+	t.halt_ids.clear();
+	FOR(minivec_tpl<schedule_entry_t>, const& i, entries) {
+		const halthandle_t halt = haltestelle_t::get_halt(i.pos, player);
+		t.halts.append(halt);
+		if(  halt.is_bound()  ) {
+			t.halt_ids.insert_unique_ordered(halt.get_id(), id_less);
+		}
+	}
+
+	// where the convoy goes from each entry in each direction
+	t.next_halt_state.clear();
+	for(  uint16 state = 0;  state < count * 2;  state++  ) {
+		uint8 index = state >> 1;
+		bool reversed = state & 1;
+		for(  uint8 n = 0;  n < count;  n++  ) {
+			increment_index(&index, &reversed);
+			if(  t.halts[index].is_bound()  ) {
+				break;
+			}
+		}
+		t.next_halt_state.append((index << 1) | reversed);
+	}
+
+	// the halts fetch_goods() may load for when leaving each entry in each direction
+	vector_tpl<uint32> entry_bit(count);
+	FOR(vector_tpl<halthandle_t>, const& halt, t.halts) {
+		entry_bit.append(halt.is_bound() ? t.halt_ids.index_of(halt.get_id()) : 0);
+	}
+	t.words_per_state = (t.halt_ids.get_count() + 31) / 32;
+	t.reachable.clear();
+	t.reachable.resize(count * 2 * t.words_per_state);
+	for(  uint16 state = 0;  state < count * 2;  state++  ) {
+		const uint8 start = state >> 1;
+		const halthandle_t self = t.halts[start];
+		const uint32 offset = t.reachable.get_count();
+		for(  uint32 w = 0;  w < t.words_per_state;  w++  ) {
+			t.reachable.append(self.is_bound() ? 0 : 0xFFFFFFFFu);
+		}
+		uint32 *bits = t.reachable.begin() + offset;
+		if(  !self.is_bound()  ) {
+			// only used for entries with a halt
+			continue;
+		}
+		uint8 index = start;
+		bool reversed = state & 1;
+		increment_index(&index, &reversed);
+		bool left = false;
+		for(  uint16 n = 0;  n < count * 2  &&  index != start;  n++  ) {
+			const halthandle_t halt = t.halts[index];
+			if(  halt == self  ) {
+				if(  left  ) {
+					// the convoy comes back here first
+					break;
+				}
+			}
+			else {
+				left = true;
+				if(  halt.is_bound()  ) {
+					const uint32 bit = entry_bit[index];
+					bits[bit >> 5] |= 1u << (bit & 31);
+				}
+				if(  mirrored  &&  (index == 0  ||  index == count - 1)  ) {
+					break;
+				}
+			}
+			increment_index(&index, &reversed);
+		}
+	}
+
+	t.player = player;
+	t.halt_changes = haltestelle_t::get_halt_changes();
+	t.valid = true;
+}
+
+
+bool schedule_t::stop_table_t::is_reachable_after(uint8 index, bool reversed, halthandle_t halt) const
+{
+	if(  !halt.is_bound()  ||  index >= halts.get_count()  ) {
+		return false;
+	}
+	// binary search for the bit of the halt
+	uint32 lo = 0, hi = halt_ids.get_count();
+	while(  lo < hi  ) {
+		const uint32 mid = (lo + hi) / 2;
+		if(  halt_ids[mid] < halt.get_id()  ) {
+			lo = mid + 1;
+		}
+		else {
+			hi = mid;
+		}
+	}
+	if(  lo == halt_ids.get_count()  ||  halt_ids[lo] != halt.get_id()  ) {
+		return false;
 	}
+	const uint32 *bits = reachable.begin() + (index * 2 + reversed) * words_per_state;
+	return (bits[lo >> 5] >> (lo & 31)) & 1;
 }
 
 /**
@@ -607,6 +728,7 @@ void schedule_t::sprintf_schedule( cbuffer_t &buf ) const
 bool schedule_t::sscanf_schedule( const char *ptr )
 {
 	const char *p = ptr;
+	stop_table.valid = false;
 	// first: clear current schedule
 	while (!entries.empty()) {
 		remove();
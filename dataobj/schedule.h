@@ -6,6 +6,7 @@
 #include "../halthandle_t.h"
 
 #include "../tpl/minivec_tpl.h"
+#include "../tpl/vector_tpl.h"
 #include "../tpl/koordhashtable_tpl.h"
 
 #define TIMES_HISTORY_SIZE 3
@@ -129,6 +130,65 @@ public:
 	 */
 	void increment_index_until_next_halt(player_t* player, uint8 *index, bool *reversed) const;
 
+	/**
+	 * The entries resolved to the halts of one player, so walking along the
+	 * schedule needs no map lookup per entry. Built by get_stop_table() on
+	 * demand and built again after the schedule was edited or after any stop
+	 * was built, removed or changed hands, or the owners of its ways or the
+	 * access rights changed (see haltestelle_t::get_halt_changes()).
+	 * Since the table is built on demand and shared, it may only be used on the
+	 * main thread. convoi_t::fetch_goods() filters and loads the goods by it,
+	 * which is safe only because convoi_t::step() runs on the main thread.
+	 */
+	class stop_table_t
+	{
+		friend class schedule_t;
+
+		const player_t *player;
+		uint32 halt_changes;
+		bool valid;
+
+		/// the halt of each entry (unbound for waypoints and depots)
+		vector_tpl<halthandle_t> halts;
+
+		/// per entry and direction (entry*2+reversed): the next entry and direction with a halt
+		vector_tpl<uint16> next_halt_state;
+
+		/// ids of all halts of the schedule, ascending
+		vector_tpl<uint16> halt_ids;
+
+		/// per entry and direction: bitset over halt_ids, see is_reachable_after()
+		vector_tpl<uint32> reachable;
+		uint32 words_per_state;
+
+		stop_table_t() : player(NULL), halt_changes(0), valid(false), words_per_state(0) {}
+
+	public:
+		halthandle_t get_halt(uint8 index) const { return halts[index]; }
+
+		/// Same as schedule_t::increment_index_until_next_halt(), but a lookup
+		void next_halt(uint8 *index, bool *reversed) const
+		{
+			if(  !halts.empty()  ) {
+				const uint16 state = next_halt_state[*index * 2 + *reversed];
+				*index = state >> 1;
+				*reversed = state & 1;
+			}
+		}
+
+		/**
+		 * True if @p halt may be called at after leaving entry @p index in direction
+		 * @p reversed, before the halt of that entry comes up again or a mirrored
+		 * schedule turns: the stops which haltestelle_t::fetch_goods() loads for.
+		 */
+		bool is_reachable_after(uint8 index, bool reversed, halthandle_t halt) const;
+	};
+
+	/**
+	 * The stop table of this schedule for the halts @p player may use.
+	 */
+	const stop_table_t &get_stop_table(const player_t *player) const;
+
 	/***
 	 * "Completed"
 	 */
@@ -185,7 +245,7 @@ public:
 	inline bool is_mirrored() const { return mirrored; }
 	inline bool is_same_spacing_shift() const { return same_spacing_shift; }
 	void set_bidirectional(bool bidirec = true ) { bidirectional = bidirec; }
-	void set_mirrored(bool mir = true ) { mirrored = mir; }
+	void set_mirrored(bool mir = true ) { mirrored = mir; stop_table.valid = false; }
 	void set_same_spacing_shift(bool s = true) { same_spacing_shift = s; }
 
 	/*
@@ -225,6 +285,10 @@ private:
 	uint8 current_stop;
 	sint16 spacing;
 
+	mutable stop_table_t stop_table;
+
+	void update_stop_table(const player_t *player) const;
+
 	static schedule_entry_t dummy_entry;
 };
 
@@ -536,6 +536,8 @@ settings_t::settings_t() :
 
 	path_explorer_time_midpoint = 64;
 	save_path_explorer_data = true;
+
+	local_walking_destinations = true;
 }
 
 void settings_t::set_default_climates()
@@ -1786,6 +1788,16 @@ void settings_t::rdwr(loadsave_t *file)
 			file->rdwr_long(path_explorer_time_midpoint); 
 			file->rdwr_bool(save_path_explorer_data); 
 		}
+
+		if (file->get_extended_version() >= 15 || (file->get_extended_version() >= 14 && file->get_extended_revision() >= 13))
+		{
+			file->rdwr_bool(local_walking_destinations);
+		}
+		else if (file->is_loading())
+		{
+			// Older games drew every destination from the whole map.
+			local_walking_destinations = false;
+		}
 	}
 
 #ifdef DEBUG_SIMRAND_CALLS
@@ -2634,6 +2646,8 @@ void settings_t::parse_simuconf(tabfile_t& simuconf, sint16& disp_width, sint16&
 	path_explorer_time_midpoint = contents.get_int("path_explorer_time_midpoint", path_explorer_time_midpoint); 
 	save_path_explorer_data = contents.get_int("save_path_explorer_data", save_path_explorer_data); 
 
+	local_walking_destinations = contents.get_int("local_walking_destinations", local_walking_destinations);
+
 	// OK, this is a bit complex.  We are at risk of loading the same livery schemes repeatedly, which
 	// gives duplicate livery schemes and utter confusion.
 	// On the other hand, we are also at risk of wiping out our livery schemes with blank space.
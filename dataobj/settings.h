@@ -696,6 +696,9 @@ public:
 	uint32 path_explorer_time_midpoint;
 	bool save_path_explorer_data;
 
+	// Passengers and mail which can only walk pick destinations within walking range only
+	bool local_walking_destinations;
+
 	/**
 	 * If map is read from a heightfield, this is the name of the heightfield.
 	 * Set to empty string in order to avoid loading.
@@ -1179,6 +1182,8 @@ public:
 
 	uint32 get_path_explorer_time_midpoint() const { return path_explorer_time_midpoint; }
 	bool get_save_path_explorer_data() const { return save_path_explorer_data; }
+
+	bool get_local_walking_destinations() const { return local_walking_destinations; }
 };
 
 #endif 
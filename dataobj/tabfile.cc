@@ -108,7 +108,7 @@ bool tabfileobj_t::get_x_y( const char *key, sint16 &x, sint16 &y )
 
 const koord &tabfileobj_t::get_koord(const char *key, koord def)
 {
-	static koord ret;
+	static thread_local koord ret;
 	ret = def;
 	get_x_y( key, ret.x, ret.y );
 	return ret;
@@ -116,7 +116,7 @@ const koord &tabfileobj_t::get_koord(const char *key, koord def)
 
 const scr_coord &tabfileobj_t::get_scr_coord(const char *key, scr_coord def)
 {
-	static scr_coord ret;
+	static thread_local scr_coord ret;
 	ret = def;
 	get_x_y( key, ret.x, ret.y );
 	return ret;
@@ -124,7 +124,7 @@ const scr_coord &tabfileobj_t::get_scr_coord(const char *key, scr_coord def)
 
 const scr_size &tabfileobj_t::get_scr_size(const char *key, scr_size def)
 {
-	static scr_size ret;
+	static thread_local scr_size ret;
 	ret = def;
 	get_x_y( key, ret.w, ret.h );
 	return ret;
@@ -0,0 +1,258 @@
+#include <stdint.h>
+#include <string.h>
+
+#include "../simtypes.h"
+#include "../simmem.h"
+#include "../simdebug.h"
+#include "../tpl/inthashtable_tpl.h"
+#include "../tpl/vector_tpl.h"
+#include "koord.h"
+#include "tile_arena.h"
+
+#ifdef MULTI_THREAD
+#include "../utils/simthread.h"
+// guards the pages, the slabs and the table of pools
+static pthread_mutex_t arena_mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+/* The pages are aligned to their size, so the pool of a node is found
+ * in the header at the start of its page. Pages are cut from larger slabs.
+ */
+#define ARENA_PAGE_SHIFT (16)
+#define ARENA_PAGE_SIZE ((size_t)1 << ARENA_PAGE_SHIFT)
+#define SLAB_PAGES (16)
+
+// the header gets a cacheline of its own
+#define PAGE_HEADER_SIZE (64)
+
+// all sizes are rounded up to a multiple of this
+#define NODE_ALIGN (8)
+#define NUM_LIST (tile_arena_t::MAX_NODE_SIZE/NODE_ALIGN+1)
+
+// the pool used before the first set_position()
+#define DEFAULT_POOL (0xFFFFFFFFu)
+
+// pages remembered per thread by alloc_near(), must be a power of two
+#define PAGE_CACHE_SIZE (64)
+
+struct arena_node_t
+{
+	arena_node_t *next;
+};
+
+struct pool_t
+{
+	// free nodes per size
+	arena_node_t *lists[NUM_LIST];
+	// unused rest of the newest page
+	char *top;
+	char *end;
+#ifdef MULTI_THREAD
+	pthread_mutex_t mutex;
+#endif
+};
+
+struct page_header_t
+{
+	pool_t *pool;
+};
+
+// pages not yet given to a pool
+static char *spare_pages = NULL;
+static uint32 spare_count = 0;
+
+// start of the first page of every slab, ascending
+static vector_tpl<char *> slabs;
+
+static inthashtable_tpl<uint32, pool_t *> pools;
+
+static thread_local pool_t *current_pool = NULL;
+static thread_local uint32 current_key = DEFAULT_POOL;
+
+// pages are never given back nor moved to another pool, so what alloc_near() found out about them stays true
+struct page_cache_entry_t
+{
+	uintptr_t page;
+	pool_t *pool;
+};
+static thread_local page_cache_entry_t page_cache[PAGE_CACHE_SIZE];
+
+
+static bool slab_less(char *a, char *b)
+{
+	return a < b;
+}
+
+
+static size_t round_size(size_t size)
+{
+	if(  size == 0  ||  size > tile_arena_t::MAX_NODE_SIZE  ) {
+		dbg->fatal( "tile_arena_t", "cannot allocate %u bytes", (unsigned)size );
+	}
+	return (size + NODE_ALIGN - 1) & ~(size_t)(NODE_ALIGN - 1);
+}
+
+
+static pool_t *page_pool(const void *p)
+{
+	return ((page_header_t *)((uintptr_t)p & ~(uintptr_t)(ARENA_PAGE_SIZE - 1)))->pool;
+}
+
+
+// to be called with the arena mutex held (if any)
+static pool_t *get_pool(uint32 key)
+{
+	pool_t *pool = pools.get( key );
+	if(  pool == NULL  ) {
+		pool = new pool_t;
+		memset( pool->lists, 0, sizeof(pool->lists) );
+		pool->top = pool->end = NULL;
+#ifdef MULTI_THREAD
+		pthread_mutex_init( &pool->mutex, NULL );
+#endif
+		pools.put( key, pool );
+	}
+	return pool;
+}
+
+
+// gives a new page to the pool; to be called with the mutex of the pool held (if any)
+static void new_page(pool_t *pool)
+{
+#ifdef MULTI_THREAD
+	pthread_mutex_lock( &arena_mutex );
+#endif
+	if(  spare_count == 0  ) {
+		char *slab = (char *)xmalloc( (SLAB_PAGES + 1) * ARENA_PAGE_SIZE );
+		spare_pages = (char *)(((uintptr_t)slab + ARENA_PAGE_SIZE - 1) & ~(uintptr_t)(ARENA_PAGE_SIZE - 1));
+		spare_count = SLAB_PAGES;
+		slabs.insert_ordered( spare_pages, slab_less );
+	}
+	char *page = spare_pages;
+	spare_pages += ARENA_PAGE_SIZE;
+	spare_count--;
+#ifdef MULTI_THREAD
+	pthread_mutex_unlock( &arena_mutex );
+#endif
+
+	((page_header_t *)page)->pool = pool;
+	pool->top = page + PAGE_HEADER_SIZE;
+	pool->end = page + ARENA_PAGE_SIZE;
+}
+
+
+static void *alloc_from(pool_t *pool, size_t size)
+{
+	size = round_size( size );
+	void *p;
+#ifdef MULTI_THREAD
+	pthread_mutex_lock( &pool->mutex );
+#endif
+	arena_node_t *&list = pool->lists[size / NODE_ALIGN];
+	if(  list  ) {
+		p = list;
+		list = list->next;
+	}
+	else {
+		if(  pool->top == NULL  ||  pool->top + size > pool->end  ) {
+			// the rest of the current page is lost, at most MAX_NODE_SIZE bytes
+			new_page( pool );
+		}
+		p = pool->top;
+		pool->top += size;
+	}
+#ifdef MULTI_THREAD
+	pthread_mutex_unlock( &pool->mutex );
+#endif
+	return p;
+}
+
+
+void tile_arena_t::set_position(const koord &k)
+{
+	const uint32 key = ((uint32)(uint16)(k.x >> BLOCK_SHIFT) << 16) | (uint16)(k.y >> BLOCK_SHIFT);
+	if(  current_pool == NULL  ||  key != current_key  ) {
+#ifdef MULTI_THREAD
+		pthread_mutex_lock( &arena_mutex );
+#endif
+		current_pool = get_pool( key );
+		current_key = key;
+#ifdef MULTI_THREAD
+		pthread_mutex_unlock( &arena_mutex );
+#endif
+	}
+}
+
+
+void *tile_arena_t::alloc(size_t size)
+{
+	if(  current_pool == NULL  ) {
+#ifdef MULTI_THREAD
+		pthread_mutex_lock( &arena_mutex );
+#endif
+		current_pool = get_pool( DEFAULT_POOL );
+		current_key = DEFAULT_POOL;
+#ifdef MULTI_THREAD
+		pthread_mutex_unlock( &arena_mutex );
+#endif
+	}
+	return alloc_from( current_pool, size );
+}
+
+
+void *tile_arena_t::alloc_near(const void *owner, size_t size)
+{
+	const uintptr_t page = (uintptr_t)owner >> ARENA_PAGE_SHIFT;
+	page_cache_entry_t &cached = page_cache[page & (PAGE_CACHE_SIZE - 1)];
+	if(  cached.pool  &&  cached.page == page  ) {
+		return alloc_from( cached.pool, size );
+	}
+
+	// owner may be anywhere, so only look at its page header if it is in one of our slabs
+	pool_t *pool = NULL;
+#ifdef MULTI_THREAD
+	pthread_mutex_lock( &arena_mutex );
+#endif
+	uint32 lo = 0, hi = slabs.get_count();
+	while(  lo < hi  ) {
+		const uint32 mid = (lo + hi) / 2;
+		if(  slabs[mid] <= (const char *)owner  ) {
+			lo = mid + 1;
+		}
+		else {
+			hi = mid;
+		}
+	}
+	if(  lo > 0  &&  (const char *)owner < slabs[lo - 1] + SLAB_PAGES * ARENA_PAGE_SIZE  ) {
+		pool = page_pool( owner );
+	}
+#ifdef MULTI_THREAD
+	pthread_mutex_unlock( &arena_mutex );
+#endif
+	if(  pool == NULL  ) {
+		// not ours, and not remembered, since the memory might become a slab later
+		return alloc( size );
+	}
+	cached.page = page;
+	cached.pool = pool;
+	return alloc_from( pool, size );
+}
+
+
+void tile_arena_t::free(void *p, size_t size)
+{
+	if(  p == NULL  ) {
+		return;
+	}
+	size = round_size( size );
+	pool_t *pool = page_pool( p );
+#ifdef MULTI_THREAD
+	pthread_mutex_lock( &pool->mutex );
+#endif
+	arena_node_t *node = (arena_node_t *)p;
+	node->next = pool->lists[size / NODE_ALIGN];
+	pool->lists[size / NODE_ALIGN] = node;
+#ifdef MULTI_THREAD
+	pthread_mutex_unlock( &pool->mutex );
+#endif
+}
@@ -0,0 +1,49 @@
+#ifndef tile_arena_h
+#define tile_arena_h
+
+#include <stddef.h>
+#include "../simtypes.h"
+
+class koord;
+
+/**
+ * Memory for the grounds of the map and the object lists on them.
+ *
+ * The map is divided into blocks of BLOCK_SIZE x BLOCK_SIZE tiles, and each
+ * block has its own pool of pages. Nodes are cut from the pages of the pool
+ * of the block being worked on, so that neighbouring tiles end up close to
+ * each other in memory instead of being scattered across the heap.
+ *
+ * The block is chosen by set_position(), which should be called before the
+ * grounds of a tile are created (when creating, loading or enlarging the map).
+ * Object lists are placed in the pool of the ground they belong to.
+ *
+ * Like the freelist, freed nodes are kept for reuse by their pool, and the
+ * memory is never given back.
+ */
+class tile_arena_t
+{
+public:
+	enum {
+		BLOCK_SHIFT = 6,
+		BLOCK_SIZE = 1 << BLOCK_SHIFT,
+		MAX_NODE_SIZE = 256
+	};
+
+	/// Nodes allocated by the calling thread go to the pool of the block containing @p k from now on
+	static void set_position(const koord &k);
+
+	/// @returns a node of @p size bytes (at most MAX_NODE_SIZE) from the pool of the current block
+	static void *alloc(size_t size);
+
+	/**
+	 * @returns a node of @p size bytes from the pool that holds @p owner, or the current one.
+	 * The pages looked up are remembered per thread, so this is usually done without locking.
+	 */
+	static void *alloc_near(const void *owner, size_t size);
+
+	/// Returns a node obtained by alloc() or alloc_near() to its pool
+	static void free(void *p, size_t size);
+};
+
+#endif
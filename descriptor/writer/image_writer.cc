@@ -2,6 +2,11 @@
 #include <stdio.h>
 #include <string.h>
 #include <string>
+#include <map>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <chrono>
 #include "image_writer.h"
 #include "root_writer.h"
 #include "obj_node.h"
@@ -24,12 +29,203 @@ struct dimension
 static int special_hist[SPECIAL];
 
 
-std::string image_writer_t::last_img_file;
+thread_local std::string image_writer_t::last_img_file;
 
-unsigned image_writer_t::width;
-unsigned image_writer_t::height;
-unsigned char* image_writer_t::block = NULL;
-int image_writer_t::img_size = 64;
+thread_local unsigned image_writer_t::width;
+thread_local unsigned image_writer_t::height;
+thread_local unsigned char* image_writer_t::block = NULL;
+thread_local int image_writer_t::img_size = 64;
+
+
+// the tile of a png file (by its content) an image is cut from
+struct image_key_t
+{
+	uint64 png_hash;
+	sint32 img_size;
+	sint32 row;
+	sint32 col;
+
+	bool operator <(const image_key_t &o) const
+	{
+		if(  png_hash != o.png_hash  ) {
+			return png_hash < o.png_hash;
+		}
+		if(  img_size != o.img_size  ) {
+			return img_size < o.img_size;
+		}
+		return row != o.row ? row < o.row : col < o.col;
+	}
+};
+
+// an encoded image, without the offsets given in the image key
+struct encoded_image_t
+{
+	sint32 x, y;
+	sint32 w, h;
+	std::vector<uint16> data;
+};
+
+struct png_size_t
+{
+	uint32 width;
+	uint32 height;
+};
+
+static std::mutex cache_mutex;
+static std::map<std::string, uint64> png_hashes;	// by file name, only for this run
+static std::map<uint64, png_size_t> png_sizes;	// by content
+static std::map<image_key_t, encoded_image_t> encoded_images;
+
+// statistics, in microseconds
+static std::atomic<uint64> decode_time(0);
+static std::atomic<uint64> encode_time(0);
+static std::atomic<uint32> decoded_count(0);
+static std::atomic<uint32> encoded_count(0);
+static std::atomic<uint32> cached_count(0);
+
+#define CACHE_MAGIC "MOIC"
+
+static uint64 get_microseconds()
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+
+// FNV-1a over the file content; false if it cannot be read
+static bool get_png_hash(const std::string &fname, uint64 &hash)
+{
+	{
+		std::lock_guard<std::mutex> lock(cache_mutex);
+		std::map<std::string, uint64>::const_iterator i = png_hashes.find(fname);
+		if(  i != png_hashes.end()  ) {
+			hash = i->second;
+			return true;
+		}
+	}
+
+	FILE *fp = fopen(fname.c_str(), "rb");
+	if(  !fp  ) {
+		return false;
+	}
+	hash = 0xCBF29CE484222325ull;
+	unsigned char buf[16384];
+	size_t n;
+	while(  (n = fread(buf, 1, sizeof(buf), fp)) > 0  ) {
+		for(  size_t i = 0;  i < n;  i++  ) {
+			hash = (hash ^ buf[i]) * 0x100000001B3ull;
+		}
+	}
+	fclose(fp);
+
+	std::lock_guard<std::mutex> lock(cache_mutex);
+	png_hashes[fname] = hash;
+	return true;
+}
+
+
+void image_writer_t::load_cache(const char* fname)
+{
+	FILE *fp = fopen(fname, "rb");
+	if(  !fp  ) {
+		return;
+	}
+	char magic[4];
+	uint32 version = 0, count = 0;
+	if(  fread(magic, 4, 1, fp) != 1  ||  memcmp(magic, CACHE_MAGIC, 4) != 0  ||  fread(&version, 4, 1, fp) != 1  ||  version != COMPILER_VERSION_CODE  ) {
+		// written by another version, which may encode differently
+		fclose(fp);
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(cache_mutex);
+	bool ok = fread(&count, 4, 1, fp) == 1;
+	for(  uint32 i = 0;  ok  &&  i < count;  i++  ) {
+		uint64 hash;
+		png_size_t size;
+		ok = fread(&hash, 8, 1, fp) == 1  &&  fread(&size, sizeof(size), 1, fp) == 1;
+		if(  ok  ) {
+			png_sizes[hash] = size;
+		}
+	}
+	ok = ok  &&  fread(&count, 4, 1, fp) == 1;
+	for(  uint32 i = 0;  ok  &&  i < count;  i++  ) {
+		image_key_t key;
+		encoded_image_t img;
+		sint32 dims[4];
+		uint32 len;
+		ok = fread(&key, sizeof(key), 1, fp) == 1  &&  fread(dims, sizeof(dims), 1, fp) == 1  &&  fread(&len, 4, 1, fp) == 1;
+		if(  ok  ) {
+			img.x = dims[0];
+			img.y = dims[1];
+			img.w = dims[2];
+			img.h = dims[3];
+			img.data.resize(len);
+			ok = len == 0  ||  fread(&img.data[0], len * sizeof(uint16), 1, fp) == 1;
+			if(  ok  ) {
+				encoded_images[key] = img;
+			}
+		}
+	}
+	if(  !ok  ) {
+		dbg->warning("image_writer_t::load_cache", "%s is damaged, images may be encoded again", fname);
+	}
+	fclose(fp);
+}
+
+
+bool image_writer_t::save_cache(const char* fname)
+{
+	std::string tmp_name = fname;
+	tmp_name += ".tmp";
+	FILE *fp = fopen(tmp_name.c_str(), "wb");
+	if(  !fp  ) {
+		dbg->warning("image_writer_t::save_cache", "Cannot create %s", tmp_name.c_str());
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(cache_mutex);
+	const uint32 version = COMPILER_VERSION_CODE;
+	fwrite(CACHE_MAGIC, 4, 1, fp);
+	fwrite(&version, 4, 1, fp);
+
+	uint32 count = png_sizes.size();
+	fwrite(&count, 4, 1, fp);
+	for(  std::map<uint64, png_size_t>::const_iterator i = png_sizes.begin();  i != png_sizes.end();  ++i  ) {
+		fwrite(&i->first, 8, 1, fp);
+		fwrite(&i->second, sizeof(png_size_t), 1, fp);
+	}
+
+	count = encoded_images.size();
+	fwrite(&count, 4, 1, fp);
+	for(  std::map<image_key_t, encoded_image_t>::const_iterator i = encoded_images.begin();  i != encoded_images.end();  ++i  ) {
+		const encoded_image_t &img = i->second;
+		const sint32 dims[4] = { img.x, img.y, img.w, img.h };
+		const uint32 len = img.data.size();
+		fwrite(&i->first, sizeof(image_key_t), 1, fp);
+		fwrite(dims, sizeof(dims), 1, fp);
+		fwrite(&len, 4, 1, fp);
+		if(  len  ) {
+			fwrite(&img.data[0], len * sizeof(uint16), 1, fp);
+		}
+	}
+	const bool ok = !ferror(fp);
+	fclose(fp);
+
+	remove(fname);
+	if(  !ok  ||  rename(tmp_name.c_str(), fname) != 0  ) {
+		dbg->warning("image_writer_t::save_cache", "Cannot write %s", fname);
+		remove(tmp_name.c_str());
+		return false;
+	}
+	return true;
+}
+
+
+void image_writer_t::print_statistics()
+{
+	printf("images: %u png files decoded (%.2f s), %u images encoded (%.2f s), %u images from cache\n",
+		(unsigned)decoded_count, decode_time / 1000000.0, (unsigned)encoded_count, encode_time / 1000000.0, (unsigned)cached_count );
+}
 
 
 void image_writer_t::dump_special_histogramm()
@@ -244,7 +440,13 @@ uint16 *image_writer_t::encode_image(int x, int y, dimension* dim, int* len)
 bool image_writer_t::block_load(const char* fname)
 {
 	// The last png-file is cached
-	if(  last_img_file == fname  ||  load_block(&block, &width, &height, fname, img_size)  ) {
+	if(  last_img_file == fname  ) {
+		return true;
+	}
+	const uint64 start = get_microseconds();
+	if(  load_block(&block, &width, &height, fname, img_size)  ) {
+		decode_time += get_microseconds() - start;
+		decoded_count++;
 		last_img_file = fname;
 		return true;
 	}
@@ -265,8 +467,8 @@ bool image_writer_t::block_load(const char* fname)
 void image_writer_t::write_obj(FILE* outfp, obj_node_t& parent, std::string an_imagekey, uint32 index)
 {
 	image_t image;
-	dimension dim;
-	uint16 *pixdata = NULL;
+	encoded_image_t encoded;
+	const uint16 *pixdata = NULL;
 
 	MEMZERO(image);
 
@@ -322,13 +524,39 @@ void image_writer_t::write_obj(FILE* outfp, obj_node_t& parent, std::string an_i
 			}
 		}
 
-		// Load complete file
-		if (!block_load(imagekey.c_str())) {
+		uint64 png_hash;
+		if (!get_png_hash(imagekey, png_hash)) {
 			char reason[1024];
 			sprintf(reason, "cannot open %s", imagekey .c_str());
 			throw obj_pak_exception_t("image_writer_t", reason);
 		}
 
+		// the size of the png file is only known after loading it once
+		bool size_known;
+		{
+			std::lock_guard<std::mutex> lock(cache_mutex);
+			std::map<uint64, png_size_t>::const_iterator i = png_sizes.find(png_hash);
+			size_known = i != png_sizes.end();
+			if(  size_known  ) {
+				width = i->second.width;
+				height = i->second.height;
+			}
+		}
+		if (!size_known) {
+			// Load complete file
+			if (!block_load(imagekey.c_str())) {
+				char reason[1024];
+				sprintf(reason, "cannot open %s", imagekey .c_str());
+				throw obj_pak_exception_t("image_writer_t", reason);
+			}
+			png_size_t size = { width, height };
+			std::lock_guard<std::mutex> lock(cache_mutex);
+			png_sizes[png_hash] = size;
+		}
+		else if (width % img_size != 0  ||  height % img_size != 0) {
+			dbg->fatal("while loading PNG", "Invalid image size in %s.", imagekey.c_str());
+		}
+
 		if (col == -1) {
 			col = row % (width / img_size);
 			row = row / (width / img_size);
@@ -341,26 +569,64 @@ void image_writer_t::write_obj(FILE* outfp, obj_node_t& parent, std::string an_i
 		row *= img_size;
 		col *= img_size;
 
-		// Temp. read image and determine drawing area.
-		uint32 *image_data = new uint32[img_size * img_size];
-		for (int x = 0; x < img_size; x++) {
-			for (int y = 0; y < img_size; y++) {
-				image_data[x + y * img_size] = block_getpix(x + col, y + row);
+		const image_key_t key = { png_hash, img_size, row, col };
+		bool cached;
+		{
+			std::lock_guard<std::mutex> lock(cache_mutex);
+			std::map<image_key_t, encoded_image_t>::const_iterator i = encoded_images.find(key);
+			cached = i != encoded_images.end();
+			if(  cached  ) {
+				encoded = i->second;
 			}
 		}
-		init_dim(image_data, &dim, img_size);
-		delete[] image_data;
-
-		image.x += dim.xmin;
-		image.y += dim.ymin;
-		image.w = dim.xmax - dim.xmin + 1;
-		image.h = dim.ymax - dim.ymin + 1;
-		image.len = 0;
-
-		if (image.h > 0) {
-			int len;
-			pixdata = encode_image(col, row, &dim, &len);
-			image.len = len;
+
+		if (cached) {
+			cached_count++;
+		}
+		else {
+			if (!block_load(imagekey.c_str())) {
+				char reason[1024];
+				sprintf(reason, "cannot open %s", imagekey .c_str());
+				throw obj_pak_exception_t("image_writer_t", reason);
+			}
+			const uint64 start = get_microseconds();
+
+			// Temp. read image and determine drawing area.
+			dimension dim;
+			uint32 *image_data = new uint32[img_size * img_size];
+			for (int x = 0; x < img_size; x++) {
+				for (int y = 0; y < img_size; y++) {
+					image_data[x + y * img_size] = block_getpix(x + col, y + row);
+				}
+			}
+			init_dim(image_data, &dim, img_size);
+			delete[] image_data;
+
+			encoded.x = dim.xmin;
+			encoded.y = dim.ymin;
+			encoded.w = dim.xmax - dim.xmin + 1;
+			encoded.h = dim.ymax - dim.ymin + 1;
+
+			if (encoded.h > 0) {
+				int len;
+				uint16 *data = encode_image(col, row, &dim, &len);
+				encoded.data.assign(data, data + len);
+				delete [] data;
+			}
+			encode_time += get_microseconds() - start;
+			encoded_count++;
+
+			std::lock_guard<std::mutex> lock(cache_mutex);
+			encoded_images[key] = encoded;
+		}
+
+		image.x += encoded.x;
+		image.y += encoded.y;
+		image.w = encoded.w;
+		image.h = encoded.h;
+		image.len = encoded.data.size();
+		if (image.len) {
+			pixdata = &encoded.data[0];
 		}
 
 		dbg->debug( "", "image[%3u] =%-30s %-20s %5u %5u %5u %5u %5u %6u %4s", index, an_imagekey.c_str(), imagekey.c_str(), col, row, image.x, image.y, image.w, image.h, (image.zoomable) ? "yes" : "no" );
@@ -386,7 +652,6 @@ void image_writer_t::write_obj(FILE* outfp, obj_node_t& parent, std::string an_i
 	if (image.len) {
 		// only called, if there is something to store
 		node.write_data_at(outfp, pixdata, 12, image.len * sizeof(PIXVAL));
-		delete [] pixdata;
 	}
 #elif IMG_VERSION2
 	// version 1 or 2
@@ -404,7 +669,6 @@ void image_writer_t::write_obj(FILE* outfp, obj_node_t& parent, std::string an_i
 	if (image.len) {
 		// only called, if there is something to store
 		node.write_data_at(outfp, pixdata, 10, image.len * sizeof(PIXVAL));
-		delete [] pixdata;
 	}
 #else
 	// version 3
@@ -422,7 +686,6 @@ void image_writer_t::write_obj(FILE* outfp, obj_node_t& parent, std::string an_i
 	if (image.len) {
 		// only called, if there is something to store
 		node.write_data_at(outfp, pixdata, 10, image.len * sizeof(uint16));
-		delete [] pixdata;
 	}
 #endif
 
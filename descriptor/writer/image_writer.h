@@ -11,15 +11,22 @@ class obj_node_t;
 struct dimension;
 
 
+/*
+ * Encoded images are cached by the content of their png file, so images
+ * used more than once, or kept unchanged between runs (see load_cache()),
+ * are neither decoded nor encoded again.
+ * Several .dat files may be compiled at once, so the png file being
+ * worked on is kept per thread.
+ */
 class image_writer_t : public obj_writer_t {
 	private:
 		static image_writer_t the_instance;
 
-		static std::string last_img_file;
-		static unsigned char* block;
-		static unsigned width;
-		static unsigned height;
-		static int img_size;	// default 64
+		static thread_local std::string last_img_file;
+		static thread_local unsigned char* block;
+		static thread_local unsigned width;
+		static thread_local unsigned height;
+		static thread_local int img_size;	// default 64
 
 		image_writer_t() { register_writer(false); }
 
@@ -28,6 +35,13 @@ class image_writer_t : public obj_writer_t {
 	public:
 		static void dump_special_histogramm();
 
+		/// reads the images encoded by previous runs; a missing or outdated file is ignored
+		static void load_cache(const char* fname);
+		static bool save_cache(const char* fname);
+
+		/// prints the time spent on decoding and encoding images
+		static void print_statistics();
+
 		static image_writer_t* instance() { return &the_instance; }
 
 		static void set_img_size(int _img_size) { img_size = _img_size; }
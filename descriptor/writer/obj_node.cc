@@ -4,7 +4,7 @@
 #include "../obj_desc.h"
 
 
-uint32 obj_node_t::free_offset;	    // next free offset in file
+thread_local uint32 obj_node_t::free_offset;	    // next free offset in file
 
 
 obj_node_t::obj_node_t(obj_writer_t* writer, uint32 size, obj_node_t* parent)
@@ -10,7 +10,7 @@ class  obj_writer_t;
 
 class obj_node_t {
 	private:
-		static uint32 free_offset; // next free offset in file
+		static thread_local uint32 free_offset; // next free offset in file (each thread writes its own file)
 
 		obj_node_info_t desc;
 
@@ -56,6 +56,11 @@ class obj_node_t {
 		// Write the internal node info to the file
 		// DO THIS AFTER ALL CHILD NODES ARE WRITTEN !!!
 		void write(FILE* fp);
+
+		uint16 get_children() const { return desc.children; }
+
+		// for child nodes which were written to another file and copied over
+		void add_children(uint16 count) { desc.children += count; }
 };
 
 #endif
@@ -11,7 +11,7 @@
 #include "xref_writer.h"
 
 
-const char *obj_writer_t::last_name = "";
+thread_local const char *obj_writer_t::last_name = "";
 
 int obj_writer_t::default_image_size = 64;
 
@@ -40,8 +40,8 @@ protected:
 	void write_head(FILE* fp, obj_node_t& node, tabfileobj_t& obj);
 
 public:
-	// contains the name of the last obj/name header
-	static const char *last_name;
+	// contains the name of the last obj/name header (of this thread)
+	static thread_local const char *last_name;
 
 	virtual ~obj_writer_t() {}
 
@@ -1,15 +1,23 @@
 #include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
 #include <stdlib.h>
+#include <string.h>
 #include "../../dataobj/tabfile.h"
 #include "../../utils/searchfolder.h"
 #include "../obj_desc.h"
 #include "obj_node.h"
 #include "obj_writer.h"
+#include "obj_pak_exception.h"
+#include "image_writer.h"
 #include "root_writer.h"
 
 using std::string;
 
-string root_writer_t::inpath;
+thread_local string root_writer_t::inpath;
+unsigned root_writer_t::threads = 0;
 
 void root_writer_t::write_header(FILE* fp)
 {
@@ -25,12 +33,150 @@ void root_writer_t::write_header(FILE* fp)
 }
 
 
+// a .dat file to compile
+struct dat_job_t
+{
+	string name;
+	string inpath;
+	FILE* tmp;       // the compiled objects, unless they are written to individual files
+	uint16 children; // number of objects in tmp
+	bool failed;
+	string error_class;
+	string error_info;
+};
+
+// all .dat files, in the order their objects are written
+static std::vector<dat_job_t> dat_jobs;
+static std::atomic<uint32> next_dat_job;
+
+
+static double get_seconds_since(const std::chrono::steady_clock::time_point &start)
+{
+	return std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+}
+
+
+// keeps the old file (and its date), if it is the same as the new one
+static void replace_if_changed(const string &tmp_name, const string &name)
+{
+	bool same = false;
+	FILE* const newfp = fopen(tmp_name.c_str(), "rb");
+	FILE* const oldfp = fopen(name.c_str(), "rb");
+	if (newfp && oldfp) {
+		char newbuf[16384], oldbuf[16384];
+		size_t n;
+		do {
+			n = fread(newbuf, 1, sizeof(newbuf), newfp);
+			same = fread(oldbuf, 1, sizeof(oldbuf), oldfp) == n  &&  memcmp(newbuf, oldbuf, n) == 0;
+		} while (same  &&  n > 0);
+	}
+	if (newfp) {
+		fclose(newfp);
+	}
+	if (oldfp) {
+		fclose(oldfp);
+	}
+
+	if (same) {
+		printf("   %s unchanged\n", name.c_str());
+		remove(tmp_name.c_str());
+	}
+	else {
+		remove(name.c_str());
+		if (rename(tmp_name.c_str(), name.c_str()) != 0) {
+			dbg->fatal( "Write pak", "Cannot create destination file %s", name.c_str() );
+			exit(3);
+		}
+	}
+}
+
+
+void root_writer_t::write_dat(dat_job_t& job, const char* filename, bool separate)
+{
+	tabfile_t infile;
+
+	if (!infile.open(job.name.c_str())) {
+		dbg->warning( "Write pak", "Cannot read %s", job.name.c_str());
+		return;
+	}
+
+	printf("   reading file %s\n", job.name.c_str());
+
+	inpath = job.inpath;
+
+	obj_node_t* node = NULL;
+	if (!separate) {
+		// will be copied behind the root node of the pak file
+		job.tmp = tmpfile();
+		if (!job.tmp) {
+			dbg->fatal( "Write pak", "Cannot create temporary file for %s", job.name.c_str() );
+			exit(3);
+		}
+		obj_node_t::set_start_offset(0);
+		node = new obj_node_t(this, 0, NULL);
+	}
+
+	FILE* outfp = job.tmp;
+	string name;
+	try {
+		tabfileobj_t obj;
+
+		while(infile.read(obj)) {
+			if(separate) {
+				name = string(filename) + obj.get("obj") + "." + obj.get("name") + ".pak";
+
+				outfp = fopen((name + ".tmp").c_str(), "wb");
+				if (!outfp) {
+					dbg->fatal( "Write pak", "Cannot create destination file %s", name.c_str() );
+					exit(3);
+				}
+				printf("   writing file %s\n", name.c_str());
+				write_header(outfp);
+
+				node = new obj_node_t(this, 0, NULL);
+			}
+			obj_writer_t::write(outfp, *node, obj);
+			obj.unused( "#;-/" );
+
+			if(separate) {
+				node->write(outfp);
+				delete node;
+				node = NULL;
+				fclose(outfp);
+				outfp = NULL;
+				replace_if_changed(name + ".tmp", name);
+			}
+		}
+	}
+	catch (const obj_pak_exception_t& e) {
+		job.failed = true;
+		job.error_class = e.get_class();
+		job.error_info = e.get_info();
+		if (separate  &&  outfp) {
+			fclose(outfp);
+			remove((name + ".tmp").c_str());
+		}
+	}
+
+	if (node) {
+		job.children = node->get_children();
+		delete node;
+	}
+}
+
+
+void root_writer_t::compile_dats(root_writer_t* writer, const char* filename, bool separate)
+{
+	for(  uint32 i = next_dat_job++;  i < dat_jobs.size();  i = next_dat_job++  ) {
+		writer->write_dat(dat_jobs[i], filename, separate);
+	}
+}
+
+
 // makes pak file(s)
 void root_writer_t::write(const char* filename, int argc, char* argv[])
 {
 	searchfolder_t find;
-	FILE* outfp = NULL;
-	obj_node_t* node = NULL;
 	bool separate = false;
 	string file = find.complete(filename, "pak");
 
@@ -39,76 +185,111 @@ void root_writer_t::write(const char* filename, int argc, char* argv[])
 		separate = true;
 	}
 	else {
-		outfp = fopen(file.c_str(), "wb");
-
-		if (!outfp) {
-			dbg->fatal( "Write pak", "Cannot create destination file %s", filename );
-			exit(3);
-		}
 		printf("writing file %s\n", filename);
-		write_header(outfp);
-
-		node = new obj_node_t(this, 0, NULL);
 	}
 
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	dat_jobs.clear();
 	for(  int i=0;  i==0  ||  i<argc;  i++  ) {
 		const char* arg = (i < argc) ? argv[i] : "./";
 
-		find.search(arg, "dat");
-		FOR(searchfolder_t, const& i, find) {
-			tabfile_t infile;
-
-			if (infile.open(i)) {
-				tabfileobj_t obj;
+		string path = arg;
+		string::size_type n = path.rfind('/');
 
-				printf("   reading file %s\n", i);
+		if(n!=string::npos) {
+			path = path.substr(0, n + 1);
+		}
+		else {
+			path = "";
+		}
 
-				inpath = arg;
-				string::size_type n = inpath.rfind('/');
+		find.search(arg, "dat");
+		FOR(searchfolder_t, const& i, find) {
+			dat_job_t job;
+			job.name = i;
+			job.inpath = path;
+			job.tmp = NULL;
+			job.children = 0;
+			job.failed = false;
+			dat_jobs.push_back(job);
+		}
+	}
 
-				if(n!=string::npos) {
-					inpath = inpath.substr(0, n + 1);
-				}
-				else {
-					inpath = "";
+	// the .dat files are independent, so they are compiled at once
+	unsigned count = threads ? threads : std::thread::hardware_concurrency();
+	if (count > dat_jobs.size()) {
+		count = dat_jobs.size();
+	}
+	if (count == 0) {
+		count = 1;
+	}
+	next_dat_job = 0;
+	if (count <= 1) {
+		compile_dats(this, filename, separate);
+	}
+	else {
+		std::vector<std::thread> workers;
+		for (unsigned t = 0; t < count; t++) {
+			workers.push_back(std::thread(compile_dats, this, filename, separate));
+		}
+		for (unsigned t = 0; t < count; t++) {
+			workers[t].join();
+		}
+	}
+	const double compile_seconds = get_seconds_since(start);
+
+	// the first error in file order, as if compiled one after the other
+	for (uint32 i = 0; i < dat_jobs.size(); i++) {
+		if (dat_jobs[i].failed) {
+			const obj_pak_exception_t e(dat_jobs[i].error_class.c_str(), dat_jobs[i].error_info.c_str());
+			for (uint32 j = 0; j < dat_jobs.size(); j++) {
+				if (dat_jobs[j].tmp) {
+					fclose(dat_jobs[j].tmp);
 				}
+			}
+			dat_jobs.clear();
+			throw e;
+		}
+	}
 
-				while(infile.read(obj)) {
-					if(separate) {
-						string name(filename);
-
-						name = name + obj.get("obj") + "." + obj.get("name") + ".pak";
-
-						outfp = fopen(name.c_str(), "wb");
-						if (!outfp) {
-							dbg->fatal( "Write pak", "Cannot create destination file %s", filename );
-							exit(3);
-						}
-						printf("   writing file %s\n", name.c_str());
-						write_header(outfp);
+	const std::chrono::steady_clock::time_point write_start = std::chrono::steady_clock::now();
+	if (!separate) {
+		const string tmp_name = file + ".tmp";
+		FILE* outfp = fopen(tmp_name.c_str(), "wb");
 
-						node = new obj_node_t(this, 0, NULL);
-					}
-					obj_writer_t::write(outfp, *node, obj);
-					obj.unused( "#;-/" );
+		if (!outfp) {
+			dbg->fatal( "Write pak", "Cannot create destination file %s", filename );
+			exit(3);
+		}
+		write_header(outfp);
 
-					if(separate) {
-						node->write(outfp);
-						delete node;
-						fclose(outfp);
-					}
+		obj_node_t node(this, 0, NULL);
+		// the objects follow the root node, which is written last
+		fseek(outfp, OBJ_NODE_INFO_SIZE, SEEK_CUR);
+		for (uint32 i = 0; i < dat_jobs.size(); i++) {
+			FILE* const tmp = dat_jobs[i].tmp;
+			if (tmp) {
+				// without the place of the root node it was compiled under
+				char buf[16384];
+				size_t n;
+				fseek(tmp, OBJ_NODE_INFO_SIZE, SEEK_SET);
+				while ((n = fread(buf, 1, sizeof(buf), tmp)) > 0) {
+					fwrite(buf, 1, n, outfp);
 				}
-			}
-			else {
-				dbg->warning( "Write pak", "Cannot read %s", i);
+				fclose(tmp);
+				node.add_children(dat_jobs[i].children);
 			}
 		}
-	}
-	if (!separate) {
-		node->write(outfp);
-		delete node;
+		node.write(outfp);
 		fclose(outfp);
+
+		replace_if_changed(tmp_name, file);
 	}
+	dat_jobs.clear();
+
+	printf("compiled %s in %.2f s (%u threads), written in %.2f s\n", filename, compile_seconds, count, get_seconds_since(write_start));
+	image_writer_t::print_statistics();
 }
 
 
@@ -7,16 +7,24 @@
 #include "../objversion.h"
 
 struct obj_node_info_t;
+struct dat_job_t;
 
 
 class root_writer_t : public obj_writer_t {
 	private:
 		static root_writer_t the_instance;
 
-		static std::string inpath;
+		static thread_local std::string inpath;
+
+		// number of .dat files compiled at once
+		static unsigned threads;
 
 		root_writer_t() { register_writer(false); }
 
+		// compiles one .dat file, either in a file of its own or into individual files
+		void write_dat(dat_job_t& job, const char* filename, bool separate);
+		static void compile_dats(root_writer_t* writer, const char* filename, bool separate);
+
 		void copy_nodes(FILE* outfp, FILE* infp, obj_node_info_t& info);
 		void write_header(FILE* fp);
 		void write_obj_node_info_t(FILE* outfp, const obj_node_info_t &root);
@@ -28,6 +36,9 @@ class root_writer_t : public obj_writer_t {
 		virtual const char* get_type_name() const { return "root"; }
 
 		void write(const char* name, int argc, char* argv[]);
+
+		/// 0 uses all processors
+		static void set_threads(unsigned count) { threads = count; }
 		void dump(int argc, char* argv[]);
 		void list(int argc, char* argv[]);
 		void copy(const char* name, int argc, char* argv[]);
@@ -140,6 +140,9 @@ void reset_textur(void *new_textur);
 */
 uint16 display_load_font(const char* fname);
 
+/// Switches the cache of laid out text runs on or off (for benchmarking)
+void display_set_text_run_cache(bool on);
+
 image_id get_image_count();
 void register_image(class image_t *);
 
@@ -257,6 +260,14 @@ inline void display_set_image_proc(bool is_global)
 void display_blend_wh_rgb(KOORD_VAL xp, KOORD_VAL yp, KOORD_VAL w, KOORD_VAL h, PIXVAL color, int percent_blend);
 #define display_blend_wh(xp,yp,w,h,color,percent_blend) display_blend_wh_rgb( xp,yp,w,h,specialcolormap_all_day[(color)&0xFF],percent_blend )
 
+/**
+ * Copies a rectangle of the screen to buf (w*h pixels) and back again.
+ * Used by the window manager for showing windows which did not change.
+ * @return false if the rectangle is not completely on the screen
+ */
+bool display_save_rect(PIXVAL *buf, KOORD_VAL xp, KOORD_VAL yp, KOORD_VAL w, KOORD_VAL h);
+bool display_restore_rect(const PIXVAL *buf, KOORD_VAL xp, KOORD_VAL yp, KOORD_VAL w, KOORD_VAL h);
+
 void display_fillbox_wh_rgb(KOORD_VAL xp, KOORD_VAL yp, KOORD_VAL w, KOORD_VAL h, PIXVAL color, bool dirty);
 #define display_fillbox_wh(xp,yp,w,h,color,dirty) display_fillbox_wh_rgb( xp,yp,w,h,specialcolormap_all_day[(color)&0xFF],dirty)
 
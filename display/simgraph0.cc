@@ -65,6 +65,10 @@ uint16 display_load_font(const char*)
 	return 1;
 }
 
+void display_set_text_run_cache(bool)
+{
+}
+
 sint16 display_get_width()
 {
 	return 0;
@@ -235,6 +239,18 @@ void display_blend_wh_rgb(KOORD_VAL, KOORD_VAL, KOORD_VAL, KOORD_VAL, PIXVAL, in
 }
 
 
+bool display_save_rect(PIXVAL *, KOORD_VAL, KOORD_VAL, KOORD_VAL, KOORD_VAL)
+{
+	return false;
+}
+
+
+bool display_restore_rect(const PIXVAL *, KOORD_VAL, KOORD_VAL, KOORD_VAL, KOORD_VAL)
+{
+	return false;
+}
+
+
 void display_fillbox_wh_rgb(KOORD_VAL, KOORD_VAL, KOORD_VAL, KOORD_VAL, PLAYER_COLOR_VAL, bool)
 {
 }
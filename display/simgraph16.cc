@@ -8,6 +8,7 @@
 #include <stdio.h>
 #include <math.h>
 #include <algorithm>
+#include <atomic>
 
 #include "../macros.h"
 #include "../simtypes.h"
@@ -3110,6 +3111,30 @@ static blend_proc blend_recode[3];
 static blend_proc outline[3];
 
 
+bool display_save_rect(PIXVAL *buf, KOORD_VAL xp, KOORD_VAL yp, KOORD_VAL w, KOORD_VAL h)
+{
+	if (xp < 0 || yp < 0 || w <= 0 || h <= 0 || xp + w > disp_actual_width || yp + h > disp_height) {
+		return false;
+	}
+	for (KOORD_VAL y = 0; y < h; y++) {
+		memcpy(buf + y * w, textur + (yp + y) * disp_width + xp, w * sizeof(PIXVAL));
+	}
+	return true;
+}
+
+
+bool display_restore_rect(const PIXVAL *buf, KOORD_VAL xp, KOORD_VAL yp, KOORD_VAL w, KOORD_VAL h)
+{
+	if (xp < 0 || yp < 0 || w <= 0 || h <= 0 || xp + w > disp_actual_width || yp + h > disp_height) {
+		return false;
+	}
+	for (KOORD_VAL y = 0; y < h; y++) {
+		memcpy(textur + (yp + y) * disp_width + xp, buf + y * w, w * sizeof(PIXVAL));
+	}
+	return true;
+}
+
+
 /**
 * Blends a rectangular region with a color
 */
@@ -3950,6 +3975,127 @@ void display_array_wh(KOORD_VAL xp, KOORD_VAL yp, KOORD_VAL w, KOORD_VAL h, cons
 
 // --------------------------------- text rendering stuff ------------------------------
 
+/*
+ * Laid out text runs: list windows draw the same short names every frame,
+ * so the glyphs and widths of those are only looked up once.
+ * The runs are keyed by the bytes of the text rather than by its pointer,
+ * since names and translations are often rebuilt in the same buffer; a
+ * changed translation just misses. Loading a font invalidates all runs.
+ * The colour is not part of the key, since it does not change the layout.
+ * The world is drawn by several threads, so each has its own cache.
+ */
+#define TEXT_RUN_MAX_BYTES (48)
+#define TEXT_RUN_CACHE_SIZE (512) // must be a power of two
+
+struct text_run_t
+{
+	uint32 hash;
+	uint8 bytes;   // length of the text, 0 for an empty entry
+	uint8 glyphs;
+	uint16 width;
+	char text[TEXT_RUN_MAX_BYTES];
+	uint16 code[TEXT_RUN_MAX_BYTES];        // glyph in the font, 0 for missing characters
+	uint8 advance[TEXT_RUN_MAX_BYTES];      // screen width incl. spacing
+	uint8 byte_length[TEXT_RUN_MAX_BYTES];  // of the utf8 sequence
+};
+
+struct text_run_cache_t
+{
+	text_run_t *runs;
+	uint32 generation;
+
+	text_run_cache_t() : runs(NULL), generation(0) {}
+	~text_run_cache_t() { free(runs); }
+};
+
+// atomic, since they are read by all threads which draw text
+static std::atomic<bool> text_run_cache_enabled(true);
+
+// incremented with every loaded font
+static std::atomic<uint32> text_run_generation(1);
+
+static thread_local text_run_cache_t text_run_cache;
+
+
+void display_set_text_run_cache(bool on)
+{
+	text_run_cache_enabled = on;
+	text_run_generation++;
+}
+
+
+/**
+ * @returns the laid out run of the first len bytes of txt (or up to its end),
+ * or NULL if the text is too long to be cached
+ */
+static const text_run_t *get_text_run(const char *txt, size_t len)
+{
+	if(  !text_run_cache_enabled  ) {
+		return NULL;
+	}
+
+	size_t n = 0;
+	while(  n < len  &&  txt[n] != 0  ) {
+		if(  n == TEXT_RUN_MAX_BYTES  ) {
+			return NULL;
+		}
+		n++;
+	}
+	if(  n == 0  ) {
+		return NULL;
+	}
+
+	uint32 hash = 2166136261u;
+	for(  size_t i = 0;  i < n;  i++  ) {
+		hash = (hash ^ (uint8)txt[i]) * 16777619u;
+	}
+
+	text_run_cache_t &cache = text_run_cache;
+	const uint32 generation = text_run_generation;
+	if(  cache.generation != generation  ) {
+		if(  cache.runs == NULL  ) {
+			cache.runs = MALLOCN(text_run_t, TEXT_RUN_CACHE_SIZE);
+		}
+		memset( cache.runs, 0, sizeof(text_run_t) * TEXT_RUN_CACHE_SIZE );
+		cache.generation = generation;
+	}
+
+	text_run_t &run = cache.runs[hash & (TEXT_RUN_CACHE_SIZE - 1)];
+	if(  run.bytes == n  &&  run.hash == hash  &&  memcmp( run.text, txt, n ) == 0  ) {
+		return &run;
+	}
+
+	// lay it out like display_text_proportional_len_clip_rgb() would
+	const font_type* const fnt = &large_font;
+	size_t pos = 0;
+	uint32 glyphs = 0;
+	uint32 width = 0;
+	while(  pos < n  ) {
+		const size_t start = pos;
+		uint16 c = utf8_to_utf16( (utf8 const*)txt + pos, &pos );
+		if(  c >= fnt->num_chars  ||  fnt->screen_width[c] == 0xFF  ) {
+			c = 0;
+		}
+		run.code[glyphs] = c;
+		run.advance[glyphs] = fnt->screen_width[c];
+		run.byte_length[glyphs] = (uint8)(pos - start);
+		width += fnt->screen_width[c];
+		glyphs++;
+	}
+	if(  pos != n  ) {
+		// len ends within a character, which is then decoded beyond len
+		run.bytes = 0;
+		return NULL;
+	}
+	run.hash = hash;
+	run.bytes = (uint8)n;
+	run.glyphs = (uint8)glyphs;
+	run.width = (uint16)width;
+	memcpy( run.text, txt, n );
+	return &run;
+}
+
+
 
 uint16 display_load_font(const char* fname)
 {
@@ -3963,6 +4109,7 @@ uint16 display_load_font(const char* fname)
 			large_font = fnt;
 			large_font_ascent = large_font.height + large_font.descent;
 			large_font_total_height = large_font.height;
+			text_run_generation++;
 			return large_font.num_chars;
 		}
 		else {
@@ -3983,6 +4130,7 @@ uint16 display_load_font(const char* fname)
 			large_font = fnt;
 			large_font_ascent = large_font.height + large_font.descent;
 			large_font_total_height = large_font.height;
+			text_run_generation++;
 			return large_font.num_chars;
 		}
 		else {
@@ -4155,6 +4303,10 @@ unsigned short get_prev_char_with_metrics(const char* &text, const char *const t
 */
 int display_calc_proportional_string_len_width(const char* text, size_t len)
 {
+	if(  const text_run_t *run = get_text_run( text, len )  ) {
+		return run->width;
+	}
+
 	const font_type* const fnt = &large_font;
 	unsigned int width = 0;
 	int w;
@@ -4247,6 +4399,9 @@ int display_text_proportional_len_clip_rgb(KOORD_VAL x, KOORD_VAL y, const char*
 		len = 0x7FFF;
 	}
 
+	// the laid out text, if short enough
+	const text_run_t *run = NULL;
+
 	// adapt x-coordinate for alignment
 	switch (flags & (ALIGN_LEFT | ALIGN_CENTER_H | ALIGN_RIGHT)) {
 	case ALIGN_LEFT:
@@ -4254,11 +4409,13 @@ int display_text_proportional_len_clip_rgb(KOORD_VAL x, KOORD_VAL y, const char*
 		break;
 
 	case ALIGN_CENTER_H:
-		x -= display_calc_proportional_string_len_width(txt, len) / 2;
+		run = get_text_run(txt, len);
+		x -= (run ? run->width : display_calc_proportional_string_len_width(txt, len)) / 2;
 		break;
 
 	case ALIGN_RIGHT:
-		x -= display_calc_proportional_string_len_width(txt, len);
+		run = get_text_run(txt, len);
+		x -= run ? run->width : display_calc_proportional_string_len_width(txt, len);
 		break;
 	}
 
@@ -4268,6 +4425,10 @@ int display_text_proportional_len_clip_rgb(KOORD_VAL x, KOORD_VAL y, const char*
 		return 0;
 	}
 
+	if (run == NULL) {
+		run = get_text_run(txt, len);
+	}
+
 	// x0 contains the starting x
 	x0 = x;
 	y_offset = 0;
@@ -4281,16 +4442,22 @@ int display_text_proportional_len_clip_rgb(KOORD_VAL x, KOORD_VAL y, const char*
 	}
 
 	// big loop, char by char
-	while (iTextPos < (size_t)len  &&  txt[iTextPos] != 0) {
+	uint32 glyph = 0;
+	while (run ? glyph < run->glyphs : iTextPos < (size_t)len  &&  txt[iTextPos] != 0) {
 		int h;
 		uint8 char_yoffset;
 
-		// decode char
-		c = utf8_to_utf16((utf8 const*)txt + iTextPos, &iTextPos);
+		if (run) {
+			c = run->code[glyph++];
+		}
+		else {
+			// decode char
+			c = utf8_to_utf16((utf8 const*)txt + iTextPos, &iTextPos);
 
-		// print unknown character?
-		if (c >= fnt->num_chars || fnt->screen_width[c] == 0xFF) {
-			c = 0;
+			// print unknown character?
+			if (c >= fnt->num_chars || fnt->screen_width[c] == 0xFF) {
+				c = 0;
+			}
 		}
 
 		// get the data from the font
@@ -4361,6 +4528,24 @@ int display_text_proportional_len_clip_rgb(KOORD_VAL x, KOORD_VAL y, const char*
 }
 
 
+// the metrics of the next character, taken from the run if there is one
+static inline bool next_char_metrics(const text_run_t *run, uint32 &glyph, const char* &text, uint8 &byte_length, uint8 &pixel_width)
+{
+	if(  run  ) {
+		if(  glyph >= run->glyphs  ) {
+			byte_length = 0;
+			pixel_width = 0;
+			return false;
+		}
+		byte_length = run->byte_length[glyph];
+		pixel_width = run->advance[glyph];
+		glyph++;
+		return true;
+	}
+	return get_next_char_with_metrics(text, byte_length, pixel_width) != 0;
+}
+
+
 /*
 * Displays a string which is abbreviated by the (language specific) ellipse character if too wide
 * If enough space is given then it just displays the full string
@@ -4381,8 +4566,10 @@ KOORD_VAL display_proportional_ellipse_rgb(scr_rect r, const char *text, int ali
 		align &= ~ALIGN_CENTER_V;
 	}
 
+	const text_run_t *run = get_text_run(text, 0x7FFF);
+	uint32 glyph = 0;
 	const char *tmp_text = text;
-	while (get_next_char_with_metrics(tmp_text, byte_length, pixel_width) && max_screen_width > (current_offset + eclipse_width + pixel_width)) {
+	while (next_char_metrics(run, glyph, tmp_text, byte_length, pixel_width) && max_screen_width > (current_offset + eclipse_width + pixel_width)) {
 		current_offset += pixel_width;
 		max_idx += byte_length;
 	}
@@ -4395,7 +4582,7 @@ KOORD_VAL display_proportional_ellipse_rgb(scr_rect r, const char *text, int ali
 		current_offset += pixel_width;
 		max_idx += byte_length;
 		// check the rest ...
-		while (get_next_char_with_metrics(tmp_text, byte_length, pixel_width) && max_screen_width > (current_offset + pixel_width)) {
+		while (next_char_metrics(run, glyph, tmp_text, byte_length, pixel_width) && max_screen_width > (current_offset + pixel_width)) {
 			current_offset += pixel_width;
 			max_idx += byte_length;
 		}
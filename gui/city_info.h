@@ -66,6 +66,8 @@ public:
 
 	const char *get_help_filename() const {return "citywindow.txt";}
 
+	uint32 get_refresh_interval() const OVERRIDE { return 1000; }
+
 	virtual koord3d get_weltpos(bool);
 
 	virtual bool is_weltpos();
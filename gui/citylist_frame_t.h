@@ -77,6 +77,8 @@ class citylist_frame_t : public gui_frame_t, private action_listener_t
      */
     const char * get_help_filename() const {return "citylist_filter.txt"; }
 
+	uint32 get_refresh_interval() const OVERRIDE { return 1000; }
+
     static citylist::sort_mode_t get_sortierung() { return sortby; }
     static void set_sortierung(const citylist::sort_mode_t& sm) { sortby = sm; }
 
@@ -30,7 +30,10 @@ static const char* total_bev_translation = NULL;
 char citylist_stats_t::total_bev_string[128];
 
 
-citylist_stats_t::citylist_stats_t(citylist::sort_mode_t sortby, bool sortreverse)
+citylist_stats_t::citylist_stats_t(citylist::sort_mode_t sortby_, bool sortreverse_) :
+	city_list( compare_cities(sortby_, sortreverse_) ),
+	sortby(sortby_),
+	sortreverse(sortreverse_)
 {
 	total_bev_translation = translator::translate("Total inhabitants:");
 	sort(sortby, sortreverse);
@@ -39,45 +42,36 @@ citylist_stats_t::citylist_stats_t(citylist::sort_mode_t sortby, bool sortrevers
 }
 
 
-class compare_cities
+bool compare_cities::operator ()(const stadt_t* a, const stadt_t* b) const
 {
-	public:
-		compare_cities(citylist::sort_mode_t sortby_, bool reverse_) :
-			sortby(sortby_),
-			reverse(reverse_)
-		{}
-
-		bool operator ()(const stadt_t* a, const stadt_t* b)
-		{
-			int cmp;
-			switch (sortby) {
-				default: NOT_REACHED
-				case citylist::by_name:   cmp = strcmp(a->get_name(), b->get_name());    break;
-				case citylist::by_size:   cmp = a->get_einwohner() - b->get_einwohner(); break;
-				case citylist::by_growth: cmp = a->get_wachstum()  - b->get_wachstum();  break;
-			}
-			return reverse ? cmp > 0 : cmp < 0;
-		}
-
-	private:
-		citylist::sort_mode_t sortby;
-		bool reverse;
-};
+	int cmp;
+	switch (sortby) {
+		default: NOT_REACHED
+		case citylist::by_name:   cmp = strcmp(a->get_name(), b->get_name());    break;
+		case citylist::by_size:   cmp = a->get_einwohner() - b->get_einwohner(); break;
+		case citylist::by_growth: cmp = a->get_wachstum()  - b->get_wachstum();  break;
+	}
+	return reverse ? cmp > 0 : cmp < 0;
+}
 
 
-void citylist_stats_t::sort(citylist::sort_mode_t sb, bool sr)
+static bool accept_city(const stadt_t*)
 {
-	const weighted_vector_tpl<stadt_t*>& cities = welt->get_cities();
-
-	sortby = sb;
-	sortreverse = sr;
+	return true;
+}
 
-	city_list.clear();
-	city_list.resize(cities.get_count());
 
-	FOR(weighted_vector_tpl<stadt_t*>, const i, cities) {
-		city_list.insert_ordered(i, compare_cities(sortby, sortreverse));
+void citylist_stats_t::sort(citylist::sort_mode_t sb, bool sr)
+{
+	if(  sb != sortby  ||  sr != sortreverse  ) {
+		sortby = sb;
+		sortreverse = sr;
+		city_list.set_compare( compare_cities(sortby, sortreverse) );
 	}
+
+	// only the cities which came, went or changed their place are touched
+	last_world_cities = welt->get_cities().get_count();
+	city_list.sync( welt->get_cities(), accept_city );
 }
 
 
@@ -117,7 +111,7 @@ bool citylist_stats_t::infowin_event(const event_t * ev)
 void citylist_stats_t::recalc_size()
 {
 	// show_scroll_x==false ->> size.w not important ->> no need to calc text pixel length
-	set_size( scr_size(210, welt->get_cities().get_count() * (LINESPACE+1) ) );
+	set_size( scr_size(210, city_list.get_count() * (LINESPACE+1) ) );
 }
 
 
@@ -128,8 +122,8 @@ void citylist_stats_t::draw(scr_coord offset)
 	sint32 total_bev = 0;
 	sint32 total_growth = 0;
 
-	if(  welt->get_cities().get_count()!=city_list.get_count()  ) {
-		// some deleted/ added => resort
+	if(  welt->get_cities().get_count()!=last_world_cities  ||  city_list.is_refresh_due()  ) {
+		// some deleted/ added or changed => resort
 		sort( sortby, sortreverse );
 		recalc_size();
 	}
@@ -137,7 +131,8 @@ void citylist_stats_t::draw(scr_coord offset)
 	sint32 sel = line_selected;
 	clip_dimension cl = display_get_clip_wh();
 
-	FORX(vector_tpl<stadt_t*>, const stadt, city_list, offset.y += LINESPACE + 1) {
+	for(  uint32 i = 0;  i < city_list.get_count();  i++, offset.y += LINESPACE + 1  ) {
+		stadt_t *const stadt = city_list[i];
 
 		sint32 population = stadt->get_finance_history_month(0, HIST_CITICENS);
 		sint32 growth = stadt->get_finance_history_month(0, HIST_GROWTH);
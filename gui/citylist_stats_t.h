@@ -14,6 +14,7 @@
 
 #include "components/gui_component.h"
 #include "../tpl/vector_tpl.h"
+#include "sorted_list_model.h"
 
 class karte_ptr_t;
 class stadt_t;
@@ -24,11 +25,29 @@ namespace citylist {
 };
 
 
+// Sort order of the city list
+class compare_cities
+{
+	public:
+		compare_cities(citylist::sort_mode_t sortby_, bool reverse_) :
+			sortby(sortby_),
+			reverse(reverse_)
+		{}
+
+		bool operator ()(const stadt_t* a, const stadt_t* b) const;
+
+	private:
+		citylist::sort_mode_t sortby;
+		bool reverse;
+};
+
+
 // City list stats display
 class citylist_stats_t : public gui_world_component_t
 {
 private:
-	vector_tpl<stadt_t*> city_list;
+	sorted_list_model_tpl<stadt_t*, compare_cities> city_list;
+	uint32 last_world_cities;
 	uint32 line_selected;
 
 	citylist::sort_mode_t sortby;
@@ -667,7 +667,10 @@ bool gui_convoy_assembler_t::action_triggered( gui_action_creator_t *comp,value_
 			{
 				cnv = replace_frame->get_convoy();
 			}
-			create_win(20, 20, new vehicle_class_manager_t(cnv), w_info, magic_class_manager+ cnv.get_id());
+			if (cnv.is_bound())
+			{
+				create_win(20, 20, new vehicle_class_manager_t(cnv), w_info, cnv->get_window_magic(magic_class_manager));
+			}
 			return true;
 		}
 		else if(comp == &vehicle_filter) 
@@ -310,7 +310,7 @@ bool convoi_detail_t::action_triggered(gui_action_creator_t *comp,value_t v/* */
 			return true;
 		}
 		else if (comp == &class_management_button) {
-			create_win(20, 40, new vehicle_class_manager_t(cnv), w_info, magic_class_manager + cnv.get_id());
+			create_win(20, 40, new vehicle_class_manager_t(cnv), w_info, cnv->get_window_magic(magic_class_manager));
 			return true;
 		}
 	}
@@ -375,7 +375,7 @@ void convoi_detail_t::rdwr(loadsave_t *file)
 		// now we can open the window ...
 		scr_coord const& pos = win_get_pos(this);
 		convoi_detail_t *w = new convoi_detail_t(cnv);
-		create_win(pos.x, pos.y, w, w_info, magic_convoi_detail + cnv.get_id());
+		create_win(pos.x, pos.y, w, w_info, cnv->get_window_magic(magic_convoi_detail));
 		w->set_windowsize( size );
 		w->scrolly.set_scroll_position( xoff, yoff );
 		// we must invalidate halthandle
@@ -14,7 +14,6 @@
  */
 
 #include <string.h>
-#include <algorithm>
 
 #include "components/gui_convoiinfo.h"
 
@@ -174,19 +173,18 @@ bool convoi_frame_t::compare_convois(convoihandle_t const cnv1, convoihandle_t c
 }
 
 
+bool convoi_frame_t::accept_t::operator ()(convoihandle_t cnv) const
+{
+	return cnv->get_owner()==frame->owner  &&  frame->passes_filter(cnv);
+}
+
+
 void convoi_frame_t::sort_list()
 {
 	last_world_convois = welt->convoys().get_count();
 
-	convois.clear();
-	convois.resize(last_world_convois);
-
-	FOR(vector_tpl<convoihandle_t>, const cnv, welt->convoys()) {
-		if(cnv->get_owner()==owner  &&   passes_filter(cnv)  ) {
-			convois.append(cnv);
-		}
-	}
-	std::sort(convois.begin(), convois.end(), compare_convois);
+	// only the convois which came, went or changed their place are touched
+	convois.sync( welt->convoys(), accept_t(this) );
 
 	sortedby.set_text(sort_text[get_sortierung()]);
 	sorteddir.set_text( get_reverse() ? "cl_btn_sort_desc" : "cl_btn_sort_asc");
@@ -210,6 +208,7 @@ void convoi_frame_t::sort_list( char *name, uint32 filter, const slist_tpl<const
 convoi_frame_t::convoi_frame_t(player_t* player) :
 	gui_frame_t( translator::translate("cl_title"), player),
 	owner(player),
+	convois(compare_convois),
 	vscroll( scrollbar_t::vertical ),
 	sort_label("cl_txt_sort"),
 	filter_label("Filter:")
@@ -294,10 +293,12 @@ bool convoi_frame_t::action_triggered( gui_action_creator_t *comp, value_t /* */
 	}
 	else if(  comp == &sortedby  ) {
 		set_sortierung( (sort_mode_t)((get_sortierung() + 1) % SORT_MODES) );
+		convois.set_compare( compare_convois );
 		sort_list();
 	}
 	else if(  comp == &sorteddir  ) {
 		set_reverse( !get_reverse() );
+		convois.set_compare( compare_convois );
 		sort_list();
 	}
 	else if(  comp == &filter_details  ) {
@@ -341,8 +342,8 @@ void convoi_frame_t::draw(scr_coord pos, scr_size size)
 	uint32 start = vscroll.get_knob_offset();
 	sint16 yoffset = 47;
 
-	if (last_world_convois != welt->convoys().get_count()) {
-		// some deleted/ added => resort
+	if (last_world_convois != welt->convoys().get_count()  ||  convois.is_refresh_due()) {
+		// some deleted/ added or changed => resort
 		sort_list();
 	}
 
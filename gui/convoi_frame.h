@@ -24,6 +24,7 @@
 #include "components/action_listener.h"  // 28-Dec-2001  Markus Weber    Added
 #include "components/gui_button.h"
 #include "../convoihandle_t.h"
+#include "sorted_list_model.h"
 
 class player_t;
 class goods_desc_t;
@@ -44,9 +45,18 @@ private:
 	* Handle the convoi to be displayed.
 	* @author Hj. Malthaner
 	*/
-	vector_tpl<convoihandle_t> convois;
+	sorted_list_model_tpl<convoihandle_t, bool (*)(convoihandle_t, convoihandle_t)> convois;
 	uint32 last_world_convois;
 
+	/// selects the convois shown
+	class accept_t
+	{
+		convoi_frame_t *frame;
+	public:
+		accept_t(convoi_frame_t *frame_) : frame(frame_) {}
+		bool operator ()(convoihandle_t cnv) const;
+	};
+
 	// since the scrollpane can be larger than 32767, we use explicitly a scroll bar
 	scrollbar_t vscroll;
 
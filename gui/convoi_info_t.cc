@@ -364,7 +364,7 @@ void convoi_info_t::draw(scr_coord pos, scr_size size)
 				line_bound = true;
 			}
 			button.enable();
-			details_button.pressed = win_get_magic(magic_convoi_detail + cnv.get_id());
+			details_button.pressed = win_get_magic(cnv->get_window_magic(magic_convoi_detail));
 			go_home_button.enable(); // Will be disabled, if convoy goes to a depot.
 			if (!cnv->get_schedule()->empty()) {
 				const grund_t* g = welt->lookup(cnv->get_schedule()->get_current_entry().pos);
@@ -384,7 +384,7 @@ void convoi_info_t::draw(scr_coord pos, scr_size size)
 			if (grund_t* gr = welt->lookup(cnv->get_schedule()->get_current_entry().pos)) {
 				go_home_button.pressed = gr->get_depot() != NULL;
 			}
-			details_button.pressed = win_get_magic(magic_convoi_detail + cnv.get_id());
+			details_button.pressed = win_get_magic(cnv->get_window_magic(magic_convoi_detail));
 
 			no_load_button.pressed = cnv->get_no_load();
 			no_load_button.enable();
@@ -962,7 +962,7 @@ bool convoi_info_t::action_triggered( gui_action_creator_t *comp,value_t /* */)
 
 	// details?
 	if(comp == &details_button) {
-		create_win(20, 20, new convoi_detail_t(cnv), w_info, magic_convoi_detail+cnv.get_id() );
+		create_win(20, 20, new convoi_detail_t(cnv), w_info, cnv->get_window_magic(magic_convoi_detail) );
 		return true;
 	}
 
@@ -1005,13 +1005,13 @@ bool convoi_info_t::action_triggered( gui_action_creator_t *comp,value_t /* */)
 
 		if(comp == &replace_button) 
 		{
-			create_win(20, 20, new replace_frame_t(cnv, get_name()), w_info, magic_replace + cnv.get_id() );
+			create_win(20, 20, new replace_frame_t(cnv, get_name()), w_info, cnv->get_window_magic(magic_replace) );
 			return true;
 		}
 
 		if(comp == &times_history_button) 
 		{
-			create_win(20, 20, new times_history_t(linehandle_t(), cnv), w_info, magic_convoi_time_history + cnv.get_id() );
+			create_win(20, 20, new times_history_t(linehandle_t(), cnv), w_info, cnv->get_window_magic(magic_convoi_time_history) );
 			return true;
 		}
 
@@ -1251,7 +1251,7 @@ void convoi_info_t::rdwr(loadsave_t *file)
 		// now we can open the window ...
 		scr_coord const& pos = win_get_pos(this);
 		convoi_info_t *w = new convoi_info_t(cnv);
-		create_win(pos.x, pos.y, w, w_info, magic_convoi_info + cnv.get_id());
+		create_win(pos.x, pos.y, w, w_info, cnv->get_window_magic(magic_convoi_info));
 		if(  stats  ) {
 			size.h -= 170;
 		}
@@ -29,7 +29,10 @@
 #include "../utils/simstring.h"
 
 
-factorylist_stats_t::factorylist_stats_t(factorylist::sort_mode_t sortby, bool sortreverse, bool own_network)
+factorylist_stats_t::factorylist_stats_t(factorylist::sort_mode_t sortby_, bool sortreverse_, bool own_network) :
+	fab_list( compare_factories(sortby_, sortreverse_) ),
+	sortby(sortby_),
+	sortreverse(sortreverse_)
 {
 	sort(sortby,sortreverse,own_network);
 	recalc_size();
@@ -37,79 +40,82 @@ factorylist_stats_t::factorylist_stats_t(factorylist::sort_mode_t sortby, bool s
 }
 
 
-class compare_factories
+bool compare_factories::operator ()(const fabrik_t* a, const fabrik_t* b) const
 {
-	public:
-		compare_factories(factorylist::sort_mode_t sortby_, bool reverse_) :
-			sortby(sortby_),
-			reverse(reverse_)
-		{}
+	int cmp;
+	switch (sortby) {
+		default:
+		case factorylist::by_name:
+			cmp = 0;
+			break;
+
+		case factorylist::by_input:
+		{
+			int a_in = a->get_input().empty() ? -1 : (int)a->get_total_in();
+			int b_in = b->get_input().empty() ? -1 : (int)b->get_total_in();
+			cmp = a_in - b_in;
+			break;
+		}
 
-		bool operator ()(const fabrik_t* a, const fabrik_t* b)
+		case factorylist::by_transit:
 		{
-			int cmp;
-			switch (sortby) {
-				default:
-				case factorylist::by_name:
-					cmp = 0;
-					break;
-
-				case factorylist::by_input:
-				{
-					int a_in = a->get_input().empty() ? -1 : (int)a->get_total_in();
-					int b_in = b->get_input().empty() ? -1 : (int)b->get_total_in();
-					cmp = a_in - b_in;
-					break;
-				}
-
-				case factorylist::by_transit:
-				{
-					int a_transit = a->get_input().empty() ? -1 : (int)a->get_total_transit();
-					int b_transit = b->get_input().empty() ? -1 : (int)b->get_total_transit();
-					cmp = a_transit - b_transit;
-					break;
-				}
-
-				case factorylist::by_available:
-				{
-					int a_in = a->get_input().empty() ? -1 : (int)(a->get_total_in()+a->get_total_transit());
-					int b_in = b->get_input().empty() ? -1 : (int)(b->get_total_in()+b->get_total_transit());
-					cmp = a_in - b_in;
-					break;
-				}
-
-				case factorylist::by_output:
-				{
-					int a_out = a->get_output().empty() ? -1 : (int)a->get_total_out();
-					int b_out = b->get_output().empty() ? -1 : (int)b->get_total_out();
-					cmp = a_out - b_out;
-					break;
-				}
-
-				case factorylist::by_maxprod:
-					cmp = a->get_base_production()*a->get_prodfactor() - b->get_base_production()*b->get_prodfactor();
-					break;
-
-				case factorylist::by_status:
-					cmp = a->get_status() - b->get_status();
-					break;
-
-				case factorylist::by_power:
-					cmp = a->get_prodfactor_electric() - b->get_prodfactor_electric();
-					break;
-				case factorylist::by_sector:
-					cmp = a->get_sector() - b->get_sector();
-					break;
-			}
-			if (cmp == 0) {
-				cmp = STRICMP(a->get_name(), b->get_name());
-			}
-			return reverse ? cmp > 0 : cmp < 0;
+			int a_transit = a->get_input().empty() ? -1 : (int)a->get_total_transit();
+			int b_transit = b->get_input().empty() ? -1 : (int)b->get_total_transit();
+			cmp = a_transit - b_transit;
+			break;
 		}
 
-	private:
-		const factorylist::sort_mode_t sortby;
-		const bool reverse;
+		case factorylist::by_available:
+		{
+			int a_in = a->get_input().empty() ? -1 : (int)(a->get_total_in()+a->get_total_transit());
+			int b_in = b->get_input().empty() ? -1 : (int)(b->get_total_in()+b->get_total_transit());
+			cmp = a_in - b_in;
+			break;
+		}
+
+		case factorylist::by_output:
+		{
+			int a_out = a->get_output().empty() ? -1 : (int)a->get_total_out();
+			int b_out = b->get_output().empty() ? -1 : (int)b->get_total_out();
+			cmp = a_out - b_out;
+			break;
+		}
+
+		case factorylist::by_maxprod:
+			cmp = a->get_base_production()*a->get_prodfactor() - b->get_base_production()*b->get_prodfactor();
+			break;
+
+		case factorylist::by_status:
+			cmp = a->get_status() - b->get_status();
+			break;
+
+		case factorylist::by_power:
+			cmp = a->get_prodfactor_electric() - b->get_prodfactor_electric();
+			break;
+		case factorylist::by_sector:
+			cmp = a->get_sector() - b->get_sector();
+			break;
+	}
+	if (cmp == 0) {
+		cmp = STRICMP(a->get_name(), b->get_name());
+	}
+	return reverse ? cmp > 0 : cmp < 0;
+}
+
+
+/**
+ * Selects the factories shown in the list
+ */
+class accept_factory_t
+{
+	const bool own_network;
+public:
+	accept_factory_t(bool own_network_) : own_network(own_network_) {}
+
+	bool operator ()(const fabrik_t* fab) const
+	{
+		return !own_network  ||  fab->is_connect_own_network();
+	}
 };
 
 /**
@@ -155,7 +161,7 @@ bool factorylist_stats_t::infowin_event(const event_t * ev)
 void factorylist_stats_t::recalc_size()
 {
 	// show_scroll_x==false ->> size.w not important ->> no need to calc text pixel length
-	set_size( scr_size(210, welt->get_fab_list().get_count() * (LINESPACE+1) ) );
+	set_size( scr_size(210, fab_list.get_count() * (LINESPACE+1) ) );
 }
 
 
@@ -166,25 +172,25 @@ void factorylist_stats_t::recalc_size()
 void factorylist_stats_t::draw(scr_coord offset)
 {
 	clip_dimension const cd = display_get_clip_wh();
-	const int start = cd.y-LINESPACE-1;
 	const int end = cd.yy+LINESPACE+1;
 
 	static cbuffer_t buf;
 	int xoff = offset.x+D_POS_BUTTON_WIDTH+D_H_SPACE;
-	int yoff = offset.y;
 
-	if(  fab_list.get_count()!=welt->get_fab_list().get_count()  ) {
-		// some deleted/ added => resort
+	if(  last_world_factories!=welt->get_fab_list().get_count()  ||  fab_list.is_refresh_due()  ) {
+		// some deleted/ added or changed => resort
 		sort( sortby, sortreverse, filter_own_network);
 	}
 
-	uint32 sel = line_selected;
-	FORX(vector_tpl<fabrik_t*>, const fab, fab_list, yoff += LINESPACE + 1) {
-		if (yoff >= end) break;
+	// skip invisible lines
+	const int first = max( 0, (cd.y-offset.y)/(LINESPACE+1)-1 );
+	int yoff = offset.y + first*(LINESPACE+1);
 
-		// skip invisible lines
-		if (yoff < start) continue;
+	uint32 sel = line_selected - first;
+	for(  uint32 i = first;  i < fab_list.get_count();  i++, yoff += LINESPACE + 1  ) {
+		if (yoff >= end) break;
 
+		fabrik_t *const fab = fab_list[i];
 		if(fab) {
 			unsigned indikatorfarbe = fabrik_t::status_to_color[fab->get_status()%fabrik_t::staff_shortage];
 
@@ -244,21 +250,15 @@ void factorylist_stats_t::draw(scr_coord offset)
 
 void factorylist_stats_t::sort(factorylist::sort_mode_t sb, bool sr, bool own_network)
 {
-	sortby = sb;
-	sortreverse = sr;
+	if(  sb != sortby  ||  sr != sortreverse  ) {
+		sortby = sb;
+		sortreverse = sr;
+		fab_list.set_compare( compare_factories(sortby, sortreverse) );
+	}
 	filter_own_network = own_network;
 
-	fab_list.clear();
-	int lines = 0;
-	for(sint16 i = welt->get_fab_list().get_count() - 1; i >= 0; i --)
-	{
-		// own network filter
-		if(filter_own_network && !welt->get_fab_list()[i]->is_connect_own_network()){
-			continue;
-		}
-		fab_list.insert_ordered( welt->get_fab_list()[i], compare_factories(sortby, sortreverse) );
-		lines++;
-	}
-	fab_list.resize(welt->get_fab_list().get_count());
-	set_size(scr_size(210, lines*(LINESPACE+1)));
+	// only the factories which came, went or changed their place are touched
+	last_world_factories = welt->get_fab_list().get_count();
+	fab_list.sync( welt->get_fab_list(), accept_factory_t(filter_own_network) );
+	set_size(scr_size(210, fab_list.get_count()*(LINESPACE+1)));
 }
@@ -14,6 +14,7 @@
 
 #include "../tpl/vector_tpl.h"
 #include "components/gui_component.h"
+#include "sorted_list_model.h"
 
 class fabrik_t;
 
@@ -22,6 +23,25 @@ namespace factorylist {
     enum sort_mode_t { by_name=0, by_available, by_output, by_maxprod, by_status, by_power, by_sector, SORT_MODES, by_input, by_transit,  };	// the last two not used
 };
 
+/**
+ * Sort order of the factory list
+ */
+class compare_factories
+{
+	public:
+		compare_factories(factorylist::sort_mode_t sortby_, bool reverse_) :
+			sortby(sortby_),
+			reverse(reverse_)
+		{}
+
+		bool operator ()(const fabrik_t* a, const fabrik_t* b) const;
+
+	private:
+		factorylist::sort_mode_t sortby;
+		bool reverse;
+};
+
+
 /**
  * Factory list stats display
  * @author Hj. Malthaner
@@ -29,7 +49,8 @@ namespace factorylist {
 class factorylist_stats_t : public gui_world_component_t
 {
 private:
-	vector_tpl<fabrik_t*> fab_list;
+	sorted_list_model_tpl<fabrik_t*, compare_factories> fab_list;
+	uint32 last_world_factories;
 	uint32 line_selected;
 
 	factorylist::sort_mode_t sortby;
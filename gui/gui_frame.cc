@@ -202,7 +202,12 @@ void gui_frame_t::draw(scr_coord pos, scr_size size)
 	container.draw(pos);
 	POP_CLIP();
 
-	// for shadows of the windows
+	draw_shadows(pos, size);
+}
+
+
+void gui_frame_t::draw_shadows(scr_coord pos, scr_size size)
+{
 	if(  gui_theme_t::gui_drop_shadows  ) {
 		display_blend_wh( pos.x+size.w, pos.y+1, 2, size.h, COL_BLACK, 50 );
 		display_blend_wh( pos.x+1, pos.y+size.h, size.w, 2, COL_BLACK, 50 );
@@ -258,6 +258,18 @@ public:
 
 	bool is_dirty() const { return dirty; }
 
+	/// false for windows blended with what is behind them
+	bool is_opaque() const { return opaque; }
+
+	/**
+	 * While the window is neither on top nor under the mouse, it is drawn
+	 * only every this many ms and its last image is shown in between.
+	 * Windows whose charts are expensive to draw, and which show no live
+	 * views or labels, may ask for this.
+	 * @return 0 to draw the window every frame
+	 */
+	virtual uint32 get_refresh_interval() const { return 0; }
+
 	/**
 	 * Set resize mode
 	 * @author Markus Weber
@@ -295,6 +307,9 @@ public:
 	 */
 	virtual void draw(scr_coord pos, scr_size size);
 
+	/// draws the shadow of the window (if the theme wants one)
+	void draw_shadows(scr_coord pos, scr_size size);
+
 	// called, when the map is rotated
 	virtual void map_rotate90( sint16 /*new_ysize*/ ) { }
 
@@ -14,7 +14,6 @@
  * @date 02-Jan-02
  */
 
-#include <algorithm>
 #include <string.h>
 
 #include "halt_list_frame.h"
@@ -268,8 +267,25 @@ static bool passes_filter(haltestelle_t & s)
 }
 
 
+/**
+ * Selects the stops shown in the list
+ */
+class halt_list_accept_t
+{
+	const player_t *player;
+public:
+	halt_list_accept_t(const player_t *player_) : player(player_) {}
+
+	bool operator ()(halthandle_t halt) const
+	{
+		return halt->get_owner() == player  &&  passes_filter(*halt);
+	}
+};
+
+
 halt_list_frame_t::halt_list_frame_t(player_t *player) :
 	gui_frame_t( translator::translate("hl_title"), player),
+	stops(compare_halts),
 	vscroll( scrollbar_t::vertical ),
 	sort_label(translator::translate("hl_txt_sort")),
 	filter_label(translator::translate("hl_txt_filter"))
@@ -300,8 +316,8 @@ halt_list_frame_t::halt_list_frame_t(player_t *player) :
 
 	display_list();
 
-	set_windowsize(scr_size(D_DEFAULT_WIDTH, D_TITLEBAR_HEIGHT+7*(28)+31+1));
-	set_min_windowsize(scr_size(D_DEFAULT_WIDTH, D_TITLEBAR_HEIGHT + 3 * (28) + HALT_SCROLL_START));
+	set_windowsize(scr_size(D_DEFAULT_WIDTH, D_TITLEBAR_HEIGHT+7*HALT_LIST_ROW_HEIGHT+31+1));
+	set_min_windowsize(scr_size(D_DEFAULT_WIDTH, D_TITLEBAR_HEIGHT + 3 * HALT_LIST_ROW_HEIGHT + HALT_SCROLL_START));
 
 	set_resizemode(diagonal_resize);
 	resize (scr_coord(0,0));
@@ -324,41 +340,12 @@ void halt_list_frame_t::display_list()
 {
 	last_world_stops = haltestelle_t::get_alle_haltestellen().get_count();				// count of stations
 
-	ALLOCA(halthandle_t, a, last_world_stops);
-	int n = 0; // temporary variable
-	int i;
-
-	/**************************
-	 * Sort the station list
-	 *************************/
-
-	// create a unsorted station list
-	num_filtered_stops = 0;
-	FOR(vector_tpl<halthandle_t>, const halt, haltestelle_t::get_alle_haltestellen()) {
-		if(  halt->get_owner() == m_player  ) {
-			a[n++] = halt;
-			if (passes_filter(*halt)) {
-				num_filtered_stops++;
-			}
-		}
-	}
-	std::sort(a, a + n, compare_halts);
+	// only the stops which came, went or changed their place are touched
+	stops.sync( haltestelle_t::get_alle_haltestellen(), halt_list_accept_t(m_player) );
 
 	sortedby.set_text(sort_text[get_sortierung()]);
 	sorteddir.set_text(get_reverse() ? "hl_btn_sort_desc" : "hl_btn_sort_asc");
 
-	/****************************
-	 * Display the station list
-	 ***************************/
-
-	stops.clear();   // clear the list
-	stops.resize(n);
-
-	// display stations
-	for (i = 0; i < n; i++) {
-		stops.append(halt_list_stats_t(a[i]));
-		stops.back().set_pos(scr_coord(0,0));
-	}
 	// hide/show scroll bar
 	resize(scr_coord(0,0));
 }
@@ -379,18 +366,12 @@ bool halt_list_frame_t::infowin_event(const event_t *ev)
 		return vscroll.infowin_event(ev);
 	}
 	else if ((IS_LEFTRELEASE(ev) || IS_RIGHTRELEASE(ev)) && ev->my>HALT_SCROLL_START + D_TITLEBAR_HEIGHT  &&  ev->mx<get_windowsize().w - xr && !stops.empty()) {
-		const int y = (ev->my - HALT_SCROLL_START - D_TITLEBAR_HEIGHT) / stops[0].get_size().h + vscroll.get_knob_offset();
-
-		if(  y<num_filtered_stops  ) {
-			// find the 'y'th filtered stop in the unfiltered stops list
-			uint32 i=0;
-			for(  int j=0;  i<stops.get_count()  &&  j<=y;  i++  ){
-				if (passes_filter(*stops[i].get_halt())) {
-					j++;
-				}
-			}
-			// let gui_convoiinfo_t() handle this, since then it will be automatically consistent
-			return stops[i-1].infowin_event( ev );
+		const uint32 y = (ev->my - HALT_SCROLL_START - D_TITLEBAR_HEIGHT) / HALT_LIST_ROW_HEIGHT + vscroll.get_knob_offset();
+
+		if(  y<stops.get_count()  ) {
+			// let halt_list_stats_t() handle this, since then it will be automatically consistent
+			halt_list_stats_t stats(stops[y]);
+			return stats.infowin_event( ev );
 		}
 	}
 	return gui_frame_t::infowin_event(ev);
@@ -410,10 +391,12 @@ bool halt_list_frame_t::action_triggered( gui_action_creator_t *comp,value_t /*
 	}
 	else if (comp == &sortedby) {
 		set_sortierung((sort_mode_t)((get_sortierung() + 1) % SORT_MODES));
+		stops.set_compare(compare_halts);
 		display_list();
 	}
 	else if (comp == &sorteddir) {
 		set_reverse(!get_reverse());
+		stops.set_compare(compare_halts);
 		display_list();
 	}
 	else if (comp == &filter_details) {
@@ -439,9 +422,9 @@ void halt_list_frame_t::resize(const scr_coord size_change)
 	scr_size size = get_windowsize() - scr_size(0, D_TITLEBAR_HEIGHT + HALT_SCROLL_START);
 	vscroll.set_visible(false);
 	remove_component(&vscroll);
-	int halt_h = (stops.empty() ? 28 : stops[0].get_size().h);
-	vscroll.set_knob(size.h / halt_h, num_filtered_stops);
-	if (num_filtered_stops <= size.h / halt_h) {
+	const int halt_h = HALT_LIST_ROW_HEIGHT;
+	vscroll.set_knob(size.h / halt_h, stops.get_count());
+	if ((int)stops.get_count() <= size.h / halt_h) {
 		vscroll.set_knob_offset(0);
 	}
 	else {
@@ -463,28 +446,21 @@ void halt_list_frame_t::draw(scr_coord pos, scr_size size)
 	const sint16 xr = vscroll.is_visible() ? D_SCROLLBAR_WIDTH+4 : 6;
 	PUSH_CLIP(pos.x, pos.y+47, size.w-xr, size.h-48 );
 
-	const sint32 start = vscroll.get_knob_offset();
 	sint16 yoffset = 47;
-	const int last_num_filtered_stops = num_filtered_stops;
-	num_filtered_stops = 0;
 
-	if(  last_world_stops != haltestelle_t::get_alle_haltestellen().get_count()  ) {
-		// some deleted/ added => resort
+	if(  last_world_stops != haltestelle_t::get_alle_haltestellen().get_count()  ||  stops.is_refresh_due()  ) {
+		// some deleted/ added or changed => resort
 		display_list();
 	}
 
-	FOR(vector_tpl<halt_list_stats_t>, & i, stops) {
-		halthandle_t const halt = i.get_halt();
-		if (halt.is_bound() && passes_filter(*halt)) {
-			num_filtered_stops++;
-			if(  num_filtered_stops>start  &&  yoffset<size.h+47  ) {
-				i.draw(pos + scr_coord(0, yoffset));
-				yoffset += i.get_size().h;
-			}
+	// only the visible rows are drawn
+	for(  uint32 i = vscroll.get_knob_offset();  i < stops.get_count()  &&  yoffset < size.h+47;  i++  ) {
+		halthandle_t const halt = stops[i];
+		if(  halt.is_bound()  ) {
+			halt_list_stats_t stats(halt);
+			stats.draw(pos + scr_coord(0, yoffset));
 		}
-	}
-	if(  num_filtered_stops!=last_num_filtered_stops  ) {
-		resize (scr_coord(0,0));
+		yoffset += HALT_LIST_ROW_HEIGHT;
 	}
 
 	POP_CLIP();
@@ -24,6 +24,7 @@
 #include "components/gui_label.h"
 #include "components/action_listener.h"
 #include "../tpl/vector_tpl.h"
+#include "sorted_list_model.h"
 
 class player_t;
 class goods_desc_t;
@@ -53,9 +54,9 @@ private:
 
     static const char *sort_text[SORT_MODES];
 
-	vector_tpl<halt_list_stats_t> stops;
+	// the stops passing the filter
+	sorted_list_model_tpl<halthandle_t, bool (*)(halthandle_t, halthandle_t)> stops;
 	uint32 last_world_stops;
-	int num_filtered_stops;
 
 	/*
      * All gui elements of this dialog:
@@ -12,6 +12,8 @@
 #include "components/gui_component.h"
 #include "../halthandle_t.h"
 
+// height of a halt_list_stats_t
+#define HALT_LIST_ROW_HEIGHT (28)
 
 /**
  * @author Hj. Malthaner
@@ -23,7 +25,7 @@ private:
 
 public:
 	halt_list_stats_t() : halt() {}
-	halt_list_stats_t(halthandle_t halt_) : halt(halt_) { size.h = 28; }
+	halt_list_stats_t(halthandle_t halt_) : halt(halt_) { size.h = HALT_LIST_ROW_HEIGHT; }
 	const halthandle_t get_halt() const { return halt; }
 
 	bool infowin_event(event_t const*) OVERRIDE;
@@ -32,6 +32,11 @@
 #include "../tpl/inthashtable_tpl.h"
 #include "../tpl/slist_tpl.h"
 
+#ifdef MULTI_THREAD
+#include "../utils/simthread.h"
+#include "../dataobj/environment.h"
+#endif
+
 #include <math.h>
 
 sint32 reliefkarte_t::max_cargo=0;
@@ -726,27 +731,72 @@ uint8 reliefkarte_t::calc_relief_farbe(const grund_t *gr)
 }
 
 
-void reliefkarte_t::calc_map_pixel(const koord k)
+sint32 *reliefkarte_t::get_mode_maximum()
 {
-	// we ignore requests, when nothing visible ...
-	if(!is_visible) {
-		return;
+	switch(mode&~MAP_MODE_FLAGS) {
+		case MAP_FREIGHT: return &max_cargo;
+		case MAP_TRAFFIC: return &max_passed;
+		case MAP_LEVEL:   return &max_building_level;
+		default:          return NULL;
 	}
+}
 
+
+/**
+ * The value shown by the modes which have a maximum (see get_mode_maximum())
+ * @return -1 if there is nothing to show on this ground
+ */
+sint32 reliefkarte_t::calc_tile_amount(const grund_t *gr)
+{
+	switch(mode&~MAP_MODE_FLAGS) {
+		// usage
+		case MAP_FREIGHT:
+		// traffic (=convois/month)
+		case MAP_TRAFFIC:
+			if(  gr->hat_wege()  ) {
+				const way_statistics stat = (mode&~MAP_MODE_FLAGS)==MAP_FREIGHT ? WAY_STAT_GOODS : WAY_STAT_CONVOIS;
+				// maximum two ways for one ground
+				if(  const weg_t *w=gr->get_weg_nr(0)  ) {
+					sint32 amount = w->get_statistics(stat);
+					if(  const weg_t *w=gr->get_weg_nr(1)  ) {
+						amount += w->get_statistics(stat);
+					}
+					return amount;
+				}
+			}
+			break;
+
+		case MAP_LEVEL:
+			if(  gr->get_typ() == grund_t::fundament  ) {
+				if(  gebaeude_t *gb = gr->find<gebaeude_t>()  ) {
+					if(  gb->is_city_building()  ) {
+						return gb->get_tile()->get_desc()->get_level();
+					}
+				}
+			}
+			break;
+
+		default:
+			break;
+	}
+	return -1;
+}
+
+
+/**
+ * Must not change anything, since it is called by several threads at once.
+ */
+uint8 reliefkarte_t::calc_tile_color(const koord k) const
+{
 	// always use to uppermost ground
 	const planquadrat_t *plan=welt->access(k);
 	if(plan==NULL  ||  plan->get_boden_count()==0) {
-		return;
+		return COL_BLACK;
 	}
 	const grund_t *gr=plan->get_boden_bei(plan->get_boden_count()-1);
 
-	if(  mode!=MAP_PAX_DEST  &&  gr->get_convoi_vehicle()  ) {
-		set_relief_farbe( k, VEHIKEL_KENN );
-		return;
-	}
-
 	// first use ground color
-	set_relief_farbe( k, calc_relief_farbe(gr) );
+	uint8 color = calc_relief_farbe(gr);
 
 	switch(mode&~MAP_MODE_FLAGS) {
 		// show passenger coverage
@@ -755,7 +805,7 @@ void reliefkarte_t::calc_map_pixel(const koord k)
 			if(  plan->get_haltlist_count()>0  ) {
 				halthandle_t halt = plan->get_haltlist()[0].halt;
 				if(  halt->get_pax_enabled()  &&  !halt->get_connexions(goods_manager_t::INDEX_PAS, goods_manager_t::passengers->get_number_of_classes() - 1)->empty() ){
-					set_relief_farbe( k, halt->get_owner()->get_player_color1() + 3 );
+					color = halt->get_owner()->get_player_color1() + 3;
 				}
 			}
 			break;
@@ -766,60 +816,19 @@ void reliefkarte_t::calc_map_pixel(const koord k)
 			if(  plan->get_haltlist_count()>0  ) {
 				halthandle_t halt = plan->get_haltlist()[0].halt;
 				if(  halt->get_mail_enabled()  &&  !halt->get_connexions(goods_manager_t::INDEX_MAIL, goods_manager_t::mail->get_number_of_classes() - 1)->empty()  ) {
-					set_relief_farbe( k, halt->get_owner()->get_player_color1() + 3 );
+					color = halt->get_owner()->get_player_color1() + 3;
 				}
 			}
 			break;
 
 		// show usage
 		case MAP_FREIGHT:
-			// need to init the maximum?
-			if(max_cargo==0) {
-				max_cargo = 1;
-				calc_map();
-			}
-			else if(  gr->hat_wege()  ) {
-				// now calc again ...
-				sint32 cargo=0;
-
-				// maximum two ways for one ground
-				const weg_t *w=gr->get_weg_nr(0);
-				if(w) {
-					cargo = w->get_statistics(WAY_STAT_GOODS);
-					const weg_t *w=gr->get_weg_nr(1);
-					if(w) {
-						cargo += w->get_statistics(WAY_STAT_GOODS);
-					}
-					if(  cargo > max_cargo  ) {
-						max_cargo = cargo;
-					}
-					set_relief_farbe(k, calc_severity_color_log(cargo, max_cargo));
-				}
-			}
-			break;
-
 		// show traffic (=convois/month)
 		case MAP_TRAFFIC:
-			// need to init the maximum?
-			if(  max_passed==0  ) {
-				max_passed = 1;
-				calc_map();
-			}
-			else if(gr->hat_wege()) {
-				// now calc again ...
-				sint32 passed=0;
-
-				// maximum two ways for one ground
-				const weg_t *w=gr->get_weg_nr(0);
-				if(w) {
-					passed = w->get_statistics(WAY_STAT_CONVOIS);
-					if(  weg_t *w=gr->get_weg_nr(1)  ) {
-						passed += w->get_statistics(WAY_STAT_CONVOIS);
-					}
-					if(  passed > max_passed  ) {
-						max_passed = passed;
-					}
-					set_relief_farbe(k, calc_severity_color_log( passed, max_passed ) );
+			{
+				const sint32 amount = calc_tile_amount(gr);
+				if(  amount >= 0  ) {
+					color = calc_severity_color_log( amount, *get_mode_maximum() );
 				}
 			}
 			break;
@@ -838,7 +847,7 @@ void reliefkarte_t::calc_map_pixel(const koord k)
 					condition_percent = min(condition_percent, second_way->get_condition_percent());
 				}
 				const sint32 condition_percent_reciprocal = 100 - condition_percent;
-				set_relief_farbe(k, calc_severity_color(condition_percent_reciprocal, 100));
+				color = calc_severity_color(condition_percent_reciprocal, 100);
 			}
 			
 			break;
@@ -849,14 +858,14 @@ void reliefkarte_t::calc_map_pixel(const koord k)
 			if (gr->hat_weg(track_wt)) {
 				const schiene_t * sch = (const schiene_t *) (gr->get_weg(track_wt));
 				if(sch->is_electrified()) {
-					set_relief_farbe(k, COL_RED);
+					color = COL_RED;
 				}
 				else {
-					set_relief_farbe(k, COL_WHITE);
+					color = COL_WHITE;
 				}
 				// show signals
 				if(sch->has_sign()  ||  sch->has_signal()) {
-					set_relief_farbe(k, COL_YELLOW);
+					color = COL_YELLOW;
 				}
 			}
 			break;
@@ -866,7 +875,7 @@ void reliefkarte_t::calc_map_pixel(const koord k)
 			{
 				sint32 speed=gr->get_max_speed();
 				if(speed) {
-					set_relief_farbe(k, calc_severity_color(gr->get_max_speed(), 450));
+					color = calc_severity_color(gr->get_max_speed(), 450);
 				}
 			}
 			break;
@@ -883,11 +892,11 @@ void reliefkarte_t::calc_map_pixel(const koord k)
 					}
 					if(gr->ist_bruecke())
 					{
-						set_relief_farbe(k, calc_severity_color(way->get_max_axle_load(), 350));
+						color = calc_severity_color(way->get_max_axle_load(), 350);
 					}
 					else
 					{
-						set_relief_farbe(k, calc_severity_color(way->get_max_axle_load(), 30));
+						color = calc_severity_color(way->get_max_axle_load(), 30);
 					}
 				}
 			}
@@ -898,14 +907,14 @@ void reliefkarte_t::calc_map_pixel(const koord k)
 			{
 				const leitung_t* lt = gr->find<leitung_t>();
 				if(lt!=NULL) {
-					set_relief_farbe(k, calc_severity_color((sint32)lt->get_net()->get_demand(),(sint32)lt->get_net()->get_supply()) );
+					color = calc_severity_color((sint32)lt->get_net()->get_demand(),(sint32)lt->get_net()->get_supply());
 				}
 			}
 			break;
 
 		case MAP_FOREST:
 			if(  gr->get_top()>1  &&  gr->obj_bei(gr->get_top()-1)->get_typ()==obj_t::baum  ) {
-				set_relief_farbe(k, COL_GREEN );
+				color = COL_GREEN;
 			}
 			break;
 
@@ -913,34 +922,24 @@ void reliefkarte_t::calc_map_pixel(const koord k)
 			// show ownership
 			{
 				if(  gr->is_halt()  ) {
-					set_relief_farbe(k, gr->get_halt()->get_owner()->get_player_color1()+3);
+					color = gr->get_halt()->get_owner()->get_player_color1()+3;
 				}
 				else if(  weg_t *weg = gr->get_weg_nr(0)  ) {
-					set_relief_farbe(k, weg->get_owner()==NULL ? COL_ORANGE : weg->get_owner()->get_player_color1()+3 );
+					color = weg->get_owner()==NULL ? COL_ORANGE : weg->get_owner()->get_player_color1()+3;
 				}
 				if(  gebaeude_t *gb = gr->get_building()  ) {
 					if(  gb->get_owner()!=NULL  ) {
-						set_relief_farbe(k, gb->get_owner()->get_player_color1()+3 );
+						color = gb->get_owner()->get_player_color1()+3;
 					}
 				}
 				break;
 			}
 
 		case MAP_LEVEL:
-			if(  max_building_level == 0  ) {
-				// init maximum
-				max_building_level = 1;
-				calc_map();
-			}
-			else if(  gr->get_typ() == grund_t::fundament  ) {
-				if(  gebaeude_t *gb = gr->find<gebaeude_t>()  ) {
-					if(  gb->is_city_building()  ) {
-						sint32 level = gb->get_tile()->get_desc()->get_level();
-						if(  level > max_building_level  ) {
-							max_building_level = level;
-						}
-						set_relief_farbe(k, calc_severity_color(level, max_building_level));
-					}
+			{
+				const sint32 level = calc_tile_amount(gr);
+				if(  level >= 0  ) {
+					color = calc_severity_color( level, max_building_level );
 				}
 			}
 			break;
@@ -952,10 +951,10 @@ void reliefkarte_t::calc_map_pixel(const koord k)
 					if (gb->get_adjusted_population()) {
 						const uint16 passengers_succeeded_commuting = gb->get_average_passenger_success_percent_commuting();
 						if(passengers_succeeded_commuting < 65535){
-							set_relief_farbe(k, calc_severity_color(100 - passengers_succeeded_commuting, 100));
+							color = calc_severity_color(100 - passengers_succeeded_commuting, 100);
 						}
 						else {
-							set_relief_farbe(k, MAP_COL_NODATA);
+							color = MAP_COL_NODATA;
 						}
 					}
 				}
@@ -969,10 +968,10 @@ void reliefkarte_t::calc_map_pixel(const koord k)
 					if (gb->get_adjusted_population()) {
 						const uint16 passengers_succeeded_visiting = gb->get_average_passenger_success_percent_visiting();
 						if (passengers_succeeded_visiting < 65535) {
-							set_relief_farbe(k, calc_severity_color(100 - passengers_succeeded_visiting, 100));
+							color = calc_severity_color(100 - passengers_succeeded_visiting, 100);
 						}
 						else {
-							set_relief_farbe(k, MAP_COL_NODATA);
+							color = MAP_COL_NODATA;
 						}
 					}
 				}
@@ -989,21 +988,21 @@ void reliefkarte_t::calc_map_pixel(const koord k)
 							const uint32 input_count = fab->get_input().get_count();
 							// Factories not in operation
 							if (gb->get_passengers_succeeded_commuting() == 65535 && input_count) {
-								set_relief_farbe(k, COL_DARK_PURPLE);
+								color = COL_DARK_PURPLE;
 							}
 							else {
 								const sint32 staffing_percentage = gb->get_staffing_level_percentage();
 								if (staffing_percentage < 65535) {
-									set_relief_farbe(k, calc_severity_color(100 - staffing_percentage, 100));
+									color = calc_severity_color(100 - staffing_percentage, 100);
 								}
 								else {
-									set_relief_farbe(k, MAP_COL_NODATA);
+									color = MAP_COL_NODATA;
 								}
 							}
 						}
 						else {
 							const sint32 staffing_percentage = gb->get_staffing_level_percentage();
-							set_relief_farbe(k, calc_severity_color(100 - staffing_percentage, 100));
+							color = calc_severity_color(100 - staffing_percentage, 100);
 						}
 					}
 				
@@ -1018,10 +1017,10 @@ void reliefkarte_t::calc_map_pixel(const koord k)
 					if (gb->get_adjusted_mail_demand()) {
 						const uint16 recent_mail_delivery_success_per = gb->get_average_mail_delivery_success_percent();
 						if (recent_mail_delivery_success_per < 65535) {
-							set_relief_farbe(k, calc_severity_color(100 - recent_mail_delivery_success_per, 100));
+							color = calc_severity_color(100 - recent_mail_delivery_success_per, 100);
 						}
 						else {
-							set_relief_farbe(k, MAP_COL_NODATA);
+							color = MAP_COL_NODATA;
 						}
 					}
 				}
@@ -1031,6 +1030,77 @@ void reliefkarte_t::calc_map_pixel(const koord k)
 		default:
 			break;
 	}
+	return color;
+}
+
+
+void reliefkarte_t::calc_map_pixel(const koord k)
+{
+	add_changed_tile(k);
+
+	// we ignore requests, when nothing visible ...
+	if(  !is_visible  ||  current_layer==NULL  ||  !current_layer->valid  ||  !welt->is_within_limits(k)  ) {
+		return;
+	}
+
+	if(  sint32 *maximum = get_mode_maximum()  ) {
+		const planquadrat_t *plan = welt->access(k);
+		if(  plan->get_boden_count() > 0  ) {
+			const sint32 amount = calc_tile_amount( plan->get_boden_bei(plan->get_boden_count()-1) );
+			if(  amount > *maximum  ) {
+				*maximum = amount;
+			}
+		}
+	}
+	set_layer_color( k, calc_tile_color(k) );
+}
+
+
+uint8 reliefkarte_t::get_shown_color(const koord k) const
+{
+	if(  mode!=MAP_PAX_DEST  ) {
+		const planquadrat_t *plan = welt->access(k);
+		if(  plan  &&  plan->get_boden_count() > 0  &&  plan->get_boden_bei(plan->get_boden_count()-1)->get_convoi_vehicle()  ) {
+			return VEHIKEL_KENN;
+		}
+	}
+	return current_layer->get(k);
+}
+
+
+void reliefkarte_t::calc_vehicle_pixel(const koord k)
+{
+	// the layers do not change, only the bitmap on screen
+	if(  is_visible  &&  current_layer!=NULL  &&  current_layer->valid  &&  welt->is_within_limits(k)  ) {
+		set_relief_farbe( k, get_shown_color(k) );
+	}
+}
+
+
+void reliefkarte_t::draw_vehicles()
+{
+	if(  mode==MAP_PAX_DEST  ) {
+		return;
+	}
+	FOR(vector_tpl<convoihandle_t>, const cnv, welt->convoys()) {
+		for(  uint8 i=0;  i<cnv->get_vehicle_count();  i++  ) {
+			const koord k = cnv->get_vehicle(i)->get_pos().get_2d();
+			if(  welt->is_within_limits(k)  &&  get_shown_color(k)==VEHIKEL_KENN  ) {
+				set_relief_farbe( k, VEHIKEL_KENN );
+			}
+		}
+	}
+}
+
+
+void reliefkarte_t::release_layers()
+{
+	is_visible = false;
+	for(  uint8 i=0;  i<MAX_LAYERS;  i++  ) {
+		layers[i].release();
+	}
+	current_layer = NULL;
+	needs_redraw = true;
 }
 
 
@@ -1047,43 +1117,238 @@ void reliefkarte_t::calc_map_size()
 }
 
 
-void reliefkarte_t::calc_map()
+void reliefkarte_t::map_layer_t::release()
 {
-	// only use bitmap size like screen size
-	scr_size relief_size( min( get_size().w, new_size.w ), min( get_size().h, new_size.h ) );
-	// actually the following line should reduce new/deletes, but does not work properly
-	if(  relief==NULL  ||  (sint16)relief->get_width()!=relief_size.w  ||  (sint16)relief->get_height()!=relief_size.h  ) {
-		delete relief;
-		relief = new array2d_tpl<unsigned char> (relief_size.w,relief_size.h);
+	delete colors;
+	colors = NULL;
+	changed_tiles.clear();
+	valid = false;
+}
+
+
+void reliefkarte_t::map_layer_t::resize(koord size)
+{
+	if(  colors  &&  (sint16)colors->get_width()==size.x  &&  (sint16)colors->get_height()==size.y  ) {
+		return;
 	}
-	cur_off = new_off;
-	cur_size = new_size;
-	needs_redraw = false;
-	is_visible = true;
+	release();
+	colors = new array2d_tpl<uint8>( size.x, size.y );
+}
 
-	// redraw the map
-	if(  !isometric  ) {
-		koord k;
-		koord start_off = koord( (cur_off.x*zoom_out)/zoom_in, (cur_off.y*zoom_out)/zoom_in );
-		koord end_off = start_off+koord( (relief->get_width()*zoom_out)/zoom_in+1, (relief->get_height()*zoom_out)/zoom_in+1 );
-		for(  k.y=start_off.y;  k.y<end_off.y;  k.y+=zoom_out  ) {
-			for(  k.x=start_off.x;  k.x<end_off.x;  k.x+=zoom_out  ) {
-				calc_map_pixel(k);
+
+uint32 reliefkarte_t::get_layer_key(MAP_MODES m)
+{
+	// these modes add something to the layer in calc_layer()
+	if(  m==MAP_TOURIST  ||  m==MAP_FACTORIES  ||  m==MAP_DEPOT  ) {
+		return m;
+	}
+	// the other flags are only drawn on top of the map
+	return (m & ~MAP_MODE_FLAGS) | (m & MAP_PAX_DEST);
+}
+
+
+#ifdef MULTI_THREAD
+// guards the changed tiles of the layers, since vehicles may move in several threads
+static pthread_mutex_t changed_tiles_mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+void reliefkarte_t::add_changed_tile(koord k)
+{
+	bool any_hidden = false;
+	for(  uint8 i=0;  i<MAX_LAYERS;  i++  ) {
+		any_hidden |= layers[i].valid  &&  (&layers[i]!=current_layer  ||  !is_visible);
+	}
+	if(  !any_hidden  ) {
+		// most of the time, e.g. when the map is closed
+		return;
+	}
+#ifdef MULTI_THREAD
+	pthread_mutex_lock( &changed_tiles_mutex );
+#endif
+	for(  uint8 i=0;  i<MAX_LAYERS;  i++  ) {
+		map_layer_t &layer = layers[i];
+		if(  layer.valid  &&  (&layer!=current_layer  ||  !is_visible)  ) {
+			if(  layer.changed_tiles.get_count() < map_layer_t::MAX_CHANGED_TILES  ) {
+				layer.changed_tiles.put( k );
+			}
+			else {
+				// cheaper to calculate it again
+				layer.valid = false;
+				layer.changed_tiles.clear();
 			}
 		}
 	}
-	else {
-		// always the whole map ...
-		if(isometric) {
-			relief->init( COL_BLACK );
+#ifdef MULTI_THREAD
+	pthread_mutex_unlock( &changed_tiles_mutex );
+#endif
+}
+
+
+/**
+ * @param all if false, only the layers which depend on the monthly statistics
+ * (or change without telling us, like the forests) are invalidated
+ */
+void reliefkarte_t::invalidate_layers(bool all)
+{
+	const uint32 keep_monthly = MAP_TRACKS|MAX_SPEEDLIMIT|MAP_WEIGHTLIMIT|MAP_OWNER|MAP_FACTORIES|MAP_DEPOT;
+	for(  uint8 i=0;  i<MAX_LAYERS;  i++  ) {
+		map_layer_t &layer = layers[i];
+		if(  all  ||  (layer.key!=0  &&  (layer.key & ~keep_monthly)!=0)  ) {
+			layer.valid = false;
+			layer.changed_tiles.clear();
 		}
-		koord k;
-		for(  k.y=0;  k.y < welt->get_size().y;  k.y++  ) {
-			for(  k.x=0;  k.x < welt->get_size().x;  k.x++  ) {
-				calc_map_pixel(k);
+	}
+	needs_redraw = true;
+}
+
+
+void reliefkarte_t::set_layer_color(koord k, uint8 color)
+{
+	if(  current_layer==NULL  ||  !current_layer->valid  ||  !welt->is_within_limits(k)  ) {
+		return;
+	}
+	current_layer->set( k, color );
+	set_relief_farbe( k, get_shown_color(k) );
+}
+
+
+void reliefkarte_t::calc_layer_maximum(sint16 y_min, sint16 y_max, sint32 &maximum)
+{
+	koord k;
+	for(  k.y=y_min;  k.y<y_max;  k.y++  ) {
+		for(  k.x=0;  k.x<welt->get_size().x;  k.x++  ) {
+			const planquadrat_t *plan = welt->access(k);
+			if(  plan->get_boden_count() > 0  ) {
+				const sint32 amount = calc_tile_amount( plan->get_boden_bei(plan->get_boden_count()-1) );
+				if(  amount > maximum  ) {
+					maximum = amount;
+				}
 			}
 		}
 	}
+}
+
+
+void reliefkarte_t::calc_layer_colors(sint16 y_min, sint16 y_max, sint32 &)
+{
+	array2d_tpl<uint8> &colors = *current_layer->colors;
+	koord k;
+	for(  k.y=y_min;  k.y<y_max;  k.y++  ) {
+		for(  k.x=0;  k.x<welt->get_size().x;  k.x++  ) {
+			colors.at( k.x, k.y ) = calc_tile_color(k);
+		}
+	}
+}
+
+
+// rows are handed out in bands of this height
+#define LAYER_BAND_ROWS (64)
+
+#ifdef MULTI_THREAD
+struct reliefkarte_t::layer_thread_param_t
+{
+	reliefkarte_t *map;
+	layer_rows_func func;
+	int thread_num;
+	int num_threads;
+	sint32 result;
+	// the threads are started once and then wait at these for the next job
+	simthread_barrier_t *start;
+	simthread_barrier_t *end;
+	bool keep_running;
+};
+
+
+void *reliefkarte_t::layer_rows_thread(void *ptr)
+{
+	layer_thread_param_t *param = reinterpret_cast<layer_thread_param_t *>(ptr);
+	while(true) {
+		if(  param->keep_running  ) {
+			simthread_barrier_wait( param->start );
+		}
+		const sint16 height = welt->get_size().y;
+		param->result = -1;
+		for(  sint32 y=param->thread_num*LAYER_BAND_ROWS;  y<height;  y+=param->num_threads*LAYER_BAND_ROWS  ) {
+			(param->map->*(param->func))( y, min( y+LAYER_BAND_ROWS, height ), param->result );
+		}
+		if(  param->keep_running  ) {
+			simthread_barrier_wait( param->end );
+		}
+		else {
+			return NULL;
+		}
+	}
+	return ptr;
+}
+#endif
+
+
+/**
+ * Calls @p func for all rows of the map, using all threads.
+ * @return the largest result of all calls (the results start at -1)
+ */
+sint32 reliefkarte_t::for_all_layer_rows(layer_rows_func func)
+{
+#ifdef MULTI_THREAD
+	static layer_thread_param_t param[MAX_THREADS];
+	static simthread_barrier_t barrier_start;
+	static simthread_barrier_t barrier_end;
+	static bool spawned_threads = false;
+
+	const int num_threads = env_t::num_threads;
+	for(  int t=0;  t<num_threads;  t++  ) {
+		param[t].map = this;
+		param[t].func = func;
+		param[t].thread_num = t;
+		param[t].num_threads = num_threads;
+		param[t].start = &barrier_start;
+		param[t].end = &barrier_end;
+		param[t].keep_running = t < num_threads-1;
+	}
+	if(  !spawned_threads  ) {
+		pthread_attr_t attr;
+		pthread_attr_init( &attr );
+		pthread_attr_setdetachstate( &attr, PTHREAD_CREATE_DETACHED );
+		simthread_barrier_init( &barrier_start, NULL, num_threads );
+		simthread_barrier_init( &barrier_end, NULL, num_threads );
+		for(  int t=0;  t<num_threads-1;  t++  ) {
+			pthread_t thread;
+			if(  pthread_create( &thread, &attr, layer_rows_thread, (void *)&param[t] )  ) {
+				dbg->fatal( "reliefkarte_t::for_all_layer_rows()", "cannot multithread, error at thread #%i", t+1 );
+			}
+		}
+		pthread_attr_destroy( &attr );
+		spawned_threads = true;
+	}
+
+	simthread_barrier_wait( &barrier_start );
+	// the last we run ourselves
+	layer_rows_thread( &param[num_threads-1] );
+	simthread_barrier_wait( &barrier_end );
+
+	sint32 result = -1;
+	for(  int t=0;  t<num_threads;  t++  ) {
+		result = max( result, param[t].result );
+	}
+	return result;
+#else
+	sint32 result = -1;
+	(this->*func)( 0, welt->get_size().y, result );
+	return result;
+#endif
+}
+
+
+void reliefkarte_t::calc_layer()
+{
+	current_layer->changed_tiles.clear();
+
+	// the maximum must be known before the first tile can be colored
+	if(  sint32 *maximum = get_mode_maximum()  ) {
+		*maximum = max( 1, for_all_layer_rows( &reliefkarte_t::calc_layer_maximum ) );
+	}
+	for_all_layer_rows( &reliefkarte_t::calc_layer_colors );
+	current_layer->valid = true;
 
 	// since we do iterate the tourist info list, this must be done here
 	// find tourist spots
@@ -1100,7 +1365,7 @@ void reliefkarte_t::calc_map()
 		// draw them
 		FOR(weighted_vector_tpl<gebaeude_t*>, const g, world_attractions) {
 			koord pos = g->get_pos().get_2d();
-			set_relief_farbe( pos, calc_severity_color(g->get_adjusted_visitor_demand(), max_tourist_ziele));
+			set_layer_color( pos, calc_severity_color(g->get_adjusted_visitor_demand(), max_tourist_ziele));
 		}
 		return;
 	}
@@ -1110,8 +1375,7 @@ void reliefkarte_t::calc_map()
 	{
 		FOR(vector_tpl<fabrik_t*>, const f, welt->get_fab_list()) {
 			koord const pos = f->get_pos().get_2d();
-			set_relief_farbe( pos, COL_BLACK );
-			set_relief_farbe(pos, f->get_kennfarbe());
+			set_layer_color(pos, f->get_kennfarbe());
 		}
 		return;
 	}
@@ -1122,11 +1386,128 @@ void reliefkarte_t::calc_map()
 				koord const pos = d->get_pos().get_2d();
 				// offset of one to avoid
 				static uint8 depot_typ_to_color[19]={ COL_ORANGE, COL_YELLOW, COL_RED, 0, 0, 0, 0, 0, 0, COL_PURPLE, COL_DARK_RED, COL_DARK_ORANGE, 0, 0, 0, 0, 0, 0, COL_LIGHT_RED };
-				set_relief_farbe(pos, depot_typ_to_color[d->get_typ() - obj_t::bahndepot]);
+				set_layer_color(pos, depot_typ_to_color[d->get_typ() - obj_t::bahndepot]);
 			}
 		}
 		return;
 	}
+
+	if(  mode & MAP_PAX_DEST  ) {
+		draw_pax_destinations();
+	}
+}
+
+
+void reliefkarte_t::update_layer()
+{
+	const uint32 key = get_layer_key(mode);
+	current_layer = NULL;
+	for(  uint8 i=0;  i<MAX_LAYERS;  i++  ) {
+		if(  layers[i].key==key  &&  layers[i].colors  ) {
+			current_layer = &layers[i];
+			break;
+		}
+	}
+	if(  current_layer==NULL  ) {
+		// replace the least recently used one
+		current_layer = &layers[0];
+		for(  uint8 i=1;  i<MAX_LAYERS;  i++  ) {
+			if(  layers[i].last_used < current_layer->last_used  ) {
+				current_layer = &layers[i];
+			}
+		}
+		current_layer->valid = false;
+		current_layer->key = key;
+	}
+	current_layer->last_used = ++layer_clock;
+	current_layer->resize( welt->get_size() );
+
+	if(  !current_layer->valid  ) {
+		calc_layer();
+	}
+	else if(  !current_layer->changed_tiles.empty()  ) {
+		vector_tpl<koord> changed_tiles( current_layer->changed_tiles.get_count() );
+#ifdef MULTI_THREAD
+		pthread_mutex_lock( &changed_tiles_mutex );
+#endif
+		FOR(map_layer_t::tile_set_t, const& iter, current_layer->changed_tiles) {
+			changed_tiles.append( iter.key );
+		}
+		current_layer->changed_tiles.clear();
+#ifdef MULTI_THREAD
+		pthread_mutex_unlock( &changed_tiles_mutex );
+#endif
+		FOR(vector_tpl<koord>, const k, changed_tiles) {
+			if(  welt->is_within_limits(k)  ) {
+				current_layer->set( k, calc_tile_color(k) );
+			}
+		}
+	}
+}
+
+
+void reliefkarte_t::draw_layer()
+{
+	// only use bitmap size like screen size
+	scr_size relief_size( min( get_size().w, new_size.w ), min( get_size().h, new_size.h ) );
+	// actually the following line should reduce new/deletes, but does not work properly
+	if(  relief==NULL  ||  (sint16)relief->get_width()!=relief_size.w  ||  (sint16)relief->get_height()!=relief_size.h  ) {
+		delete relief;
+		relief = new array2d_tpl<unsigned char> (relief_size.w,relief_size.h);
+	}
+	cur_off = new_off;
+	cur_size = new_size;
+	needs_redraw = false;
+	is_visible = true;
+
+	update_layer();
+
+	// redraw the map
+	if(  !isometric  ) {
+		koord k;
+		koord start_off = koord( (cur_off.x*zoom_out)/zoom_in, (cur_off.y*zoom_out)/zoom_in );
+		koord end_off = start_off+koord( (relief->get_width()*zoom_out)/zoom_in+1, (relief->get_height()*zoom_out)/zoom_in+1 );
+		for(  k.y=start_off.y;  k.y<end_off.y;  k.y+=zoom_out  ) {
+			for(  k.x=start_off.x;  k.x<end_off.x;  k.x+=zoom_out  ) {
+				if(  welt->is_within_limits(k)  ) {
+					set_relief_farbe( k, current_layer->get(k) );
+				}
+			}
+		}
+	}
+	else {
+		// always the whole map ...
+		relief->init( COL_BLACK );
+		koord k;
+		for(  k.y=0;  k.y < welt->get_size().y;  k.y++  ) {
+			for(  k.x=0;  k.x < welt->get_size().x;  k.x++  ) {
+				set_relief_farbe( k, current_layer->get(k) );
+			}
+		}
+	}
+	draw_vehicles();
+}
+
+
+void reliefkarte_t::calc_map()
+{
+	// done on the next draw(), so that several calls in a row cost nothing
+	invalidate_layers(true);
+}
+
+
+void reliefkarte_t::draw_pax_destinations()
+{
+	if(  city==NULL  ) {
+		return;
+	}
+	const sparse_tpl<uint8> *pax_dests = city->get_pax_destinations_new();
+	koord pos;
+	uint8 color;
+	for(  uint16 i = 0;  i < pax_dests->get_data_count();  i++  ) {
+		pax_dests->get_nonzero( i, pos, color );
+		set_layer_color( pos, color );
+	}
 }
 
 
@@ -1142,6 +1523,8 @@ reliefkarte_t::reliefkarte_t()
 	cur_size = new_size = scr_size(0,0);
 	needs_redraw = true;
 	transport_type_showed_on_map = simline_t::line;
+	current_layer = NULL;
+	layer_clock = 0;
 }
 
 
@@ -1164,6 +1547,10 @@ void reliefkarte_t::init()
 {
 	delete relief;
 	relief = NULL;
+	for(  uint8 i=0;  i<MAX_LAYERS;  i++  ) {
+		layers[i].release();
+	}
+	current_layer = NULL;
 	needs_redraw = true;
 	is_visible = false;
 
@@ -1184,7 +1571,7 @@ void reliefkarte_t::set_mode(MAP_MODES new_mode)
 
 void reliefkarte_t::new_month()
 {
-	needs_redraw = true;
+	invalidate_layers(false);
 }
 
 void reliefkarte_t::invalidate_map_lines_cache()
@@ -1304,8 +1691,7 @@ void reliefkarte_t::draw(scr_coord pos)
 	}
 
 	if(  needs_redraw  ||  cur_off!=new_off  ||  cur_size!=new_size  ) {
-		calc_map();
-		needs_redraw = false;
+		draw_layer();
 	}
 
 	if(relief==NULL) {
@@ -1316,27 +1702,12 @@ void reliefkarte_t::draw(scr_coord pos)
 		const uint32 current_pax_destinations = city->get_pax_destinations_new_change();
 		if(  pax_destinations_last_change > current_pax_destinations  ) {
 			// new month started.
-			calc_map();
+			current_layer->valid = false;
+			draw_layer();
 		}
 		else if(  pax_destinations_last_change < current_pax_destinations  ) {
 			// new pax_dest in city.
-			const sparse_tpl<uint8> *pax_dests = city->get_pax_destinations_new();
-			koord pos, min, max;
-			uint8 color;
-			for(  uint16 i = 0;  i < pax_dests->get_data_count();  i++  ) {
-				pax_dests->get_nonzero( i, pos, color );
-				min = koord(pos.x, pos.y);
-				max = koord(pos.x + 1, pos.y + 1);
-				pos.x = min.x;
-				do {
-					pos.y = min.y;
-					do {
-						set_relief_farbe(pos, color);
-						pos.y++;
-					} while(pos.y < max.y);
-					pos.x++;
-				} while (pos.x < max.x);
-			}
+			draw_pax_destinations();
 		}
 		pax_destinations_last_change = city->get_pax_destinations_new_change();
 	}
@@ -1864,7 +2235,12 @@ void reliefkarte_t::set_city( const stadt_t* _city )
 		if(  _city  ) {
 			pax_destinations_last_change = _city->get_pax_destinations_new_change();
 		}
-		calc_map();
+		for(  uint8 i=0;  i<MAX_LAYERS;  i++  ) {
+			if(  layers[i].key & MAP_PAX_DEST  ) {
+				layers[i].valid = false;
+			}
+		}
+		needs_redraw = true;
 	}
 }
 
@@ -8,6 +8,7 @@
 #include "../dataobj/schedule.h"
 #include "../tpl/array2d_tpl.h"
 #include "../tpl/vector_tpl.h"
+#include "../tpl/koordhashtable_tpl.h"
 
 
 class karte_ptr_t;
@@ -81,6 +82,88 @@ private:
 
 	void set_relief_color_clip( sint16 x, sint16 y, uint8 color );
 
+	/**
+	 * The colours of all tiles of the map for one map mode. The bitmap on
+	 * screen (relief) is drawn from the layer of the current mode, so that
+	 * scrolling, zooming or switching back to a recent mode does not have to
+	 * look at the world again. Changes of tiles are applied one by one.
+	 * Vehicles are not part of the layers; they are drawn on top. The layers
+	 * are only kept while the map is open.
+	 */
+	class map_layer_t
+	{
+	public:
+		enum { MAX_CHANGED_TILES = 65536 };
+
+		uint32 key;
+		bool valid;
+		uint32 last_used;
+		// one pixel per tile
+		array2d_tpl<uint8> *colors;
+		// tiles which changed while the layer was not shown (each once)
+		typedef koordhashtable_tpl<koord, uint8> tile_set_t;
+		tile_set_t changed_tiles;
+
+		map_layer_t() : key(0), valid(false), last_used(0), colors(NULL) {}
+		~map_layer_t() { release(); }
+
+		void release();
+		void resize(koord size);
+
+		uint8 get(koord k) const { return colors->at( k.x, k.y ); }
+		void set(koord k, uint8 color) { colors->at( k.x, k.y ) = color; }
+	};
+
+	enum { MAX_LAYERS = 2 };
+	map_layer_t layers[MAX_LAYERS];
+	map_layer_t *current_layer;
+	uint32 layer_clock;
+
+	// the modes which share a layer have the same key
+	static uint32 get_layer_key(MAP_MODES m);
+
+	// makes current_layer the layer for the current mode and brings it up to date
+	void update_layer();
+
+	// fills the current layer, using all threads
+	void calc_layer();
+
+	// the parts of calc_layer() done by each thread, for the rows y_min ... y_max-1
+	typedef void (reliefkarte_t::*layer_rows_func)(sint16 y_min, sint16 y_max, sint32 &result);
+	sint32 for_all_layer_rows(layer_rows_func func);
+	void calc_layer_maximum(sint16 y_min, sint16 y_max, sint32 &maximum);
+	void calc_layer_colors(sint16 y_min, sint16 y_max, sint32 &);
+#ifdef MULTI_THREAD
+	struct layer_thread_param_t;
+	static void *layer_rows_thread(void *);
+#endif
+
+	void invalidate_layers(bool all);
+
+	// notes a changed tile for the layers not shown at the moment
+	void add_changed_tile(koord k);
+
+	// sets the color of a tile in the current layer and on screen
+	void set_layer_color(koord k, uint8 color);
+
+	// for the modes which scale their colors to the largest value on the map
+	static sint32 *get_mode_maximum();
+	static sint32 calc_tile_amount(const grund_t *gr);
+
+	// the color of the uppermost ground of a tile in the current mode, without vehicles
+	uint8 calc_tile_color(koord k) const;
+
+	// the color shown for a tile of the current layer: the layer's, or that of a vehicle on it
+	uint8 get_shown_color(koord k) const;
+
+	// marks the vehicles on top of the map drawn from the layer
+	void draw_vehicles();
+
+	// redraws the bitmap from the current layer
+	void draw_layer();
+
+	void draw_pax_destinations();
+
 	// all stuff connected with schedule display
 	class line_segment_t
 	{
@@ -221,6 +304,13 @@ public:
 	// update color with render mode (but few are ignored ... )
 	void calc_map_pixel(const koord k);
 
+	// a vehicle entered or left the tile; only to be called while the map is visible
+	void calc_vehicle_pixel(const koord k);
+
+	// the map window was closed: frees the layers
+	void release_layers();
+
+	// recalculates the whole map when drawn next (use calc_map_pixel() for single tiles)
 	void calc_map();
 
 	// calculates the current size of the map (but do not change anything else)
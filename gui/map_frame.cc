@@ -552,7 +552,7 @@ bool map_frame_t::infowin_event(const event_t *ev)
 			reliefkarte_t::get_karte()->set_xy_offset_size( scr_coord(0,0), scr_size(0,0) );
 		}
 		else if(ev->ev_code == WIN_CLOSE) {
-			reliefkarte_t::get_karte()->is_visible = false;
+			reliefkarte_t::get_karte()->release_layers();
 		}
 	}
 
@@ -131,6 +131,8 @@ public:
 	 */
 	const char * get_help_filename() const {return "finances.txt";}
 
+	uint32 get_refresh_interval() const OVERRIDE { return 1000; }
+
 	/**
 	 * Constructor. Adds all necessary Subcomponents.
 	 * @author Hj. Malthaner, Owen Rudge
@@ -103,6 +103,8 @@ public:
 	*/
 	const char* get_help_filename() const { return "linemanagement.txt"; }
 
+	uint32 get_refresh_interval() const OVERRIDE { return 1000; }
+
 	/**
 	* Does this window need a min size button in the title bar?
 	* @return true if such a button is needed
@@ -32,6 +32,7 @@
 #include "../simticker.h"
 #include "simwin.h"
 #include "../simintr.h"
+#include "../simmem.h"
 #include "../simhalt.h"
 #include "../simworld.h"
 
@@ -47,6 +48,7 @@
 
 #include "../player/simplay.h"
 #include "../tpl/inthashtable_tpl.h"
+#include "../tpl/ptrhashtable_tpl.h"
 #include "../tpl/vector_tpl.h"
 #include "../utils/simstring.h"
 #include "../utils/cbuffer_t.h"
@@ -127,6 +129,22 @@ static vector_tpl<simwin_t> kill_list(MAX_WIN);
 
 static karte_t* wl = NULL; // Pointer to current world is set in win_set_world
 
+/**
+ * The image of a window as it was last drawn. A window which is neither on top
+ * nor under the mouse is only drawn again every get_refresh_interval() ms; in
+ * between its image is copied to the screen. So it neither spends time in its
+ * components nor marks its area dirty every frame.
+ */
+struct win_cache_t
+{
+	PIXVAL *pixels;
+	scr_rect rect;   // where the image was taken
+	uint32 time;     // when it was drawn
+	bool valid;
+};
+
+static ptrhashtable_tpl<gui_frame_t *, win_cache_t> win_caches;
+
 static int top_win(int win, bool keep_state );
 static void display_win(int win);
 
@@ -724,6 +742,10 @@ static bool destroy_framed_win(simwin_t *wins)
 	mark_rect_dirty_wc( wins->pos.x - 1, wins->pos.y - 1, wins->pos.x + size.w + 2, wins->pos.y + size.h + 2 ); // -1, +2 for env_t::window_frame_active
 
 	gui_frame_t* gui = wins->gui; // save pointer to gui window: might be modified in event handling, or could be modified if wins points to value in kill_list and kill_list is modified! nasty surprise
+	if(  win_cache_t *cache = win_caches.access(gui)  ) {
+		free( cache->pixels );
+		win_caches.remove(gui);
+	}
 	if(  gui  ) {
 		event_t ev;
 
@@ -876,12 +898,42 @@ int top_win(int win, bool keep_state )
 }
 
 
+// true, if the window may be shown from its last image this frame
+static bool is_win_cachable(int win)
+{
+	const simwin_t &w = wins[win];
+	if(  (unsigned)win == wins.get_count()-1  ||  w.gui == tooltip_element  ||  w.rollup  ||  w.dirty  ) {
+		// on top, under the mouse or changed
+		return false;
+	}
+	if(  w.gui->is_dirty()  ||  !w.gui->is_opaque()  ||  w.gui->get_refresh_interval() == 0  ) {
+		return false;
+	}
+	// only when completely visible, since it is taken from the screen
+	const scr_size size = w.gui->get_windowsize();
+	const clip_dimension cl = display_get_clip_wh();
+	return  w.pos.x >= cl.x  &&  w.pos.y >= cl.y  &&  w.pos.x + size.w <= cl.xx  &&  w.pos.y + size.h <= min( cl.yy, display_get_height() );
+}
+
+
 void display_win(int win)
 {
 	// ok, now process it
 	gui_frame_t *comp = wins[win].gui;
 	scr_size size = comp->get_windowsize();
 	scr_coord pos = wins[win].pos;
+
+	const bool cachable = is_win_cachable(win);
+	win_cache_t *cache = win_caches.access(comp);
+	const scr_rect rect( pos, size );
+	if(  cachable  &&  cache  &&  cache->valid  &&  cache->rect == rect  &&  dr_time() - cache->time < comp->get_refresh_interval()  ) {
+		if(  display_restore_rect( cache->pixels, rect.x, rect.y, rect.w, rect.h )  ) {
+			comp->draw_shadows( pos, size );
+			return;
+		}
+	}
+	// redrawn after being shown from the image: the components did not mark their changes meanwhile
+	const bool was_cached = cache  &&  cache->valid;
 	PLAYER_COLOR_VAL title_color = (comp->get_titlecolor()&0xF8)+env_t::front_window_bar_color;
 	PLAYER_COLOR_VAL text_color = +env_t::front_window_text_color;
 	if(  (unsigned)win!=wins.get_count()-1  ) {
@@ -928,6 +980,29 @@ void display_win(int win)
 			win_draw_window_dragger( pos, size);
 		}
 	}
+
+	if(  cachable  ) {
+		if(  cache == NULL  ) {
+			win_cache_t empty;
+			empty.pixels = NULL;
+			empty.valid = false;
+			win_caches.put( comp, empty );
+			cache = win_caches.access(comp);
+		}
+		if(  cache->pixels == NULL  ||  cache->rect.w * cache->rect.h != rect.w * rect.h  ) {
+			free( cache->pixels );
+			cache->pixels = MALLOCN( PIXVAL, rect.w * rect.h );
+		}
+		cache->rect = rect;
+		cache->time = dr_time();
+		cache->valid = display_save_rect( cache->pixels, rect.x, rect.y, rect.w, rect.h );
+	}
+	else if(  cache  ) {
+		cache->valid = false;
+	}
+	if(  was_cached  ) {
+		mark_rect_dirty_wc( rect.x, rect.y, rect.x + rect.w, rect.y + rect.h );
+	}
 }
 
 
@@ -0,0 +1,184 @@
+/*
+ * This file is part of the Simutrans project under the artistic licence.
+ * (see licence.txt)
+ */
+
+#ifndef gui_sorted_list_model_h
+#define gui_sorted_list_model_h
+
+#include <stdint.h>
+#include <algorithm>
+
+#include "../simtypes.h"
+#include "../simsys.h"
+#include "../tpl/inthashtable_tpl.h"
+#include "../tpl/quickstone_tpl.h"
+#include "../tpl/quickstone32_tpl.h"
+#include "../tpl/vector_tpl.h"
+#include "../utils/for.h"
+
+
+/**
+ * Key of a list entry, for finding out which entries came and went.
+ * An index or address may be reused by a new entry, so sync() also compares the
+ * entries themselves (for quickstone32_tpl this includes the generation).
+ */
+template<class T> inline uint64 get_list_model_id(T *p) { return (uint64)(uintptr_t)p; }
+template<class T> inline uint64 get_list_model_id(const quickstone_tpl<T> &h) { return h.get_id(); }
+template<class T> inline uint64 get_list_model_id(const quickstone32_tpl<T> &h) { return h.get_id(); }
+
+
+/**
+ * The sorted rows of a list window (convoys, stops, factories, cities ...).
+ *
+ * Instead of collecting and sorting all entries again on every refresh,
+ * sync() only removes the entries which are gone and inserts the new ones
+ * at their place, and update_order() only moves the rows whose sort key
+ * has changed since. A complete sort is only done when the sort order
+ * itself changes or when very many rows moved.
+ *
+ * CMP is a strict weak ordering (a function or a function object).
+ */
+template<class T, class CMP> class sorted_list_model_tpl
+{
+	vector_tpl<T> rows;
+	CMP cmp;
+
+	/// time of the last sync(), see is_refresh_due()
+	uint32 last_sync;
+
+	/// if more rows than this moved, a complete sort is cheaper
+	uint32 get_max_moves() const { return 16 + rows.get_count() / 64; }
+
+public:
+	/// changed sort keys are picked up at most this often (in ms)
+	enum { REFRESH_INTERVAL = 1000 };
+
+	explicit sorted_list_model_tpl(CMP c) : cmp(c), last_sync(0) {}
+
+	uint32 get_count() const { return rows.get_count(); }
+	bool empty() const { return rows.empty(); }
+
+	T const& operator[](uint32 i) const { return rows[i]; }
+
+	typedef typename vector_tpl<T>::const_iterator const_iterator;
+	const_iterator begin() const { return rows.begin(); }
+	const_iterator end() const { return rows.end(); }
+
+	void clear() { rows.clear(); }
+
+	/// Changes the sort order and sorts all rows
+	void set_compare(CMP c)
+	{
+		cmp = c;
+		std::sort( rows.begin(), rows.end(), cmp );
+	}
+
+	/// Inserts a row at its place
+	void add(T const& row) { rows.insert_ordered( row, cmp ); }
+
+	/// Removes a row; @returns false if it was not in the list
+	bool remove(T const& row) { return rows.remove( row ); }
+
+	/// To be called after the sort key of @p row changed
+	void changed(T const& row)
+	{
+		if(  rows.remove( row )  ) {
+			add( row );
+		}
+	}
+
+	/// @returns true, if the last sync() was long enough ago to pick up changed sort keys
+	bool is_refresh_due() const { return dr_time() - last_sync >= (uint32)REFRESH_INTERVAL; }
+
+	/**
+	 * Brings the rows in line with @p source, keeping only the entries for which
+	 * @p accept returns true. The rows which remain keep their place, new ones are
+	 * inserted at theirs. Then changed sort keys are taken care of by update_order().
+	 * @returns true if any row was added, removed or moved.
+	 */
+	template<class SOURCE, class FILTER>
+	bool sync(SOURCE const& source, FILTER accept)
+	{
+		last_sync = dr_time();
+
+		typedef inthashtable_tpl<uint64, T> wanted_t;
+		wanted_t wanted;
+		FORT(SOURCE, const& entry, source) {
+			const T row = entry;
+			if(  accept( row )  ) {
+				wanted.put( get_list_model_id( row ), row );
+			}
+		}
+
+		// drop what is gone, and strike what is still there from the list of new rows
+		bool modified = false;
+		uint32 kept = 0;
+		for(  uint32 i = 0;  i < rows.get_count();  i++  ) {
+			const uint64 id = get_list_model_id( rows[i] );
+			const T *w = wanted.access( id );
+			// a different entry under the same key replaces the old one
+			if(  w  &&  *w == rows[i]  ) {
+				wanted.remove( id );
+				rows[kept++] = rows[i];
+			}
+		}
+		if(  kept < rows.get_count()  ) {
+			rows.set_count( kept );
+			modified = true;
+		}
+
+		if(  !wanted.empty()  ) {
+			if(  wanted.get_count() > get_max_moves()  ) {
+				// e.g. when the window opens
+				FORT(wanted_t, const& iter, wanted) {
+					rows.append( iter.value );
+				}
+				std::sort( rows.begin(), rows.end(), cmp );
+			}
+			else {
+				FORT(wanted_t, const& iter, wanted) {
+					add( iter.value );
+				}
+			}
+			modified = true;
+		}
+
+		return update_order()  ||  modified;
+	}
+
+	/**
+	 * Moves the rows whose sort key changed to their new place.
+	 * @returns true if any row was moved.
+	 */
+	bool update_order()
+	{
+		vector_tpl<T> moved;
+		uint32 i = 1;
+		while(  i < rows.get_count()  ) {
+			if(  !cmp( rows[i], rows[i-1] )  ) {
+				i++;
+				continue;
+			}
+			// out of order: either rows[i-1] has grown (then it is also larger than rows[i+1]) or rows[i] has shrunk
+			const uint32 out = (i + 1 < rows.get_count()  &&  cmp( rows[i+1], rows[i-1] )) ? i - 1 : i;
+			moved.append( rows[out] );
+			rows.remove_at( out );
+			if(  moved.get_count() > get_max_moves()  ) {
+				FORT(vector_tpl<T>, const& row, moved) {
+					rows.append( row );
+				}
+				std::sort( rows.begin(), rows.end(), cmp );
+				return true;
+			}
+			// compare the new neighbours
+			i = out > 0 ? out : 1;
+		}
+		FORT(vector_tpl<T>, const& row, moved) {
+			add( row );
+		}
+		return !moved.empty();
+	}
+};
+
+#endif
@@ -725,7 +725,7 @@ void vehicle_class_manager_t::rdwr(loadsave_t *file)
 		// now we can open the window ...
 		scr_coord const& pos = win_get_pos(this);
 		vehicle_class_manager_t *w = new vehicle_class_manager_t(cnv);
-		create_win(pos.x, pos.y, w, w_info, magic_class_manager + cnv.get_id());
+		create_win(pos.x, pos.y, w, w_info, cnv->get_window_magic(magic_class_manager));
 		w->set_windowsize( size );
 		w->scrolly.set_scroll_position( xoff, yoff );
 		// we must invalidate halthandle
@@ -20,6 +20,37 @@ uint32 dr_time(void)
 }
 
 
+// images encoded by previous runs, if given
+static const char* cache_file = NULL;
+
+
+static int make_pak(int argc, char* argv[])
+{
+	try {
+		const char* dest;
+		if (argc) {
+			dest = argv[0];
+			argv++, argc--;
+		}
+		else {
+			dest = "./";
+		}
+		if (cache_file) {
+			image_writer_t::load_cache(cache_file);
+		}
+		root_writer_t::instance()->write(dest, argc, argv);
+		if (cache_file) {
+			image_writer_t::save_cache(cache_file);
+		}
+	}
+	catch (const obj_pak_exception_t& e) {
+		dbg->error( e.get_class(), e.get_info() );
+		return 1;
+	}
+	return 0;
+}
+
+
 int main(int argc, char* argv[])
 {
 	argv++, argc--;
@@ -28,7 +59,18 @@ int main(int argc, char* argv[])
 
 	debuglevel = 2; // only warnings and errorsS
 
-	while(  argc  &&  (  !STRICMP(argv[0], "quiet")  ||  !STRICMP(argv[0], "verbose")  ||  !STRICMP(argv[0], "debug")  )  ) {
+	while(  argc  &&  (  !STRICMP(argv[0], "quiet")  ||  !STRICMP(argv[0], "verbose")  ||  !STRICMP(argv[0], "debug")  ||  !STRNICMP(argv[0], "threads=", 8)  ||  !STRNICMP(argv[0], "cache=", 6)  )  ) {
+
+		if (argc && !STRNICMP(argv[0], "threads=", 8)) {
+			root_writer_t::set_threads(atoi(argv[0] + 8));
+			argv++, argc--;
+			continue;
+		}
+		if (argc && !STRNICMP(argv[0], "cache=", 6)) {
+			cache_file = argv[0] + 6;
+			argv++, argc--;
+			continue;
+		}
 
 		if (argc && !STRICMP(argv[0], "debug")) {
 			argv++, argc--;
@@ -61,23 +103,7 @@ int main(int argc, char* argv[])
 
 	if (argc && !STRICMP(argv[0], "pak")) {
 		argv++, argc--;
-
-		try {
-			const char* dest;
-			if (argc) {
-				dest = argv[0];
-				argv++, argc--;
-			}
-			else {
-				dest = "./";
-			}
-			root_writer_t::instance()->write(dest, argc, argv);
-		}
-		catch (const obj_pak_exception_t& e) {
-			dbg->error( e.get_class(), e.get_info() );
-			return 1;
-		}
-		return 0;
+		return make_pak(argc, argv);
 	}
 
 	if (argc && STRNICMP(argv[0], "pak", 3) == 0) {
@@ -90,24 +116,8 @@ int main(int argc, char* argv[])
 
 			argv++, argc--;
 
-			try {
-				const char* dest;
-				if (argc) {
-					dest = argv[0];
-					argv++, argc--;
-				}
-				else {
-					dest = "./";
-				}
-				root_writer_t::instance()->write(dest, argc, argv);
-			}
-			catch (const obj_pak_exception_t& e) {
-				dbg->error( e.get_class(), e.get_info() );
-				return 1;
-			}
-
 			// image_writer_t::dump_special_histogramm();
-			return 0;
+			return make_pak(argc, argv);
 		}
 	}
 
@@ -166,6 +176,12 @@ int main(int argc, char* argv[])
 		"\n"
 		"      with QUIET as first arg copyright message will be omitted\n"
 		"\n"
+		"      THREADS=<n> before the command compiles n dat files at once\n"
+		"          (default: one per processor)\n"
+		"      CACHE=<file> before the command keeps the encoded images in file,\n"
+		"          unchanged images are taken from there in later runs\n"
+		"      Pak files which did not change are not written again.\n"
+		"\n"
 		"      with VERBOSE as first arg also unused lines\n"
 		"      and unassinged entrys are printed\n"
 		"\n"
@@ -16,6 +16,7 @@
 #include "network_address.h"
 #include "network_packet.h"
 #include "network_socket_list.h"
+#include "network_poll.h"
 #include "network_cmd.h"
 #include "network_cmd_ingame.h"
 #include "network_cmp_pakset.h"
@@ -484,28 +485,16 @@ network_command_t* network_get_received_command()
 */
 network_command_t* network_check_activity(karte_t *, int timeout)
 {
-	fd_set fds;
-	FD_ZERO(&fds);
-
-	socket_list_t::fill_set(&fds);
-
-	// time out: MAC complains about too long timeouts
-	struct timeval tv;
-	tv.tv_sec = timeout / 1000;
-	tv.tv_usec = (timeout % 1000) * 1000ul;
-
-	int action = select(FD_SETSIZE, &fds, NULL, NULL, &tv);
-	if (action <= 0) {
+	static vector_tpl<SOCKET> ready;
+	ready.clear();
+	if (!socket_list_t::wait_ready(ready, false, timeout)) {
 		// timeout: return command from the queue
 		return network_get_received_command();
 	}
 
 	// accept new connection
-	socket_list_t::server_socket_iterator_t iter_s(&fds);
-	while (iter_s.next()) {
-		SOCKET accept_sock = iter_s.get_current();
-
-		if (accept_sock != INVALID_SOCKET) {
+	FOR(vector_tpl<SOCKET>, const accept_sock, ready) {
+		if (socket_list_t::is_server_socket(accept_sock)) {
 			struct sockaddr_in client_name;
 			socklen_t size = sizeof(client_name);
 			SOCKET s = accept(accept_sock, (struct sockaddr *)&client_name, &size);
@@ -533,11 +522,8 @@ network_command_t* network_check_activity(karte_t *, int timeout)
 	}
 
 	// receive from clients
-	socket_list_t::client_socket_iterator_t iter_c(&fds);
-	while (iter_c.next()) {
-		SOCKET sender = iter_c.get_current();
-
-		if (sender != INVALID_SOCKET  &&  socket_list_t::has_client(sender)) {
+	FOR(vector_tpl<SOCKET>, const sender, ready) {
+		if (!socket_list_t::is_server_socket(sender)  &&  socket_list_t::has_client(sender)) {
 			uint32 client_id = socket_list_t::get_client_id(sender);
 			network_command_t *nwc = socket_list_t::get_client(client_id).receive_nwc();
 			if (nwc) {
@@ -553,34 +539,21 @@ network_command_t* network_check_activity(karte_t *, int timeout)
 
 void network_process_send_queues(int timeout)
 {
-	fd_set fds;
-	FD_ZERO(&fds);
-
-	socket_list_t::fill_set(&fds);
-
-	// time out
-	struct timeval tv;
-	tv.tv_sec = timeout / 1000;
-	tv.tv_usec = (timeout % 1000) * 1000ul;
-
-	int action = select(FD_SETSIZE, NULL, &fds, NULL, &tv);
-
-	if (action <= 0) {
+	// only sockets with something to send are waited for
+	static vector_tpl<SOCKET> ready;
+	ready.clear();
+	if (!socket_list_t::wait_ready(ready, true, timeout)) {
 		// timeout: return
 		return;
 	}
 
 	// send to clients
-	socket_list_t::client_socket_iterator_t iter_c(&fds);
-	while (iter_c.next() && action>0) {
-		SOCKET sock = iter_c.get_current();
-
-		if (sock != INVALID_SOCKET  &&  socket_list_t::has_client(sock)) {
+	FOR(vector_tpl<SOCKET>, const sock, ready) {
+		if (socket_list_t::has_client(sock)) {
 			uint32 client_id = socket_list_t::get_client_id(sock);
 			socket_list_t::get_client(client_id).process_send_queue();
 			// errors are caught and treated in socket_info_t::process_send_queue
 		}
-		action--;
 	}
 }
 
@@ -653,6 +626,31 @@ void network_send_server(network_command_t* nwc)
 }
 
 
+/**
+ * waits at most timeout_ms until sock can be read from (or written to, if @p write)
+ * @return true if the socket is ready (or has failed)
+ */
+static bool network_wait_socket(SOCKET sock, bool write, int timeout_ms)
+{
+#ifdef USE_EPOLL
+	// poll() is not limited to sockets below FD_SETSIZE
+	struct pollfd pfd;
+	pfd.fd = sock;
+	pfd.events = write ? POLLOUT : POLLIN;
+	pfd.revents = 0;
+	return poll(&pfd, 1, timeout_ms) == 1;
+#else
+	fd_set fds;
+	FD_ZERO(&fds);
+	FD_SET(sock, &fds);
+	struct timeval tv;
+	tv.tv_sec = timeout_ms / 1000;
+	tv.tv_usec = (timeout_ms % 1000) * 1000ul;
+	return select(FD_SETSIZE, write ? NULL : &fds, write ? &fds : NULL, NULL, &tv) == 1;
+#endif
+}
+
+
 /**
 * send data to dest
 * @param buf the data
@@ -676,14 +674,7 @@ bool network_send_data(SOCKET dest, const char *buf, const uint16 size, uint16 &
 			}
 			else {
 				// try again, test whether sending is possible
-				fd_set fds;
-				FD_ZERO(&fds);
-				FD_SET(dest, &fds);
-				struct timeval tv;
-				tv.tv_sec = timeout_ms / 1000;
-				tv.tv_usec = (timeout_ms % 1000) * 1000ul;
-				// can we write?
-				if (select(FD_SETSIZE, NULL, &fds, NULL, &tv) != 1) {
+				if (!network_wait_socket(dest, true, timeout_ms)) {
 					dbg->warning("network_send_data", "could not write to [%s]", dest);
 					return false;
 				}
@@ -716,14 +707,8 @@ bool network_receive_data(SOCKET sender, void *dest, const uint16 len, uint16 &r
 	char *ptr = (char *)dest;
 
 	do {
-		fd_set fds;
-		FD_ZERO(&fds);
-		FD_SET(sender, &fds);
-		struct timeval tv;
-		tv.tv_sec = timeout_ms / 1000;
-		tv.tv_usec = (timeout_ms % 1000) * 1000ul;
 		// can we read?
-		if (select(FD_SETSIZE, &fds, NULL, NULL, &tv) != 1) {
+		if (!network_wait_socket(sender, false, timeout_ms)) {
 			return true;
 		}
 		// now receive
@@ -82,17 +82,6 @@ bool network_command_t::is_local_cmd()
 }
 
 
-packet_t* network_command_t::copy_packet() const
-{
-	if (packet) {
-		return new packet_t(*packet);
-	}
-	else {
-		return NULL;
-	}
-}
-
-
 void nwc_auth_player_t::rdwr()
 {
 	network_command_t::rdwr();
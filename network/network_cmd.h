@@ -77,10 +77,6 @@ public:
 	SOCKET get_sender();
 
 	packet_t *get_packet() const { return packet; }
-	/**
-	 * returns ptr to a copy of the packet
-	 */
-	packet_t *copy_packet() const;
 
 	// creates an instance:
 	// gets the nwc-id from the packet, and reads its data
@@ -112,6 +108,7 @@ public:
 		SRVC_UNLOCK_COMPANY   = 13,
 		SRVC_REMOVE_COMPANY   = 14,
 		SRVC_LOCK_COMPANY     = 15,
+		SRVC_PROFILE_STEPS    = 16,
 		SRVC_MAX
 	};
 
@@ -20,6 +20,7 @@
 #include "../utils/simrandom.h"
 #include "../utils/cbuffer_t.h"
 #include "../utils/csv.h"
+#include "../utils/step_profiler.h"
 #include "../display/viewport.h"
 
 
@@ -957,6 +958,10 @@ void nwc_check_t::rdwr()
 	network_world_command_t::rdwr();
 	server_checklist.rdwr(packet);
 	packet->rdwr_long(server_sync_step);
+	if (packet->get_version() >= 2) {
+		// older servers send no world hash; it then stays at step zero, which is never compared
+		server_world_hash.rdwr(packet);
+	}
 	if (packet->is_loading()  &&  env_t::server) {
 		// server does not receive nwc_check_t-commands
 		packet->failed();
@@ -1570,6 +1575,20 @@ bool nwc_service_t::execute(karte_t *welt)
 			break;
 		}
 
+		case SRVC_PROFILE_STEPS: {
+			if (number) {
+				step_profiler_t::set_enabled(true);
+			}
+			else if (step_profiler_t::is_enabled()) {
+				// written to the user directory, under a fixed name
+				step_profiler_t::set_enabled(false);
+				std::string filename = env_t::user_dir;
+				step_profiler_t::write_csv((filename + "step_profile.csv").c_str());
+				step_profiler_t::write_trace((filename + "step_profile.json").c_str());
+			}
+			break;
+		}
+
 		default: ;
 	}
 	return true; // to delete
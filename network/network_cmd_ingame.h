@@ -258,18 +258,20 @@ private:
  * nwc_check_t
  * @from-server:
  *		@data checklist random seed and quickstone next check entries at previous sync_step
- *		clients: check random seed, if check fails disconnect.
+ *		@data latest world hashes, telling which part of the world got out of sync
+ *		clients: check random seed and world hashes, if check fails disconnect.
  *		the check is done in karte_t::interactive
  */
 class nwc_check_t : public network_world_command_t {
 public:
 	nwc_check_t() : network_world_command_t(NWC_CHECK, 0, 0), server_sync_step(0) { }
-	nwc_check_t(uint32 sync_steps, uint32 map_counter, const checklist_t &server_checklist_, uint32 server_sync_step_) : network_world_command_t(NWC_CHECK, sync_steps, map_counter), server_checklist(server_checklist_), server_sync_step(server_sync_step_) {};
+	nwc_check_t(uint32 sync_steps, uint32 map_counter, const checklist_t &server_checklist_, uint32 server_sync_step_, const world_hash_t &server_world_hash_) : network_world_command_t(NWC_CHECK, sync_steps, map_counter), server_checklist(server_checklist_), server_sync_step(server_sync_step_), server_world_hash(server_world_hash_) {};
 	virtual void rdwr();
 	virtual void do_command(karte_t*) { }
 	virtual const char* get_name() { return "nwc_check_t"; }
 	checklist_t server_checklist;
 	uint32 server_sync_step;
+	world_hash_t server_world_hash;
 	// no action required -> can be ignored if too old
 	virtual bool ignore_old_events() const { return true; }
 };
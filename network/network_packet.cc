@@ -1,3 +1,5 @@
+#include <string.h>
+
 #include "../simdebug.h"
 #include "network_packet.h"
 #include "network_socket_list.h"
@@ -137,3 +139,35 @@ void packet_t::sent_by_server()
 {
 	sock = socket_list_t::get_socket(0);
 }
+
+
+packet_buffer_t::packet_buffer_t(const packet_t &p) :
+	references(1)
+{
+	size = (uint16)p.get_current_index();
+	data = new uint8[size];
+	memcpy( data, p.get_data(), size );
+
+	// write header at right place, like packet_t::send() does
+	memory_rw_t header( data, HEADER_SIZE, true );
+	uint16 version = p.get_version();
+	uint16 id = p.get_id();
+	header.rdwr_short( size );
+	header.rdwr_short( version );
+	header.rdwr_short( id );
+}
+
+
+packet_buffer_t::~packet_buffer_t()
+{
+	delete [] data;
+}
+
+
+void packet_buffer_t::release()
+{
+	assert( references > 0 );
+	if(  --references == 0  ) {
+		delete this;
+	}
+}
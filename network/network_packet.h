@@ -71,6 +71,11 @@ public:
 	uint16 get_id() const { return id; }
 	void set_id(uint16 id_) { id = id_; }
 
+	uint16 get_version() const { return version; }
+
+	/// the buffer, starting with the header
+	const uint8 *get_data() const { return buf; }
+
 	SOCKET get_sender() { return sock; }
 
 	/**
@@ -79,4 +84,35 @@ public:
 	 */
 	void sent_by_server();
 };
+
+
+/**
+ * A packet ready for sending (with its header), which is queued for several
+ * clients at once: it is serialised once and shared by reference instead of
+ * being copied for every send queue. It is not changed any more once created.
+ * Only to be used by the thread doing the network, the count is not atomic.
+ */
+class packet_buffer_t {
+private:
+	uint8 *data;
+	uint16 size;
+	uint32 references;
+
+	~packet_buffer_t();
+
+public:
+	/**
+	 * copies the written data of @p p (which must be in saving mode)
+	 * the creator holds the first reference
+	 */
+	explicit packet_buffer_t(const packet_t &p);
+
+	const uint8 *get_data() const { return data; }
+	uint16 get_size() const { return size; }
+
+	void add_reference() { references++; }
+
+	/// deletes the buffer with the last reference
+	void release();
+};
 #endif
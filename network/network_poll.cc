@@ -0,0 +1,113 @@
+#include <string.h>
+
+#include "network_poll.h"
+#include "../simdebug.h"
+#include "../utils/for.h"
+
+#ifdef USE_EPOLL
+#include <sys/epoll.h>
+
+// ready sockets taken from the kernel per call; more are reported by the next wait()
+#define MAX_EPOLL_EVENTS (256)
+#endif
+
+
+network_poll_t::network_poll_t(bool w) :
+	write(w)
+{
+#ifdef USE_EPOLL
+	epoll_fd = epoll_create1( EPOLL_CLOEXEC );
+	if(  epoll_fd < 0  ) {
+		dbg->fatal( "network_poll_t::network_poll_t()", "epoll_create1() failed: %s", strerror(errno) );
+	}
+#endif
+}
+
+
+network_poll_t::~network_poll_t()
+{
+#ifdef USE_EPOLL
+	close( epoll_fd );
+#endif
+}
+
+
+void network_poll_t::add(SOCKET s)
+{
+	if(  s == INVALID_SOCKET  ||  sockets.is_contained(s)  ) {
+		return;
+	}
+#ifdef USE_EPOLL
+	struct epoll_event ev;
+	memset( &ev, 0, sizeof(ev) );
+	ev.events = write ? EPOLLOUT : EPOLLIN;
+	ev.data.fd = s;
+	if(  epoll_ctl( epoll_fd, EPOLL_CTL_ADD, s, &ev ) != 0  &&  errno != EEXIST  ) {
+		dbg->warning( "network_poll_t::add()", "cannot watch socket[%d]: %s", s, strerror(errno) );
+		return;
+	}
+#endif
+	sockets.append( s );
+}
+
+
+void network_poll_t::remove(SOCKET s)
+{
+	if(  !sockets.remove( s )  ) {
+		return;
+	}
+#ifdef USE_EPOLL
+	// a closed socket has already left the set
+	struct epoll_event ev;
+	epoll_ctl( epoll_fd, EPOLL_CTL_DEL, s, &ev );
+#endif
+}
+
+
+void network_poll_t::clear()
+{
+	while(  !sockets.empty()  ) {
+		remove( sockets.back() );
+	}
+}
+
+
+bool network_poll_t::wait(vector_tpl<SOCKET> &ready, int timeout_ms)
+{
+	if(  sockets.empty()  ) {
+		// e.g. nothing to send: do not wait for nothing
+		return false;
+	}
+#ifdef USE_EPOLL
+	struct epoll_event events[MAX_EPOLL_EVENTS];
+	const int action = epoll_wait( epoll_fd, events, MAX_EPOLL_EVENTS, timeout_ms );
+	for(  int i = 0;  i < action;  i++  ) {
+		ready.append( events[i].data.fd );
+	}
+	return action > 0;
+#else
+	fd_set fds;
+	FD_ZERO( &fds );
+	SOCKET s_max = 0;
+	FOR( vector_tpl<SOCKET>, const s, sockets ) {
+		FD_SET( s, &fds );
+		s_max = max( s, s_max );
+	}
+
+	// time out: MAC complains about too long timeouts
+	struct timeval tv;
+	tv.tv_sec = timeout_ms / 1000;
+	tv.tv_usec = (timeout_ms % 1000) * 1000ul;
+
+	const int action = select( s_max + 1, write ? NULL : &fds, write ? &fds : NULL, NULL, &tv );
+	if(  action <= 0  ) {
+		return false;
+	}
+	FOR( vector_tpl<SOCKET>, const s, sockets ) {
+		if(  FD_ISSET( s, &fds )  ) {
+			ready.append( s );
+		}
+	}
+	return true;
+#endif
+}
@@ -0,0 +1,56 @@
+#ifndef _NETWORK_POLL_H_
+#define _NETWORK_POLL_H_
+
+#include "network.h"
+#include "../tpl/vector_tpl.h"
+
+#if defined(__linux__)  &&  !defined(USE_SELECT)
+#define USE_EPOLL
+#include <poll.h>
+#endif
+
+
+/**
+ * A set of sockets to wait for, either until they can be read from
+ * (or accept a connection) or until they can be written to.
+ *
+ * With epoll (on Linux) the kernel keeps the set, so waiting neither
+ * rebuilds it nor is limited by FD_SETSIZE. Elsewhere, or when compiled
+ * with USE_SELECT, select() is used.
+ *
+ * Readiness is level triggered: a socket is reported by every wait() as
+ * long as it is ready, since the callers only read or send one packet
+ * at a time. Sockets must be removed before they are closed.
+ */
+class network_poll_t
+{
+	bool write;
+
+	/// the sockets in the set
+	vector_tpl<SOCKET> sockets;
+
+#ifdef USE_EPOLL
+	int epoll_fd;
+#endif
+
+public:
+	/// @param write true to wait for sockets which can be written to
+	explicit network_poll_t(bool write);
+	~network_poll_t();
+
+	void add(SOCKET s);
+	void remove(SOCKET s);
+	void clear();
+
+	bool is_contained(SOCKET s) const { return sockets.is_contained(s); }
+	uint32 get_count() const { return sockets.get_count(); }
+
+	/**
+	 * Waits at most timeout_ms until some sockets of the set are ready.
+	 * The ready sockets are appended to @p ready.
+	 * @return false on error or timeout
+	 */
+	bool wait(vector_tpl<SOCKET> &ready, int timeout_ms);
+};
+
+#endif
@@ -2,12 +2,32 @@
 #include "network_cmd.h"
 #include "network_cmd_ingame.h"
 #include "network_packet.h"
+#include "network_poll.h"
+
+#if !USE_WINSOCK  &&  !defined(__BEOS__)
+#include <sys/uio.h>
+// several packets are sent by one sendmsg()
+#define USE_VECTORED_SEND
+#define MAX_SEND_BATCH (16)
+#endif
 
 #ifndef NETTOOL
 #include "../dataobj/environment.h"
 #endif
 
 
+/**
+ * the sockets to wait for when receiving (all), and when sending
+ * (only those with something in their send queue)
+ */
+static network_poll_t &get_poll(bool write)
+{
+	static network_poll_t receivers(false);
+	static network_poll_t senders(true);
+	return write ? senders : receivers;
+}
+
+
 bool connection_info_t::operator==(const connection_info_t& other) const
 {
 	return (address.get_ip() == other.address.get_ip())  &&  ( strcmp(nickname.c_str(), other.nickname.c_str())==0 );
@@ -19,10 +39,15 @@ void socket_info_t::reset()
 	delete packet;
 	packet = NULL;
 	while(!send_queue.empty()) {
-		packet_t *p = send_queue.remove_first();
-		delete p;
+		send_queue.remove_first()->release();
 	}
+	send_offset = 0;
 	if (socket != INVALID_SOCKET) {
+		get_poll(false).remove(socket);
+		if (waiting_to_send) {
+			get_poll(true).remove(socket);
+			waiting_to_send = false;
+		}
 		network_close_socket(socket);
 	}
 	if (state != has_left) {
@@ -62,34 +87,85 @@ network_command_t* socket_info_t::receive_nwc()
 void socket_info_t::process_send_queue()
 {
 	while(!send_queue.empty()) {
-		packet_t *p = send_queue.front();
-		p->send(socket, false);
-		if (p->has_failed()) {
+#ifdef USE_VECTORED_SEND
+		// the commands of a step are small, so hand over several at once
+		struct iovec iov[MAX_SEND_BATCH];
+		int n = 0;
+		FOR(slist_tpl<packet_buffer_t *>, const p, send_queue) {
+			const uint16 offset = n == 0 ? send_offset : 0;
+			iov[n].iov_base = const_cast<uint8 *>(p->get_data()) + offset;
+			iov[n].iov_len = p->get_size() - offset;
+			if (++n == MAX_SEND_BATCH) {
+				break;
+			}
+		}
+		struct msghdr msg;
+		memset(&msg, 0, sizeof(msg));
+		msg.msg_iov = iov;
+		msg.msg_iovlen = n;
+		const ssize_t sent = sendmsg(socket, &msg, 0);
+		if (sent <= 0) {
+			const int err = GET_LAST_ERROR();
+			if (sent < 0  &&  (err == EWOULDBLOCK  ||  err == EINTR)) {
+				// continue sending later
+				break;
+			}
+			dbg->warning("socket_info_t::process_send_queue", "error \"%s\" while sending to [%d]", strerror(err), socket);
 			// close this client, clear the send_queue
 			socket_list_t::remove_client(socket);
-			break;
+			return;
 		}
-		else if (p->is_ready()) {
-			// packet complete sent, remove from queue
+		// remove the packets sent completely from the queue
+		size_t left = sent;
+		while (left > 0) {
+			packet_buffer_t *p = send_queue.front();
+			const size_t rest = p->get_size() - send_offset;
+			if (left < rest) {
+				send_offset += (uint16)left;
+				break;
+			}
+			left -= rest;
 			send_queue.remove_first();
-			delete p;
-			// proceed with next packet
+			p->release();
+			send_offset = 0;
 		}
-		else {
+		if (send_offset > 0) {
+			// socket cannot take more at the moment
+			break;
+		}
+#else
+		packet_buffer_t *p = send_queue.front();
+		uint16 sent;
+		if (!network_send_data(socket, (const char *)p->get_data() + send_offset, p->get_size() - send_offset, sent, 0)) {
+			// close this client, clear the send_queue
+			socket_list_t::remove_client(socket);
+			return;
+		}
+		send_offset += sent;
+		if (send_offset < p->get_size()) {
 			break;
 		}
+		// packet complete sent, remove from queue
+		send_queue.remove_first();
+		p->release();
+		send_offset = 0;
+#endif
+	}
+	if (send_queue.empty()  &&  waiting_to_send) {
+		get_poll(true).remove(socket);
+		waiting_to_send = false;
 	}
 }
 
 
-void socket_info_t::send_queue_append(packet_t *p)
+void socket_info_t::send_queue_append(packet_buffer_t *p)
 {
 	if (p) {
-		if (!p->has_failed()) {
-			send_queue.append(p);
-		}
-		else {
-			delete p;
+		p->add_reference();
+		send_queue.append(p);
+		if (!waiting_to_send  &&  socket != INVALID_SOCKET) {
+			get_poll(true).add(socket);
+			waiting_to_send = true;
 		}
 	}
 }
@@ -193,6 +269,7 @@ void socket_list_t::add_client( SOCKET sock, uint32 ip )
 	list[i]->socket = sock;
 	list[i]->address = net_address_t(ip, 0);
 	change_state( i, socket_info_t::connected );
+	get_poll(false).add(sock);
 
 	network_set_socket_nodelay( sock );
 }
@@ -218,6 +295,7 @@ void socket_list_t::add_server( SOCKET sock )
 	}
 	list[i]->socket = sock;
 	change_state(i, socket_info_t::server);
+	get_poll(false).add(sock);
 	if (i==0) {
 #ifndef NETTOOL
 		// set server nickname
@@ -264,6 +342,23 @@ bool socket_list_t::remove_client( SOCKET sock )
 }
 
 
+bool socket_list_t::is_server_socket( SOCKET sock )
+{
+	for(uint32 j=0; j<server_sockets; j++) {
+		if (list[j]->state == socket_info_t::server  &&  list[j]->socket == sock) {
+			return true;
+		}
+	}
+	return false;
+}
+
+
+bool socket_list_t::wait_ready(vector_tpl<SOCKET> &ready, bool write, int timeout_ms)
+{
+	return get_poll(write).wait(ready, timeout_ms);
+}
+
+
 bool socket_list_t::has_client( SOCKET sock )
 {
 	return get_client_id(sock) < list.get_count();
@@ -318,17 +413,24 @@ void socket_list_t::unlock_player_all(uint8 player_nr, bool unlock, uint32 excep
 
 void socket_list_t::send_all(network_command_t* nwc, bool only_playing_clients)
 {
-	if (nwc == NULL) {
+	if (nwc == NULL  ||  nwc->get_packet() == NULL  ||  nwc->get_packet()->has_failed()) {
 		return;
 	}
+	// serialised once, all clients queue the same buffer
+	packet_buffer_t *buffer = NULL;
 	for(uint32 i=server_sockets; i<list.get_count(); i++) {
 		if (list[i]->is_active()  &&  list[i]->socket!=INVALID_SOCKET
 			&&  (!only_playing_clients  ||  list[i]->state == socket_info_t::playing)) {
 
-			packet_t *p = nwc->copy_packet();
-			list[i]->send_queue_append(p);
+			if (buffer == NULL) {
+				buffer = new packet_buffer_t(*nwc->get_packet());
+			}
+			list[i]->send_queue_append(buffer);
 		}
 	}
+	if (buffer) {
+		buffer->release();
+	}
 }
 
 
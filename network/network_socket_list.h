@@ -10,6 +10,7 @@
 
 class network_command_t;
 class packet_t;
+class packet_buffer_t;
 
 
 /**
@@ -42,7 +43,11 @@ public:
 class socket_info_t : public connection_info_t {
 private:
 	packet_t *packet;
-	slist_tpl<packet_t *> send_queue;
+	slist_tpl<packet_buffer_t *> send_queue;
+	// bytes of the first packet of send_queue already sent
+	uint16 send_offset;
+	// the socket is in the set of sockets waited for to send
+	bool waiting_to_send;
 
 
 public:
@@ -58,7 +63,7 @@ public:
 
 	SOCKET socket;
 
-	socket_info_t() : connection_info_t(), packet(0), send_queue(), state(inactive), socket(INVALID_SOCKET), player_unlocked(0) {}
+	socket_info_t() : connection_info_t(), packet(0), send_queue(), send_offset(0), waiting_to_send(false), state(inactive), socket(INVALID_SOCKET), player_unlocked(0) {}
 
 	~socket_info_t();
 
@@ -78,11 +83,13 @@ public:
 	network_command_t* receive_nwc();
 
 	/**
-	 *
+	 * sends as much of the queue as the socket takes without waiting;
+	 * several small packets are handed over at once where possible
 	 */
 	void process_send_queue();
 
-	void send_queue_append(packet_t *p);
+	/// queues the packet, keeping a reference to it
+	void send_queue_append(packet_buffer_t *p);
 
 	/**
 	 * rdwr client information to packet
@@ -146,6 +153,19 @@ public:
 	 */
 	static bool has_client( SOCKET sock );
 
+	/**
+	 * @returns true if sock is one of the sockets accepting connections
+	 */
+	static bool is_server_socket( SOCKET sock );
+
+	/**
+	 * Waits at most timeout_ms until some sockets can be read from (or accept a connection),
+	 * or, if @p write, until sockets with something in their send queue can be written to.
+	 * The ready sockets are appended to @p ready.
+	 * @return false on timeout
+	 */
+	static bool wait_ready(vector_tpl<SOCKET> &ready, bool write, int timeout_ms);
+
 	/**
 	 * @return true if client was found and removed
 	 */
@@ -0,0 +1,213 @@
+/**
+ * This file is part of the Simutrans project under the artistic license.
+ * (see license.txt)
+ *
+ * Load test for network_poll_t: a loopback server echoes messages of many
+ * stand-in clients, like the game server with many clients and spectators.
+ * Do NOT link this into simutrans!  This is a unit test!
+ *
+ * g++ -O2 -o test_network_poll network/test_network_poll.cc
+ * ./test_network_poll [clients] [rounds]
+ * (compile with -DUSE_SELECT for comparing with select(), at most about 1000 clients)
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+
+#include "network_poll.h"
+
+// This is a hack, but it's worth it.  The test needs logging and the poller in order to link.
+#include "../simdebug.cc"
+#include "../utils/dumb-log.cc"
+#include "network_poll.cc"
+
+
+// size of a message; small ones like most game commands
+#define MESSAGE_SIZE (16)
+
+
+static int failures = 0;
+
+#define CHECK(cond) \
+	if(  !(cond)  ) { \
+		fprintf( stderr, "FAILED line %d: %s\n", __LINE__, #cond ); \
+		failures++; \
+	}
+
+
+/// one connection accepted by the server
+struct connection_t
+{
+	SOCKET sock;
+	char buf[MESSAGE_SIZE];
+	int received;
+	int to_send;
+};
+
+
+static SOCKET open_listener(uint16 &port)
+{
+	SOCKET s = socket( AF_INET, SOCK_STREAM, 0 );
+	struct sockaddr_in name;
+	memset( &name, 0, sizeof(name) );
+	name.sin_family = AF_INET;
+	name.sin_port = 0;
+	name.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+	if(  s == INVALID_SOCKET  ||  bind( s, (struct sockaddr *)&name, sizeof(name) ) != 0  ||  listen( s, 1024 ) != 0  ) {
+		fprintf( stderr, "cannot listen on loopback: %s\n", strerror(errno) );
+		exit( 1 );
+	}
+	socklen_t len = sizeof(name);
+	getsockname( s, (struct sockaddr *)&name, &len );
+	port = ntohs( name.sin_port );
+	return s;
+}
+
+
+static SOCKET connect_client(uint16 port)
+{
+	SOCKET s = socket( AF_INET, SOCK_STREAM, 0 );
+	struct sockaddr_in name;
+	memset( &name, 0, sizeof(name) );
+	name.sin_family = AF_INET;
+	name.sin_port = htons( port );
+	name.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+	if(  s == INVALID_SOCKET  ||  connect( s, (struct sockaddr *)&name, sizeof(name) ) != 0  ) {
+		fprintf( stderr, "cannot connect to loopback: %s\n", strerror(errno) );
+		exit( 1 );
+	}
+	return s;
+}
+
+
+int main( int argc, char** argv)
+{
+	const uint32 num_clients = argc > 1 ? atoi(argv[1]) : 500;
+	const uint32 rounds = argc > 2 ? atoi(argv[2]) : 200;
+
+	uint16 port;
+	SOCKET listener = open_listener( port );
+
+	network_poll_t receivers(false);
+	network_poll_t senders(true);
+	receivers.add( listener );
+
+	// the stand-in clients connect; the server accepts them as they become ready
+	vector_tpl<SOCKET> clients( num_clients );
+	vector_tpl<connection_t> connections( num_clients );
+	vector_tpl<SOCKET> ready;
+	while(  connections.get_count() < num_clients  ) {
+		if(  clients.get_count() < num_clients  ) {
+			clients.append( connect_client( port ) );
+		}
+		ready.clear();
+		if(  !receivers.wait( ready, clients.get_count() < num_clients ? 0 : 1000 )  &&  clients.get_count() == num_clients  ) {
+			break;
+		}
+		FOR( vector_tpl<SOCKET>, const s, ready ) {
+			CHECK( s == listener );
+			connection_t c;
+			c.sock = accept( listener, NULL, NULL );
+			c.received = 0;
+			c.to_send = 0;
+			connections.append( c );
+			receivers.add( c.sock );
+		}
+	}
+	CHECK( connections.get_count() == num_clients );
+	CHECK( receivers.get_count() == num_clients + 1 );
+
+	// the connection of each socket
+	vector_tpl<sint32> index_of;
+	FOR( vector_tpl<connection_t>, const& c, connections ) {
+		while(  index_of.get_count() <= (uint32)c.sock  ) {
+			index_of.append( -1 );
+		}
+	}
+	for(  uint32 i = 0;  i < connections.get_count();  i++  ) {
+		index_of[connections[i].sock] = i;
+	}
+
+	const std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+	uint64 waits = 0;
+	for(  uint32 round = 0;  round < rounds;  round++  ) {
+		// every client sends a message ...
+		char msg[MESSAGE_SIZE];
+		for(  uint32 i = 0;  i < num_clients;  i++  ) {
+			memset( msg, 0, sizeof(msg) );
+			sprintf( msg, "%u/%u", round, i );
+			CHECK( send( clients[i], msg, MESSAGE_SIZE, 0 ) == MESSAGE_SIZE );
+		}
+
+		// ... the server echoes all of them ...
+		uint32 echoed = 0;
+		while(  echoed < num_clients  ) {
+			ready.clear();
+			receivers.wait( ready, 0 );
+			senders.wait( ready, 0 );
+			waits++;
+			FOR( vector_tpl<SOCKET>, const s, ready ) {
+				connection_t &c = connections[index_of[s]];
+				if(  c.to_send == 0  ) {
+					const int res = recv( c.sock, c.buf + c.received, MESSAGE_SIZE - c.received, 0 );
+					CHECK( res > 0 );
+					c.received += res;
+					if(  c.received == MESSAGE_SIZE  ) {
+						c.to_send = MESSAGE_SIZE;
+						senders.add( c.sock );
+					}
+				}
+				else if(  senders.is_contained( c.sock )  ) {
+					const int res = send( c.sock, c.buf + MESSAGE_SIZE - c.to_send, c.to_send, 0 );
+					CHECK( res > 0 );
+					c.to_send -= res;
+					if(  c.to_send == 0  ) {
+						c.received = 0;
+						senders.remove( c.sock );
+						echoed++;
+					}
+				}
+			}
+		}
+		CHECK( senders.get_count() == 0 );
+
+		// ... and every client gets its own message back
+		for(  uint32 i = 0;  i < num_clients;  i++  ) {
+			char expected[MESSAGE_SIZE];
+			memset( expected, 0, sizeof(expected) );
+			sprintf( expected, "%u/%u", round, i );
+			int got = 0;
+			while(  got < MESSAGE_SIZE  ) {
+				const int res = recv( clients[i], msg + got, MESSAGE_SIZE - got, 0 );
+				CHECK( res > 0 );
+				if(  res <= 0  ) {
+					break;
+				}
+				got += res;
+			}
+			CHECK( memcmp( msg, expected, MESSAGE_SIZE ) == 0 );
+		}
+	}
+	const double elapsed = std::chrono::duration<double>( std::chrono::high_resolution_clock::now() - start ).count();
+	printf( "%u clients, %u rounds: %.3f s, %.1f us per message, %.1f waits per round\n",
+		num_clients, rounds, elapsed, elapsed * 1000000.0 / ((double)num_clients * rounds), (double)waits / rounds );
+
+	// closed sockets must be removed first
+	FOR( vector_tpl<connection_t>, const& c, connections ) {
+		receivers.remove( c.sock );
+		close( c.sock );
+	}
+	FOR( vector_tpl<SOCKET>, const s, clients ) {
+		close( s );
+	}
+	CHECK( receivers.get_count() == 1 );
+	receivers.clear();
+	CHECK( receivers.get_count() == 0 );
+
+	if(  failures  ) {
+		fprintf( stderr, "%d checks failed\n", failures );
+		return 1;
+	}
+	printf( "All checks passed\n" );
+	return 0;
+}
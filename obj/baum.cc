@@ -219,6 +219,34 @@ uint32 baum_t::create_forest(koord new_center, koord wh )
 }
 
 
+// plants single trees on the empty tiles of some rows; only changes these tiles
+class baum_t::fill_trees_job_t : public karte_t::band_job_t
+{
+	int dichte;
+
+public:
+	explicit fill_trees_job_t(int d) : dichte(d) {}
+
+	void run_rows(sint16 y_min, sint16 y_max) OVERRIDE
+	{
+		koord pos;
+		for(  pos.y=y_min;  pos.y<y_max;  pos.y++  ) {
+			for(  pos.x=0;  pos.x<welt->get_size().x;  pos.x++  ) {
+				grund_t *gr = welt->lookup_kartenboden(pos);
+				if(gr->get_top() == 0  &&  gr->get_typ() == grund_t::boden)  {
+					// plant spare trees, (those with low preffered density) or in an entirely tree climate
+					uint16 cl = 1 << welt->get_climate(pos);
+					settings_t const& s = welt->get_settings();
+					if ((cl & s.get_no_tree_climates()) == 0 && ((cl & s.get_tree_climates()) != 0 || simrand(s.get_forest_inverse_spare_tree_density() * dichte, "baum_t::fill_trees()") < 100)) {
+						plant_tree_on_coordinate(pos, 1, 1);
+					}
+				}
+			}
+		}
+	}
+};
+
+
 void baum_t::fill_trees(int dichte)
 {
 	// none there
@@ -226,20 +254,8 @@ void baum_t::fill_trees(int dichte)
 		return;
 	}
 DBG_MESSAGE("verteile_baeume()","distributing single trees");
-	koord pos;
-	for(  pos.y=0;  pos.y<welt->get_size().y;  pos.y++  ) {
-		for(  pos.x=0;  pos.x<welt->get_size().x;  pos.x++  ) {
-			grund_t *gr = welt->lookup_kartenboden(pos);
-			if(gr->get_top() == 0  &&  gr->get_typ() == grund_t::boden)  {
-				// plant spare trees, (those with low preffered density) or in an entirely tree climate
-				uint16 cl = 1 << welt->get_climate(pos);
-				settings_t const& s = welt->get_settings();
-				if ((cl & s.get_no_tree_climates()) == 0 && ((cl & s.get_tree_climates()) != 0 || simrand(s.get_forest_inverse_spare_tree_density() * dichte, "baum_t::fill_trees()") < 100)) {
-					plant_tree_on_coordinate(pos, 1, 1);
-				}
-			}
-		}
-	}
+	fill_trees_job_t job( dichte );
+	welt->world_band_loop( job );
 }
 
 
@@ -55,6 +55,8 @@ private:
 
 	static uint8 plant_tree_on_coordinate(koord pos, const uint8 maximum_count, const uint8 count);
 
+	class fill_trees_job_t;
+
 public:
 	/**
 	 * Only the load save constructor should be called outside
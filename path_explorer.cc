@@ -197,7 +197,7 @@ void path_explorer_t::rdwr(loadsave_t* file)
 			uint32 tmp_waiting_time;
 			uint32 tmp_transfer_time;
 			uint16 tmp_best_line_idx;
-			uint16 tmp_best_convoy_idx;
+			uint32 tmp_best_convoy_idx;
 			uint16 tmp_alternative_seats;
 			// TODO: Consider whether to add comfort
 
@@ -220,7 +220,7 @@ void path_explorer_t::rdwr(loadsave_t* file)
 				file->rdwr_long(tmp_waiting_time);
 				file->rdwr_long(tmp_transfer_time);
 				file->rdwr_short(tmp_best_line_idx);
-				file->rdwr_short(tmp_best_convoy_idx);
+				convoi_t::rdwr_convoy_id(file, tmp_best_convoy_idx);
 				file->rdwr_short(tmp_alternative_seats);
 			}
 		}
@@ -244,7 +244,7 @@ void path_explorer_t::rdwr(loadsave_t* file)
 				uint32 tmp_waiting_time;
 				uint32 tmp_transfer_time;
 				uint16 tmp_best_line_idx;
-				uint16 tmp_best_convoy_idx;
+				uint32 tmp_best_convoy_idx;
 				uint16 tmp_alternative_seats;
 				// TODO: Consider whether to add comfort
 
@@ -252,7 +252,7 @@ void path_explorer_t::rdwr(loadsave_t* file)
 				file->rdwr_long(tmp_waiting_time);
 				file->rdwr_long(tmp_transfer_time);
 				file->rdwr_short(tmp_best_line_idx);
-				file->rdwr_short(tmp_best_convoy_idx);
+				convoi_t::rdwr_convoy_id(file, tmp_best_convoy_idx);
 				file->rdwr_short(tmp_alternative_seats);
 
 				tmp_cnx->journey_time = tmp_journey_time;
@@ -484,6 +484,7 @@ path_explorer_t::compartment_t::compartment_t()
 
 	working_matrix = NULL;
 	transport_index_map = NULL;
+	transport_index_map_size = 0;
 	transport_matrix = NULL;
 	working_halt_index_map = NULL;
 	working_halt_list = NULL;
@@ -637,6 +638,7 @@ void path_explorer_t::compartment_t::reset(const bool reset_finished_set)
 	{
 		delete[] transport_index_map;
 		transport_index_map = NULL;
+		transport_index_map_size = 0;
 	}
 	if (transport_matrix)
 	{
@@ -868,7 +870,9 @@ void path_explorer_t::compartment_t::step()
 				working_halt_index_map[i] = 65535;
 			}
 
-			transport_index_map = new uint16[131072]();		// initialise all elements to zero
+			// lines first, then lineless convoys
+			transport_index_map_size = 65536u + convoihandle_t::get_size();
+			transport_index_map = new uint16[transport_index_map_size]();		// initialise all elements to zero
 
 			// create a list of schedules of lines and lineless convoys
 			linkages = new vector_tpl<linkage_t>(1024);
@@ -1459,7 +1463,9 @@ void path_explorer_t::compartment_t::step()
 					else if ( current_connexion->best_convoy.is_bound() )
 					{
 						// valid lineless convoy
-						transport_idx = transport_index_map[ 65536u + current_connexion->best_convoy.get_id() ];
+						// convoys created since the map was made are not in it
+						const uint32 map_index = 65536u + current_connexion->best_convoy.get_id();
+						transport_idx = map_index < transport_index_map_size ? transport_index_map[ map_index ] : 0;
 					}
 					else
 					{
@@ -1555,6 +1561,7 @@ void path_explorer_t::compartment_t::step()
 				{
 					delete[] transport_index_map;
 					transport_index_map = NULL;
+					transport_index_map_size = 0;
 				}
 
 				current_phase = phase_explore_paths;	// proceed to the next phase
@@ -2237,14 +2244,31 @@ void path_explorer_t::compartment_t::rdwr(loadsave_t* file)
 
 	if (transport_index_map_live)
 	{
+		// older files have room for 65536 convoys
+		uint32 map_size = transport_index_map_size;
+		if (file->get_extended_version() >= 15 || (file->get_extended_version() == 14 && file->get_extended_revision() >= 14))
+		{
+			file->rdwr_long(map_size);
+		}
+		else
+		{
+			map_size = 131072;
+		}
+
 		if (file->is_loading())
 		{
-			transport_index_map = new uint16[131072]();		// initialise all elements to zero
+			transport_index_map = new uint16[map_size]();		// initialise all elements to zero
+			transport_index_map_size = map_size;
 		}
 
-		for (uint32 i = 0; i < 131072; i++)
+		for (uint32 i = 0; i < map_size; i++)
 		{
-			file->rdwr_short(transport_index_map[i]);
+			uint16 transport_idx = i < transport_index_map_size ? transport_index_map[i] : 0;
+			file->rdwr_short(transport_idx);
+			if (file->is_loading())
+			{
+				transport_index_map[i] = transport_idx;
+			}
 		}
 	}	
 
@@ -2320,7 +2344,7 @@ void path_explorer_t::compartment_t::rdwr(loadsave_t* file)
 			linkages = new vector_tpl<linkage_t>(linkages_count);
 		}
 
-		uint16 cnv_id;
+		uint32 cnv_id;
 		uint16 line_id;
 		for (uint32 i = 0; i < linkages_count; i++)
 		{
@@ -2330,7 +2354,7 @@ void path_explorer_t::compartment_t::rdwr(loadsave_t* file)
 				line_id = linkages->get_element(i).line.get_id();
 			}
 
-			file->rdwr_short(cnv_id);
+			convoi_t::rdwr_convoy_id(file, cnv_id);
 			file->rdwr_short(line_id);
 
 			if(file->is_loading())
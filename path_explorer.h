@@ -250,6 +250,7 @@ private:
 		// set of variables for working path data
 		path_element_t **working_matrix;
 		uint16 *transport_index_map;
+		uint32 transport_index_map_size;
 		transport_element_t **transport_matrix;
 		uint16 *working_halt_index_map;
 		halthandle_t *working_halt_list;
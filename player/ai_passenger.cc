@@ -68,22 +68,29 @@ bool ai_passenger_t::set_active(bool new_state)
 }
 
 
-/* return the hub of a city (always the very first stop) or zero
+/* return the hub of a city (our bus stop with the lowest id) or zero
+ * The choice must not depend on the order of the index, which differs after loading.
  * @author prissi
  */
 halthandle_t ai_passenger_t::get_our_hub( const stadt_t *s ) const
 {
-	FOR(vector_tpl<halthandle_t>, const halt, haltestelle_t::get_alle_haltestellen()) {
+	// the index is keyed by the basis position of the stops
+	vector_tpl<halthandle_t> halts_in_town;
+	welt->get_halt_index().find_in_area( s->get_linksoben(), s->get_rechtsunten(), halts_in_town );
+	halthandle_t hub;
+	FOR(vector_tpl<halthandle_t>, const halt, halts_in_town) {
 		if (halt->get_owner() == sim::up_cast<player_t const*>(this)) {
 			if(  halt->get_pax_enabled()  &&  (halt->get_station_type()&haltestelle_t::busstop)!=0  ) {
 				koord h=halt->get_basis_pos();
 				if(h.x>=s->get_linksoben().x  &&  h.y>=s->get_linksoben().y  &&  h.x<=s->get_rechtsunten().x  &&  h.y<=s->get_rechtsunten().y  ) {
-					return halt;
+					if(  !hub.is_bound()  ||  halt.get_id() < hub.get_id()  ) {
+						hub = halt;
+					}
 				}
 			}
 		}
 	}
-	return halthandle_t();
+	return hub;
 }
 
 
@@ -552,6 +552,15 @@ bool player_t::check_owner( const player_t *owner, const player_t *test )
 }
 
 
+void player_t::set_allow_access_to(uint8 other_player_nr, bool allow)
+{
+	if(  access[other_player_nr] != allow  ) {
+		access[other_player_nr] = allow;
+		haltestelle_t::halts_changed();
+	}
+}
+
+
 void player_t::ai_bankrupt()
 {
 	DBG_MESSAGE("player_t::ai_bankrupt()","Removing convois");
@@ -473,7 +473,8 @@ public:
 	void ai_bankrupt();
 
 	bool allows_access_to(uint8 other_player_nr) const { return player_nr == other_player_nr || access[other_player_nr]; }
-	void set_allow_access_to(uint8 other_player_nr, bool allow) { access[other_player_nr] = allow; }
+	/// Also tells the stops, since haltestelle_t::get_halt() depends on the access rights
+	void set_allow_access_to(uint8 other_player_nr, bool allow);
 
 	void set_selected_signalbox(signalbox_t* sb);
 	signalbox_t* get_selected_signalbox() const { return selected_signalbox; }
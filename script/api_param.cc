@@ -272,7 +272,7 @@ namespace script_api {
 // pointers to classes
 	convoi_t* param<convoi_t*>::get(HSQUIRRELVM vm, SQInteger index)
 	{
-		uint16 id = 0;
+		uint32 id = 0;
 		get_slot(vm, "id", id, index);
 		convoihandle_t cnv;
 		cnv.set_id(id);
@@ -72,10 +72,14 @@
 #endif
 
 #include "tpl/minivec_tpl.h"
+#include "tpl/inthashtable_tpl.h"
 
 // since we use 32 bit per growth steps, we use this variable to take care of the remaining sub citizen growth
 #define CITYGROWTH_PER_CITICEN (0x0000000100000000ll)
 
+// beyond this many changed tiles between two growth steps, the city limits are scanned again instead
+#define MAX_GROWTH_TILES_CHANGED (1024)
+
 karte_ptr_t stadt_t::welt; // one is enough ...
 
 
@@ -1453,6 +1457,7 @@ stadt_t::~stadt_t()
 		check_city_tiles(true);
 	}
 	// avoid the bookkeeping if world gets destroyed
+	planquadrat_t::remove_city(this);
 }
 
 
@@ -1470,7 +1475,9 @@ static bool name_used(weighted_vector_tpl<stadt_t*> const& cities, char const* c
 stadt_t::stadt_t(player_t* player, koord pos, sint32 citizens) :
 	buildings(16),
 	pax_destinations_old(welt->get_size()),
-	pax_destinations_new(welt->get_size())
+	pax_destinations_new(welt->get_size()),
+	growth_candidates_lo(koord::invalid),
+	growth_candidates_ur(koord::invalid)
 {
 	assert(welt->is_within_limits(pos));
 
@@ -1565,7 +1572,9 @@ stadt_t::stadt_t(player_t* player, koord pos, sint32 citizens) :
 stadt_t::stadt_t(loadsave_t* file) :
 	buildings(16),
 	pax_destinations_old(welt->get_size()),
-	pax_destinations_new(welt->get_size())
+	pax_destinations_new(welt->get_size()),
+	growth_candidates_lo(koord::invalid),
+	growth_candidates_ur(koord::invalid)
 {
 
 	//step_count = 0;
@@ -2302,6 +2311,7 @@ void stadt_t::finish_rd()
 
 void stadt_t::rotate90( const sint16 y_size )
 {
+	invalidate_growth_candidates();
 	// rotate town origin
 	pos.rotate90( y_size );
 	townhall_road.rotate90( y_size );
@@ -3242,19 +3252,14 @@ class building_place_with_road_finder: public building_placefinder_t
 		// get distance to next special building
 		int find_dist_next_special(koord pos) const
 		{
-			const weighted_vector_tpl<gebaeude_t*>& attractions = welt->get_ausflugsziele();
-			int dist = welt->get_size().x * welt->get_size().y;
-			FOR(  weighted_vector_tpl<gebaeude_t*>, const i, attractions  ) {
-				int const d = koord_distance(i->get_pos(), pos);
-				if(  d < dist  ) {
-					dist = d;
-				}
+			uint32 dist = welt->get_size().x * welt->get_size().y;
+			const uint32 dist_attraction = welt->get_attraction_index().get_nearest_distance(pos);
+			const uint32 dist_city = welt->get_city_index().get_nearest_distance(pos);
+			if(  dist_attraction < dist  ) {
+				dist = dist_attraction;
 			}
-			FOR(  weighted_vector_tpl<stadt_t *>, const city, welt->get_cities() ) {
-				int const d = koord_distance(city->get_pos(), pos);
-				if(  d < dist  ) {
-					dist = d;
-				}
+			if(  dist_city < dist  ) {
+				dist = dist_city;
 			}
 			return dist;
 		}
@@ -3661,6 +3666,7 @@ void stadt_t::check_bau_townhall(bool new_town)
 		if(  pos!=new_pos  ) {
 			// update position (where the name is)
 			welt->lookup_kartenboden(pos)->set_text( NULL );
+			welt->update_city_index( this, pos, new_pos );
 			pos = new_pos;
 			welt->lookup_kartenboden(pos)->set_text( name );
 		}
@@ -5216,30 +5222,18 @@ void stadt_t::build(bool new_town, bool map_generation)
 	do {
 
 		// firstly, determine all potential candidate coordinates
-		vector_tpl<koord> candidates( (ur.x - lo.x + 1) * (ur.y - lo.y + 1) );
-		for(  sint16 j=lo.y;  j<=ur.y;  ++j  ) {
-			for(  sint16 i=lo.x;  i<=ur.x;  ++i  ) {
-				const koord k(i, j);
-				// do not build on any border tile
-				if(  !welt->is_within_limits( k+koord(1,1) )  ||  k.x<=0  ||  k.y<=0  ) {
-					continue;
-				}
+		update_growth_candidates();
 
-				// checks only make sense on empty ground
-				const grund_t *const gr = welt->lookup_kartenboden(k);
-				if(  gr==NULL  ||  !gr->ist_natur()  ) {
-					continue;
-				}
-
-				// a potential candidate coordinate
-				candidates.append(k);
-			}
-		}
+		// Draw without replacement, as if the drawn entries were swapped to the end of a copy of the list.
+		// Only the few swapped entries are remembered, since most of the time one of the first draws succeeds.
+		inthashtable_tpl<uint32, uint32> swapped;
+		uint32 remaining = growth_candidates.get_count();
 
 		// loop until all candidates are exhausted or until we find a suitable location to build road or city building
-		while(  candidates.get_count()>0  ) {
-			const uint32 idx = simrand( candidates.get_count(), "void stadt_t::build" );
-			const koord k = candidates[idx];
+		while(  remaining>0  ) {
+			const uint32 idx = simrand( remaining, "void stadt_t::build" );
+			const uint32 *const idx_swapped = swapped.access( idx );
+			const koord k = growth_candidates[ idx_swapped ? *idx_swapped : idx ];
 
 			if (maybe_build_road(k, map_generation)) {
 				INT_CHECK("simcity 5095");
@@ -5262,7 +5256,9 @@ void stadt_t::build(bool new_town, bool map_generation)
 				return;
 			}
 
-			candidates.remove_at(idx, false);
+			remaining--;
+			const uint32 *const last_swapped = swapped.access( remaining );
+			swapped.set( idx, last_swapped ? *last_swapped : remaining );
 		}
 		// Oooh.  We tried every candidate location and we couldn't build.
 		// (Admittedly, this may be because percentage-distribution_weight rules told us not to.)
@@ -5279,6 +5275,89 @@ void stadt_t::build(bool new_town, bool map_generation)
 	return;
 }
 
+bool stadt_t::is_growth_candidate(koord k) const
+{
+	// do not build on any border tile
+	if(  !welt->is_within_limits( k+koord(1,1) )  ||  k.x<=0  ||  k.y<=0  ) {
+		return false;
+	}
+	// checks only make sense on empty ground
+	const grund_t *const gr = welt->lookup_kartenboden(k);
+	return gr != NULL  &&  gr->ist_natur();
+}
+
+
+// orders koords like a row-major scan of the city limits
+static bool growth_candidate_order(const koord &a, const koord &b)
+{
+	return a.y < b.y  ||  (a.y == b.y  &&  a.x < b.x);
+}
+
+
+void stadt_t::growth_tile_changed(koord k)
+{
+	if(  growth_candidates_lo != koord::invalid  ) {
+		// only checked on the next growth step, since the tile may still be under construction
+		growth_tiles_changed.put(k);
+		if(  growth_tiles_changed.get_count() > MAX_GROWTH_TILES_CHANGED  ) {
+			invalidate_growth_candidates();
+			growth_tiles_changed.clear();
+		}
+	}
+}
+
+
+void stadt_t::update_growth_candidates()
+{
+	if(  growth_candidates_lo != lo  ||  growth_candidates_ur != ur  ) {
+		// city limits have moved: scan everything
+		growth_candidates.clear();
+		growth_candidates.resize( (ur.x - lo.x + 1) * (ur.y - lo.y + 1) );
+		for(  sint16 j=lo.y;  j<=ur.y;  ++j  ) {
+			for(  sint16 i=lo.x;  i<=ur.x;  ++i  ) {
+				const koord k(i, j);
+				if(  is_growth_candidate(k)  ) {
+					growth_candidates.append(k);
+				}
+			}
+		}
+		growth_candidates_lo = lo;
+		growth_candidates_ur = ur;
+		growth_tiles_changed.clear();
+		return;
+	}
+
+	// otherwise only recheck the tiles which changed since the last step (in any order, each is independent)
+	FOR(tile_set_t, const& iter, growth_tiles_changed) {
+		const koord k = iter.key;
+		if(  k.x < lo.x  ||  k.y < lo.y  ||  k.x > ur.x  ||  k.y > ur.y  ) {
+			continue;
+		}
+		// binary search for the position in scan order
+		uint32 low = 0, high = growth_candidates.get_count();
+		while(  low < high  ) {
+			const uint32 mid = (low + high) / 2;
+			if(  growth_candidate_order( growth_candidates[mid], k )  ) {
+				low = mid + 1;
+			}
+			else {
+				high = mid;
+			}
+		}
+		const bool listed = low < growth_candidates.get_count()  &&  growth_candidates[low] == k;
+		if(  is_growth_candidate(k)  ) {
+			if(  !listed  ) {
+				growth_candidates.insert_at( low, k );
+			}
+		}
+		else if(  listed  ) {
+			growth_candidates.remove_at( low );
+		}
+	}
+	growth_tiles_changed.clear();
+}
+
+
 // find suitable places for cities
 vector_tpl<koord>* stadt_t::random_place(const karte_t* wl, const vector_tpl<sint32> *sizes_list, sint16 old_x, sint16 old_y)
 {
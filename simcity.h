@@ -166,6 +166,15 @@ public:
 
 	void set_private_car_trip(int passengers, stadt_t* destination_town);
 
+	/**
+	 * Called when a tile within the city limits may have changed
+	 * whether the city could grow onto it (ways, stops, ground replaced).
+	 */
+	void growth_tile_changed(koord k);
+
+	/// Forces a rescan of the growth candidates on the next growth step
+	void invalidate_growth_candidates() { growth_candidates_lo = koord::invalid; }
+
 private:
 	static karte_ptr_t welt;
 	player_t *owner;
@@ -183,6 +192,22 @@ private:
 	koord townhall_road;	// road in front of townhall
 	koord lo, ur;			// max size of housing area
 
+	/**
+	 * Tiles within lo..ur on which the city may grow a road or a building,
+	 * in the same row-major order a fresh scan of the city limits yields,
+	 * so that growth picks exactly what a scan would have picked.
+	 * The list is kept up to date from tile change notifications
+	 * (growth_tile_changed) and is only rescanned when the limits move
+	 * or when too many tiles changed between two growth steps.
+	 */
+	vector_tpl<koord> growth_candidates;
+	typedef koordhashtable_tpl<koord, uint8> tile_set_t;
+	tile_set_t growth_tiles_changed;
+	koord growth_candidates_lo, growth_candidates_ur;	// limits of growth_candidates; lo invalid => rescan
+
+	bool is_growth_candidate(koord k) const;
+	void update_growth_candidates();
+
 	bool allow_citygrowth;	// Whether growth is permitted (true by default)
 
 	bool has_townhall;
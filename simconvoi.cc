@@ -69,11 +69,8 @@
 #ifdef MULTI_THREAD
 #include "utils/simthread.h"
 static pthread_mutex_t step_convois_mutex = PTHREAD_MUTEX_INITIALIZER;
-static vector_tpl<pthread_t> unreserve_threads;
 static pthread_attr_t thread_attributes;
 static pthread_mutexattr_t mutex_attributes;
-waytype_t convoi_t::current_waytype = road_wt;
-uint16 convoi_t::current_unreserver = 0;
 #endif
 
 //#if _MSC_VER
@@ -204,6 +201,7 @@ void convoi_t::init(player_t *player)
 	home_depot = koord3d::invalid;
 	last_signal_pos = koord3d::invalid;
 	last_stop_id = 0;
+	revenue_context = NULL;
 
 	yielding_quit_index = -1;
 	lane_affinity = 0;
@@ -289,6 +287,9 @@ DBG_MESSAGE("convoi_t::~convoi_t()", "destroying %d, %p", self.get_id(), this);
 	welt->sync.remove( this );
 	welt->rem_convoi( self );
 
+	// the handle may be reused by a new convoy, which must not inherit any reservations
+	unreserve_route();
+
 	if (!welt->is_destroying())
 	{
 		clear_estimated_times();
@@ -327,9 +328,9 @@ DBG_MESSAGE("convoi_t::~convoi_t()", "destroying %d, %p", self.get_id(), this);
 void convoi_t::close_windows()
 {
 	// close windows
-	destroy_win( magic_convoi_info+self.get_id() );
-	destroy_win( magic_convoi_detail+self.get_id() );
-	destroy_win( magic_replace+self.get_id() );
+	destroy_win( get_window_magic(magic_convoi_info) );
+	destroy_win( get_window_magic(magic_convoi_detail) );
+	destroy_win( get_window_magic(magic_replace) );
 }
 
 // waypoint: no stop, resp. for airplanes in air (i.e. no air strip below)
@@ -351,58 +352,21 @@ bool convoi_t::is_waypoint( koord3d ziel ) const
 	return !haltestelle_t::get_halt(ziel,get_owner()).is_bound();
 }
 
-#ifdef MULTI_THREAD
-
-void convoi_t::unreserve_route_range(route_range_specification range)
-{
-	const vector_tpl<weg_t *> &all_ways = weg_t::get_alle_wege();
-	for (uint32 i = range.start; i <= range.end; i++)
-	{
-		weg_t* const way = all_ways[i];
-		//schiene_t* const sch = obj_cast<schiene_t>(way);
-		schiene_t* const sch = way->is_rail_type() || way->get_waytype() == air_wt ? (schiene_t*)way : NULL;
-		if (sch && sch->get_reserved_convoi().get_id() == convoi_t::current_unreserver)
-		{
-			convoihandle_t ch;
-			ch.set_id(convoi_t::current_unreserver);
-			sch->unreserve(ch);
-		}
-	}
-}
-
-#endif
-
 /**
  * unreserves the whole remaining route
  */
 void convoi_t::unreserve_route()
 {
 	// Clears all reserved tiles on the whole map belonging to this convoy.
-#ifdef MULTI_THREAD_ROUTE_UNRESERVER
-
-	current_unreserver = self.get_id();
-	current_waytype = front()->get_waytype();
-
-	simthread_barrier_wait(&karte_t::unreserve_route_barrier);
-	simthread_barrier_wait(&karte_t::unreserve_route_barrier);
-
-	current_unreserver = 0;
-	current_waytype = invalid_wt;
-
-#else
-	FOR(vector_tpl<weg_t*>, const way, weg_t::get_alle_wege())
-	{
-		if(way->get_waytype() == front()->get_waytype())
-		{
-			//schiene_t* const sch = obj_cast<schiene_t>(way);
-			schiene_t* const sch = way->is_rail_type() ? (schiene_t*)way : NULL;
-			if(sch && sch->get_reserved_convoi() == self)
-			{
-				sch->unreserve(front());
-			}
+	// Each unreserve() removes the tile from reserved_tiles.
+	while(  !reserved_tiles.empty()  ) {
+		schiene_t* const sch = reserved_tiles.back();
+		if(  !sch->unreserve(self)  ) {
+			// should not happen: the tile is reserved by someone else
+			dbg->error("convoi_t::unreserve_route()", "convoi %d lists tile at %s without reserving it", self.get_id(), sch->get_pos().get_str());
+			reserved_tiles.pop_back();
 		}
 	}
-#endif
 
 	set_needs_full_route_flush(false);
 }
@@ -738,8 +702,6 @@ void convoi_t::rotate90( const sint16 y_size )
 	for(  int i=0;  i<vehicle_count;  i++  ) {
 		vehicle[i]->rotate90_freight_destinations( y_size );
 	}
-	// eventually correct freight destinations (and remove all stale freight)
-	check_freight();
 }
 
 
@@ -782,11 +744,11 @@ void convoi_t::set_name(const char *name, bool with_new_id)
 		tstrncpy(name_and_id, buf, lengthof(name_and_id));
 	}
 	// now tell the windows that we were renamed
-	convoi_detail_t *detail = dynamic_cast<convoi_detail_t*>(win_get_magic( magic_convoi_detail+self.get_id()));
+	convoi_detail_t *detail = dynamic_cast<convoi_detail_t*>(win_get_magic( get_window_magic(magic_convoi_detail)));
 	if (detail) {
 		detail->update_data();
 	}
-	convoi_info_t *info = dynamic_cast<convoi_info_t*>(win_get_magic( magic_convoi_info+self.get_id()));
+	convoi_info_t *info = dynamic_cast<convoi_info_t*>(win_get_magic( get_window_magic(magic_convoi_info)));
 	if (info) {
 		info->update_data();
 	}
@@ -3815,8 +3777,8 @@ void convoi_t::reverse_order(bool rev)
 void convoi_t::rdwr_convoihandle_t(loadsave_t *file, convoihandle_t &cnv)
 {
 	if(  file->get_version()>112002  ) {
-		uint16 id = (file->is_saving()  &&  cnv.is_bound()) ? cnv.get_id() : 0;
-		file->rdwr_short( id );
+		uint32 id = (file->is_saving()  &&  cnv.is_bound()) ? cnv.get_id() : 0;
+		rdwr_convoy_id( file, id );
 		if (file->is_loading()) {
 			cnv.set_id( id );
 		}
@@ -3824,6 +3786,36 @@ void convoi_t::rdwr_convoihandle_t(loadsave_t *file, convoihandle_t &cnv)
 }
 
 
+void convoi_t::rdwr_convoy_id(loadsave_t *file, uint32 &id, uint16 since_revision)
+{
+	if(  file->get_extended_version() >= 15  ||  (file->get_extended_version() == 14  &&  file->get_extended_revision() >= since_revision)  ) {
+		file->rdwr_long( id );
+	}
+	else {
+		uint16 short_id = id < 65536 ? (uint16)id : 0;
+		file->rdwr_short( short_id );
+		id = short_id;
+	}
+}
+
+
+ptrdiff_t convoi_t::get_window_magic(ptrdiff_t range) const
+{
+	const uint32 id = self.get_id();
+	if(  id < 65536  ) {
+		return range + id;
+	}
+	// one block of numbers per convoy, after all the other windows
+	static const ptrdiff_t ranges[] = { magic_convoi_info, magic_convoi_detail, magic_convoi_time_history, magic_replace, magic_class_manager };
+	uint32 i = 0;
+	while(  i + 1 < lengthof(ranges)  &&  ranges[i] != range  ) {
+		i++;
+	}
+	assert( ranges[i] == range );
+	return magic_max + (ptrdiff_t)(id - 65536) * (ptrdiff_t)lengthof(ranges) + i;
+}
+
+
 void convoi_t::rdwr(loadsave_t *file)
 {
 	xml_tag_t t( file, "convoi_t" );
@@ -3857,14 +3849,14 @@ void convoi_t::rdwr(loadsave_t *file)
 			self = convoihandle_t( this );
 		}
 		else {
-			uint16 id;
-			file->rdwr_short( id );
+			uint32 id;
+			rdwr_convoy_id( file, id );
 			self = convoihandle_t( this, id );
 		}
 	}
 	else if(  file->get_version()>112002  ) {
-		uint16 id = self.get_id();
-		file->rdwr_short( id );
+		uint32 id = self.get_id();
+		rdwr_convoy_id( file, id );
 	}
 
 	dummy = vehicle_count;
@@ -5014,7 +5006,7 @@ void convoi_t::show_info()
 		if(  env_t::verbose_debug  ) {
 			dump();
 		}
-		create_win( new convoi_info_t(self), w_info, magic_convoi_info+self.get_id() );
+		create_win( new convoi_info_t(self), w_info, get_window_magic(magic_convoi_info) );
 	}
 }
 
@@ -5310,6 +5302,7 @@ void convoi_t::laden() //"load" (Babelfish)
 	{
 		arrival_time = welt->get_ticks();
 		inthashtable_tpl<uint16, sint64> best_times_in_schedule; // Key: halt ID; value: departure time.
+		const schedule_t::stop_table_t &stops = schedule->get_stop_table(front()->get_owner());
 		FOR(departure_map, const& iter, departures)
 		{
 			const sint64 journey_time_ticks = arrival_time - iter.value.departure_time;
@@ -5320,8 +5313,7 @@ void convoi_t::laden() //"load" (Babelfish)
 				departures.clear();
 				break;
 			}
-			const koord3d halt_position = schedule->entries.get_element(iter.key.entry).pos;
-			const halthandle_t departure_halt = haltestelle_t::get_halt(halt_position, front()->get_owner());
+			const halthandle_t departure_halt = stops.get_halt(iter.key.entry);
 			if(departure_halt.is_bound())
 			{
 				if(best_times_in_schedule.is_contained(departure_halt.get_id()))
@@ -5526,21 +5518,64 @@ void convoi_t::laden() //"load" (Babelfish)
 	}
 }
 
-sint64 convoi_t::calc_revenue(const ware_t& ware, array_tpl<sint64> & apportioned_revenues, uint8 g_class)
+void convoi_t::init_revenue_context(revenue_context_t &context) const
+{
+	const grund_t* gr = welt->lookup(front()->get_pos());
+	context.halt = gr ? gr->get_halt() : halthandle_t();
+
+	// the overall average speed of the line, for when there is no point to point timing
+	if(!line.is_bound())
+	{
+		// No line - must use convoy
+		context.fallback_speed = financial_history[1][CONVOI_AVERAGE_SPEED] == 0 ? financial_history[0][CONVOI_AVERAGE_SPEED] : financial_history[1][CONVOI_AVERAGE_SPEED];
+	}
+	else
+	{
+		context.fallback_speed = line->get_finance_history(1, LINE_AVERAGE_SPEED) == 0 ? line->get_finance_history(0, LINE_AVERAGE_SPEED) : line->get_finance_history(1, LINE_AVERAGE_SPEED);
+	}
+	if(context.fallback_speed == 0)
+	{
+		context.fallback_speed = 1;
+	}
+
+	// Comfort takes into account overcrowding, so it is taken as the passengers experienced it
+	// on the journey, not as it changes while the convoy is being unloaded.
+	const uint8 classes = goods_manager_t::passengers->get_number_of_classes();
+	context.comfort.clear();
+	context.comfort.resize(classes);
+	for(uint8 i = 0; i < classes; i++)
+	{
+		context.comfort.append(get_comfort(i));
+	}
+	for(uint8 i = 0; i < goods_manager_t::INDEX_NONE; i++)
+	{
+		context.catering_level[i] = get_catering_level(i);
+	}
+	context.transfers.clear();
+}
+
+
+const convoi_t::transfer_revenue_t &convoi_t::get_transfer_revenue(revenue_context_t &context, halthandle_t last_transfer)
 {
+	if(const transfer_revenue_t *known = context.transfers.access(last_transfer.get_id()))
+	{
+		return *known;
+	}
+
+	transfer_revenue_t tr;
+
 	// Cannot not charge for journey if the journey distance is more than a certain proportion of the straight line distance.
 	// This eliminates the possibility of cheating by building circuitous routes, or the need to prevent that by always using
 	// the straight line distance, which makes the game difficult and unrealistic.
 	// If the origin has been deleted since the packet departed, then the best that we can do is guess by
 	// trebling the distance to the last stop.
-	uint32 max_distance;
-	if(ware.get_last_transfer().is_bound())
+	if(last_transfer.is_bound())
 	{
-		max_distance = shortest_distance(ware.get_last_transfer()->get_basis_pos(), front()->get_pos().get_2d()) * 2;
+		tr.max_distance = shortest_distance(last_transfer->get_basis_pos(), front()->get_pos().get_2d()) * 2;
 	}
 	else
 	{
-		max_distance = shortest_distance(front()->last_stop_pos.get_2d(), front()->get_pos().get_2d()) * 3;
+		tr.max_distance = shortest_distance(front()->last_stop_pos.get_2d(), front()->get_pos().get_2d()) * 3;
 	}
 	// Because the "departures" hashtable now contains not halts but timetable entries, it is necessary to iterate
 	// through the timetable to find the last time that this convoy called at the stop in question.
@@ -5548,62 +5583,52 @@ sint64 convoi_t::calc_revenue(const ware_t& ware, array_tpl<sint64> & apportione
 	uint8 entry = schedule->get_current_stop();
 	bool rev = !reverse_schedule; // Must be negative as going through the schedule backwards: must reverse this when used.
 	const int schedule_count = schedule->is_mirrored() ? schedule->get_count() * 2 : schedule->get_count();
-	departure_data_t dep;
+	const schedule_t::stop_table_t &stops = schedule->get_stop_table(owner);
 	for(int i = 0; i < schedule_count; i++)
 	{
 		schedule->increment_index(&entry, &rev);
-		const uint16 halt_id = haltestelle_t::get_halt(schedule->entries[entry].pos, owner).get_id();
-		if(halt_id == ware.get_last_transfer().get_id())
+		const uint16 halt_id = stops.get_halt(entry).get_id();
+		if(halt_id == last_transfer.get_id())
 		{
-			dep = departures.get(departure_point_t(entry, !rev));
+			tr.dep = departures.get(departure_point_t(entry, !rev));
 			break;
 		}
 	}
 
-	uint32 travel_distance = dep.get_overall_distance();
-	if(travel_distance == 0)
+	tr.travel_distance = tr.dep.get_overall_distance();
+	if(tr.travel_distance == 0)
 	{
 		// Something went wrong, make a wild guess
 		// (This can happen when the departure halt has been deleted
 		// or made inaccessible to this player since departure).
-		travel_distance = max_distance / 2;
+		tr.travel_distance = tr.max_distance / 2;
 	}
-	const uint32 travel_distance_meters = travel_distance * welt->get_settings().get_meters_per_tile();
+	const uint32 travel_distance_meters = tr.travel_distance * welt->get_settings().get_meters_per_tile();
 
-	const uint32 revenue_distance = min(travel_distance, max_distance);
 	// First try to get the journey minutes and average speed
 	// for the point to point trip.  If that fails use line average.
 	// (neroden really believes we should use the minutes and speed for THIS trip.)
 	// (It saves vast amounts of computational effort,
 	//  and gives the player a quicker response to improved service.)
-	sint64 journey_tenths = 0;
-	sint64 average_speed;
+	tr.journey_tenths = 0;
 	bool valid_journey_time = false;
 
-	if(ware.get_last_transfer().is_bound())
+	if(last_transfer.is_bound())
 	{
-		const grund_t* gr = welt->lookup(front()->get_pos());
-		if (gr)
+		id_pair my_ordered_pair = id_pair(last_transfer.get_id(), context.halt.get_id());
+		tr.journey_tenths = get_average_journey_times().get(my_ordered_pair).get_average();
+		if (tr.journey_tenths != 0)
 		{
-			id_pair my_ordered_pair = id_pair(ware.get_last_transfer().get_id(), gr->get_halt().get_id());
-			journey_tenths = get_average_journey_times().get(my_ordered_pair).get_average();
-			if (journey_tenths != 0)
+			// No unreasonably short journeys...
+			const sint64 average_speed = kmh_from_meters_and_tenths(travel_distance_meters, tr.journey_tenths);
+			if(average_speed > speed_to_kmh(get_min_top_speed()))
 			{
-				// No unreasonably short journeys...
-				average_speed = kmh_from_meters_and_tenths(travel_distance_meters, journey_tenths);
-				if(average_speed > speed_to_kmh(get_min_top_speed()))
-				{
-					dbg->warning("sint64 convoi_t::calc_revenue", "Average speed (%i) for %s exceeded maximum speed (%i); falling back to overall average", average_speed, get_name(), speed_to_kmh(get_min_top_speed()));
-				}
-				else
-				{
-					// We seem to have a believable speed...
-					if(average_speed == 0)
-					{
-						average_speed = 1;
-					}
-					valid_journey_time = true;
-				}
+				dbg->warning("sint64 convoi_t::calc_revenue", "Average speed (%i) for %s exceeded maximum speed (%i); falling back to overall average", average_speed, get_name(), speed_to_kmh(get_min_top_speed()));
+			}
+			else
+			{
+				// We seem to have a believable speed...
+				valid_journey_time = true;
 			}
 		}
 	}
@@ -5614,33 +5639,39 @@ sint64 convoi_t::calc_revenue(const ware_t& ware, array_tpl<sint64> & apportione
 		// - if there are no data for point-to-point timings;
 		// - if the point-to-point timings are less than 1/10 of a minute (unreasonably short)
 		// - if the average speed is faster than the top speed of the convoi (absurdity)
-		if(!line.is_bound())
-		{
-			// No line - must use convoy
-			if(financial_history[1][CONVOI_AVERAGE_SPEED] == 0) {
-				average_speed = financial_history[0][CONVOI_AVERAGE_SPEED];
-			}
-			else
-			{
-				average_speed = financial_history[1][CONVOI_AVERAGE_SPEED];
-			}
-		}
-		else
-		{
-			if(line->get_finance_history(1, LINE_AVERAGE_SPEED) == 0) {
-				average_speed = line->get_finance_history(0, LINE_AVERAGE_SPEED);
-			}
-			else
-			{
-				average_speed = line->get_finance_history(1, LINE_AVERAGE_SPEED);
-			}
-		}
-		if(average_speed == 0)
+		tr.journey_tenths = tenths_from_meters_and_kmh(travel_distance_meters, context.fallback_speed);
+	}
+
+	tr.total_way_distance = 0;
+	for(uint8 i = 0; i < MAX_PLAYER_COUNT + 2; i ++)
+	{
+		if (i == MAX_PLAYER_COUNT)
 		{
-			average_speed = 1;
+			// MAX_PLAYER_COUNT as an index is used for the overall distance - in a different unit.
+			continue;
 		}
-		journey_tenths = tenths_from_meters_and_kmh(travel_distance_meters, average_speed);
+		tr.total_way_distance += tr.dep.get_way_distance(i);
+	}
+
+	context.transfers.put(last_transfer.get_id(), tr);
+	return *context.transfers.access(last_transfer.get_id());
+}
+
+
+sint64 convoi_t::calc_revenue(const ware_t& ware, array_tpl<sint64> & apportioned_revenues, uint8 g_class)
+{
+	revenue_context_t local_context;
+	if(revenue_context == NULL)
+	{
+		init_revenue_context(local_context);
 	}
+	revenue_context_t &context = revenue_context ? *revenue_context : local_context;
+
+	const transfer_revenue_t &tr = get_transfer_revenue(context, ware.get_last_transfer());
+	const departure_data_t &dep = tr.dep;
+
+	const uint32 revenue_distance = min(tr.travel_distance, tr.max_distance);
+	const sint64 journey_tenths = tr.journey_tenths;
 
 	sint64 starting_distance;
 	if (ware.get_origin().is_bound())
@@ -5663,16 +5694,17 @@ sint64 convoi_t::calc_revenue(const ware_t& ware, array_tpl<sint64> & apportione
 	const uint32 starting_distance_meters = starting_distance * welt->get_settings().get_meters_per_tile();
 
 	const goods_desc_t* goods = ware.get_desc();
+	const uint8 catg_index = goods->get_catg_index();
 
 	sint64 fare;
 	if (ware.is_passenger())
 	{
 		// First get our comfort.
 		// Note: This takes into account overcrowding.
-		const uint8 comfort = get_comfort(g_class);
+		const uint8 comfort = g_class < context.comfort.get_count() ? context.comfort[g_class] : get_comfort(g_class);
 
 		// Now, get our catering level.
-		const uint8 catering_level = get_catering_level(goods->get_catg_index());
+		const uint8 catering_level = catg_index < goods_manager_t::INDEX_NONE ? context.catering_level[catg_index] : get_catering_level(catg_index);
 
 		// Finally, get the fare.
 		fare = goods->get_total_fare(revenue_distance_meters, starting_distance_meters, comfort, catering_level, g_class, journey_tenths);
@@ -5680,7 +5712,7 @@ sint64 convoi_t::calc_revenue(const ware_t& ware, array_tpl<sint64> & apportione
 	else if(ware.is_mail())
 	{
 		// Get our "TPO" level.
-		const uint8 catering_level = get_catering_level(goods->get_catg_index());
+		const uint8 catering_level = catg_index < goods_manager_t::INDEX_NONE ? context.catering_level[catg_index] : get_catering_level(catg_index);
 		// Finally, get the fare.
 		fare = goods->get_total_fare(revenue_distance_meters, starting_distance_meters, 0u, catering_level, g_class, journey_tenths);
 	}
@@ -5697,18 +5729,6 @@ sint64 convoi_t::calc_revenue(const ware_t& ware, array_tpl<sint64> & apportione
 
 	// Now apportion the revenue.
 
-
-	uint32 total_way_distance = 0;
-	for(uint8 i = 0; i < MAX_PLAYER_COUNT + 2; i ++)
-	{
-		if (i == MAX_PLAYER_COUNT)
-		{
-			// MAX_PLAYER_COUNT as an index is used for the overall distance - in a different unit.
-			continue;
-		}
-		total_way_distance += dep.get_way_distance(i);
-	}
-
 	// The apportioned revenue array is passed in. It should be the right size already.
 	// Make sure our returned array is the right size (should do nothing)
 	apportioned_revenues.resize(MAX_PLAYER_COUNT);
@@ -5728,7 +5748,7 @@ sint64 convoi_t::calc_revenue(const ware_t& ware, array_tpl<sint64> & apportione
 		if(player_way_distance > 0)
 		{
 			// We allocate even for players who may not exist; we'll check before paying them.
-			apportioned_revenues[i] += (revenue * player_way_distance) / total_way_distance;
+			apportioned_revenues[i] += (revenue * player_way_distance) / tr.total_way_distance;
 		}
 	}
 
@@ -5835,7 +5855,19 @@ station_tile_search_ready: ;
 	// Initialize it to the correct size and blank out all entries
 	// It will be added to by the load_cargo method for each vehicle
 	array_tpl<sint64> apportioned_revenues (MAX_PLAYER_COUNT, 0);
-	uint8 convoy_length = 0;
+
+	// The fare parameters are worked out once for all packets,
+	// and the revenue is booked once per type of cargo.
+	revenue_context_t context;
+	const bool unloading = old_last_stop_pos != front()->get_pos();
+	if(unloading)
+	{
+		init_revenue_context(context);
+		revenue_context = &context;
+	}
+	typedef inthashtable_tpl<uint8, sint64> revenue_map_t;
+	revenue_map_t revenue_by_cargo_type;
+
 	for(int i = 0; i < vehicles_loading ; i++)
 	{
 		vehicle_t* v = vehicle[i];
@@ -5852,7 +5884,7 @@ station_tile_search_ready: ;
 		}
 		// hat_gehalten can be called when the convoy hasn't moved... at all.
 		// We should avoid the unloading code when this happens (for speed).
-		if(old_last_stop_pos != front()->get_pos())
+		if(unloading)
 		{
 			//Unload
 			sint64 revenue_from_unloading = 0;
@@ -5866,15 +5898,23 @@ station_tile_search_ready: ;
 				// if we unloaded something, provide some minimum revenue.  But not if we unloaded nothing.
 				revenue_cents_from_unloading = 1;
 			}
-			// This call needs to be here, per-vehicle, in order to record different freight types properly.
-			owner->book_revenue( revenue_cents_from_unloading, front()->get_pos().get_2d(), get_schedule()->get_waytype(), v->get_cargo_type()->get_index() );
-			// The finance code will add up the on-screen messages
+			// The revenue is recorded per freight type.
+			const uint8 cargo_type = v->get_cargo_type()->get_index();
+			revenue_by_cargo_type.set(cargo_type, revenue_by_cargo_type.get(cargo_type) + revenue_cents_from_unloading);
 			// But add up the total for the port and station use charges
 			accumulated_revenue += revenue_cents_from_unloading;
-			book(revenue_cents_from_unloading, CONVOI_PROFIT);
-			book(revenue_cents_from_unloading, CONVOI_REVENUE);
 		}
 	}
+	revenue_context = NULL;
+	if(unloading)
+	{
+		FOR(revenue_map_t, const& iter, revenue_by_cargo_type)
+		{
+			owner->book_revenue( iter.value, front()->get_pos().get_2d(), get_schedule()->get_waytype(), iter.key );
+		}
+		book(accumulated_revenue, CONVOI_PROFIT);
+		book(accumulated_revenue, CONVOI_REVENUE);
+	}
 	if(no_load)
 	{
 		for(int i = 0; i < vehicles_loading ; i++)
@@ -5918,6 +5958,11 @@ station_tile_search_ready: ;
 			{
 				vehicle_t* v = vehicle[i];
 				const uint8 catg_index = v->get_cargo_type()->get_catg_index();
+				if(j > 0  &&  !overcrowd  &&  v->get_total_cargo() >= v->get_desc()->get_total_capacity())
+				{
+					// Full already in the first pass, which also updated its weight: nothing would change.
+					continue;
+				}
 				if(!skip_catg[catg_index])
 				{
 					bool skip_convois = false;
@@ -6624,9 +6669,10 @@ void convoi_t::register_stops()
 {
 	if(schedule)
 	{
-		FOR(minivec_tpl<schedule_entry_t>, const &i, schedule->entries)
+		const schedule_t::stop_table_t &stops = schedule->get_stop_table(get_owner());
+		for(uint8 i = 0; i < schedule->get_count(); i++)
 		{
-			halthandle_t const halt = haltestelle_t::get_halt(i.pos, get_owner());
+			halthandle_t const halt = stops.get_halt(i);
 			if(halt.is_bound())
 			{
 				halt->add_convoy(self);
@@ -6643,8 +6689,9 @@ void convoi_t::register_stops()
 void convoi_t::unregister_stops()
 {
 	if(  schedule  ) {
-		FOR(minivec_tpl<schedule_entry_t>, const& i, schedule->entries) {
-			halthandle_t const halt = haltestelle_t::get_halt(i.pos, get_owner());
+		const schedule_t::stop_table_t &stops = schedule->get_stop_table(get_owner());
+		for(  uint8 i = 0;  i < schedule->get_count();  i++  ) {
+			halthandle_t const halt = stops.get_halt(i);
 			if(  halt.is_bound()  ) {
 				halt->remove_convoy(self);
 			}
@@ -7837,7 +7884,7 @@ void convoi_t::clear_replace()
 			eta = etd;
 			eta += journey_time_ticks;
 			etd += journey_time_ticks;
-			halt = haltestelle_t::get_halt(schedule->entries[schedule_entry].pos, owner);
+			halt = schedule->get_stop_table(owner).get_halt(schedule_entry);
 
 			if(halt.is_bound() && !halts_already_processed.is_contained(halt.get_id()))
 			{
@@ -7858,7 +7905,7 @@ void convoi_t::clear_replace()
 					// This may not be the next convoy on this line to depart from this forthcoming stop, so the spacing may have to be multiplied. 
 					FOR(const haltestelle_t::arrival_times_map, const& iter, halt->get_estimated_convoy_departure_times())
 					{
-						const uint16 id = iter.key;
+						const uint32 id = iter.key;
 						convoihandle_t tmp_cnv;
 						tmp_cnv.set_id(id); 
 						if(tmp_cnv.is_bound() && tmp_cnv->get_line() == get_line())
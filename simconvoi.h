@@ -39,6 +39,7 @@
 #define MAX_MONTHS               12 // Max history
 
 class weg_t;
+class schiene_t;
 class depot_t;
 class karte_ptr_t;
 class player_t;
@@ -56,14 +57,6 @@ class departure_point_t;
 */
 typedef koordhashtable_tpl<id_pair, average_tpl<uint32> > journey_times_map;
 
-#ifdef MULTI_THREAD
-struct route_range_specification
-{
-	uint32 start;
-	uint32 end;
-};
-#endif
-
 /**
  * Base class for all vehicle consists. Convoys can be referenced by handles, see halthandle_t.
  *
@@ -264,6 +257,12 @@ private:
 	*/
 	route_t route;
 
+	/**
+	 * All tiles reserved by this convoy, so that unreserve_route()
+	 * need not look at every way on the map.
+	 */
+	vector_tpl<schiene_t *> reserved_tiles;
+
 	/**
 	* assigned line
 	* @author hsiegeln
@@ -846,20 +845,17 @@ public:
 	*/
 	void hat_gehalten(halthandle_t halt);
 
-#ifdef MULTI_THREAD
-private:
-	static void unreserve_route_range(route_range_specification range);
-	friend void *unreserve_route_threaded(void* args);
-	static waytype_t current_waytype;
-	static uint16 current_unreserver;
-public:
-#endif
-
 	/**
 	 * remove all track reservations (trains only)
 	 */
 	void unreserve_route();
 
+	/**
+	 * The tiles currently reserved by this convoy, in no particular order.
+	 * Kept up to date by schiene_t whenever a reservation changes hands.
+	 */
+	vector_tpl<schiene_t *> &access_reserved_tiles() { return reserved_tiles; }
+
 
 	route_t* get_route() { return &route; }
 	route_t* access_route() { return &route; }
@@ -987,8 +983,24 @@ public:
 	 */
 	static void rdwr_convoihandle_t(loadsave_t *file, convoihandle_t &cnv);
 
+	/**
+	 * Loads or saves a convoy id: 32 bit from savegame version 14.@p since_revision on, 16 bit before.
+	 * The reservations of ways were widened one revision after the convoys themselves.
+	 */
+	static void rdwr_convoy_id(loadsave_t *file, uint32 &id, uint16 since_revision = 14);
+
+	/**
+	 * The magic number of a window of this convoy, @p range being magic_convoi_info etc.
+	 * Each range has room for 65536 convoys; the windows of the convoys beyond get numbers above magic_max.
+	 */
+	ptrdiff_t get_window_magic(ptrdiff_t range) const;
+
 	void finish_rd();
 
+	/**
+	 * Only changes the convoy itself, so that all convoys can be rotated at the same time.
+	 * check_freight() must be called afterwards.
+	 */
 	void rotate90( const sint16 y_size );
 
 	/**
@@ -1546,6 +1558,43 @@ public:
 	 */
 	sint64 calc_revenue(const ware_t &ware, array_tpl<sint64> & apportioned_revenues, uint8 g_class);
 
+	/**
+	 * The part of calc_revenue() which is the same for all packets
+	 * coming from the same last transfer stop.
+	 */
+	struct transfer_revenue_t
+	{
+		departure_data_t dep;
+		uint32 max_distance;
+		uint32 travel_distance;
+		sint64 journey_tenths;
+		uint32 total_way_distance;
+	};
+
+	/**
+	 * The fare parameters while a convoy unloads at a stop, worked out
+	 * once on arrival rather than again for every packet: the comfort
+	 * and catering as the convoy arrived, and the departures by last
+	 * transfer stop (found when first needed).
+	 */
+	struct revenue_context_t
+	{
+		halthandle_t halt;        // the stop at the front vehicle, if any
+		sint64 fallback_speed;    // average speed of the line or convoy
+		vector_tpl<uint8> comfort; // by class of the passengers
+		uint8 catering_level[goods_manager_t::INDEX_NONE]; // of passengers and mail
+		inthashtable_tpl<uint16, transfer_revenue_t> transfers; // by id of the last transfer stop
+	};
+
+private:
+	/// set by hat_gehalten() while unloading, see calc_revenue()
+	revenue_context_t *revenue_context;
+
+	void init_revenue_context(revenue_context_t &context) const;
+	const transfer_revenue_t &get_transfer_revenue(revenue_context_t &context, halthandle_t last_transfer);
+
+public:
+
 	uint16 get_livery_scheme_index() const;
 	void set_livery_scheme_index(uint16 value) { livery_scheme_index = value; }
 
@@ -77,6 +77,8 @@ vector_tpl<lines_loaded_t> haltestelle_t::lines_loaded;
 uint8 haltestelle_t::pedestrian_limit = 0;
 // hash table only used during loading
 inthashtable_tpl<sint32,halthandle_t> *haltestelle_t::all_koords = NULL;
+
+uint32 haltestelle_t::halt_changes = 0;
 // since size_x*size_y < 0x1000000, we have just to shift the high bits
 #define get_halt_key(k,width) ( ((k).x*(width)+(k).y) /*+ ((k).z << 25)*/ )
 
@@ -471,6 +473,7 @@ haltestelle_t::haltestelle_t(koord k, player_t* player)
 	last_loading_step = welt->get_steps();
 
 	this->init_pos = k;
+	welt->update_halt_index(self, koord::invalid, k);
 	owner = player;
 
 	enables = NOT_ENABLED;
@@ -548,6 +551,7 @@ haltestelle_t::~haltestelle_t()
 	assert(self.is_bound());
 
 	// first: remove halt from all lists
+	welt->update_halt_index(self, init_pos, koord::invalid);
 	int i=0;
 	while(alle_haltestellen.remove(self)) {
 		i++;
@@ -621,17 +625,10 @@ haltestelle_t::~haltestelle_t()
 				if(plan->get_haltlist_count()>0) {
 					plan->remove_from_haltlist(self);
 				}
-				const grund_t* gr = plan->get_kartenboden();
-				// If there's a factory here, add it to the working list
-				const gebaeude_t* gb = gr->find<gebaeude_t>();
-				if (gb) {
-					fabrik_t* fab = gb->get_fabrik();
-					if (fab && !affected_fab_list.is_contained(fab) ) {
-						affected_fab_list.append(fab);
-					}
-				}
 			}
 		}
+		// factories which were in reach need their halt lists updated
+		welt->get_factories_in_area(ul, lr - koord(1, 1), affected_fab_list);
 
 		// Update nearby factories' lists of connected halts.
 		// Must be done AFTER updating the planquadrats
@@ -691,6 +688,13 @@ haltestelle_t::~haltestelle_t()
 }
 
 
+void haltestelle_t::set_init_pos(koord k)
+{
+	welt->update_halt_index(self, init_pos, k);
+	init_pos = k;
+}
+
+
 void haltestelle_t::rotate90( const sint16 y_size )
 {
 	init_pos.rotate90( y_size );
@@ -2380,14 +2384,19 @@ bool haltestelle_t::fetch_goods(slist_tpl<ware_t> &load, const goods_desc_t *goo
 			}
 		}
 
-		halthandle_t cached_halts[256];
-
+		const schedule_t::stop_table_t &stops = schedule->get_stop_table(player);
+		// if the convoy is here as planned, goods for stops it does not reach from here are skipped at once
+		const bool use_reachable = !schedule->empty() && stops.get_halt(schedule->get_current_stop()) == self;
 
 		while(!goods_to_check.empty())
 		{
 			ware_t* const next_to_load = goods_to_check.pop();
 			uint8 index = schedule->get_current_stop();
 			bool reverse = cnv->get_reverse_schedule();
+			if(use_reachable && !stops.is_reachable_after(index, reverse, next_to_load->get_zwischenziel()) && !stops.is_reachable_after(index, reverse, next_to_load->get_ziel()))
+			{
+				continue;
+			}
 			if(cnv->get_state() != convoi_t::REVERSING)
 			{
 				schedule->increment_index(&index, &reverse);
@@ -2396,11 +2405,7 @@ bool haltestelle_t::fetch_goods(slist_tpl<ware_t> &load, const goods_desc_t *goo
 			int count = 0;
 			while(index != schedule->get_current_stop() || (cnv->get_state() == convoi_t::REVERSING && count == 0))
 			{
-				halthandle_t& schedule_halt = cached_halts[index];
-				if(schedule_halt.is_null())
-				{
-					schedule_halt = haltestelle_t::get_halt(schedule->entries[index].pos, player);
-				}
+				const halthandle_t schedule_halt = stops.get_halt(index);
 
 				if(schedule_halt == self)
 				{
@@ -2508,11 +2513,14 @@ bool haltestelle_t::fetch_goods(slist_tpl<ware_t> &load, const goods_desc_t *goo
 							uint8 fast_index = fast_schedule->get_current_stop();
 							bool fast_reverse = fast_convoy->get_reverse_schedule();
 							const player_t* player = cnv->get_owner();
+							// The stop table is kept for the owner of the schedule only: look up the stops
+							// of another player's schedule directly rather than rebuilding its table.
+							const schedule_t::stop_table_t *fast_stops = fast_convoy->get_owner() == player ? &fast_schedule->get_stop_table(player) : NULL;
 							halthandle_t fast_convoy_halt;
 
 							for(int i = 0; i < fast_schedule->get_count() * 2; i ++)
 							{
-								fast_convoy_halt = haltestelle_t::get_halt(fast_schedule->entries[fast_index].pos, player);
+								fast_convoy_halt = fast_stops ? fast_stops->get_halt(fast_index) : haltestelle_t::get_halt(fast_schedule->entries[fast_index].pos, player);
 								if(fast_convoy_halt == self)
 								{
 									if(fast_index == check_index && fast_reverse == check_reverse)
@@ -2728,6 +2736,7 @@ void haltestelle_t::update_alternative_seats(convoihandle_t cnv)
 			const schedule_t *schedule = (*cnv_i)->get_schedule();
 			const player_t *player = (*cnv_i)->get_owner();
 			const uint8 count = schedule->get_count();
+			const schedule_t::stop_table_t &stops = schedule->get_stop_table(player);
 
 			// uses schedule->increment_index to iterate over stops
 			uint8 index = schedule->get_current_stop();
@@ -2736,7 +2745,7 @@ void haltestelle_t::update_alternative_seats(convoihandle_t cnv)
 
 			while (index != schedule->get_current_stop()) 
 			{
-				const halthandle_t plan_halt = haltestelle_t::get_halt(schedule->entries[index].pos, player);
+				const halthandle_t plan_halt = stops.get_halt(index);
 				if (plan_halt == self)
 				{
 					// we will come later here again ...
@@ -3463,6 +3472,7 @@ bool haltestelle_t::make_public_and_join(player_t *player)
 		}
 		// transfer ownership
 		owner = public_owner;
+		halts_changed();
 	}
 
 	// set name to name of first public stop
@@ -4297,7 +4307,7 @@ void haltestelle_t::rdwr(loadsave_t *file)
 	if(file->get_extended_version() >= 12)
 	{
 		// Load/save the estimated arrival and departure times.
-		uint16 convoy_id;
+		uint32 convoy_id;
 		sint64 time;
 
 		if(file->is_saving())
@@ -4313,7 +4323,7 @@ void haltestelle_t::rdwr(loadsave_t *file)
 			{
 				convoy_id = iter.key;
 				time = iter.value;
-				file->rdwr_short(convoy_id);
+				convoi_t::rdwr_convoy_id(file, convoy_id);
 				file->rdwr_longlong(time);
 			}
 
@@ -4321,7 +4331,7 @@ void haltestelle_t::rdwr(loadsave_t *file)
 			{
 				convoy_id = iter.key;
 				time = iter.value;
-				file->rdwr_short(convoy_id);
+				convoi_t::rdwr_convoy_id(file, convoy_id);
 				file->rdwr_longlong(time);
 			}
 		}
@@ -4339,14 +4349,14 @@ void haltestelle_t::rdwr(loadsave_t *file)
 
 			for(int i = 0; i < arrival_count; i++)
 			{
-				file->rdwr_short(convoy_id);
+				convoi_t::rdwr_convoy_id(file, convoy_id);
 				file->rdwr_longlong(time);
 				estimated_convoy_arrival_times.put(convoy_id, time);
 			}
 
 			for(int i = 0; i < departure_count; i++)
 			{
-				file->rdwr_short(convoy_id);
+				convoi_t::rdwr_convoy_id(file, convoy_id);
 				file->rdwr_longlong(time);
 				estimated_convoy_departure_times.put(convoy_id, time);
 			}
@@ -4500,7 +4510,7 @@ void haltestelle_t::rdwr(loadsave_t *file)
 		uint32 tmp_waiting_time;
 		uint32 tmp_transfer_time;
 		uint16 tmp_best_line_idx;
-		uint16 tmp_best_convoy_idx;
+		uint32 tmp_best_convoy_idx;
 		uint16 tmp_alternative_seats;
 		// TODO: Consider whether to add comfort
 
@@ -4533,7 +4543,7 @@ void haltestelle_t::rdwr(loadsave_t *file)
 							file->rdwr_long(tmp_journey_time);
 							file->rdwr_long(tmp_waiting_time);
 							file->rdwr_long(tmp_transfer_time);
-							file->rdwr_short(tmp_best_convoy_idx);
+							convoi_t::rdwr_convoy_id(file, tmp_best_convoy_idx);
 							file->rdwr_short(tmp_best_line_idx);
 							file->rdwr_short(tmp_alternative_seats);
 						}
@@ -4551,7 +4561,7 @@ void haltestelle_t::rdwr(loadsave_t *file)
 							file->rdwr_long(tmp_journey_time);
 							file->rdwr_long(tmp_waiting_time);
 							file->rdwr_long(tmp_transfer_time);
-							file->rdwr_short(tmp_best_convoy_idx);
+							convoi_t::rdwr_convoy_id(file, tmp_best_convoy_idx);
 							file->rdwr_short(tmp_best_line_idx);
 							file->rdwr_short(tmp_alternative_seats);
 							
@@ -4674,7 +4684,7 @@ void haltestelle_t::finish_rd(bool need_recheck_for_walking_distance)
 	}
 
 	convoihandle_t convoy;
-	slist_tpl<uint16> dead_convoys;
+	slist_tpl<uint32> dead_convoys;
 	FOR(arrival_times_map, const& iter, estimated_convoy_departure_times)
 	{
 		convoy.set_id(iter.key);
@@ -4730,7 +4740,7 @@ void haltestelle_t::finish_rd(bool need_recheck_for_walking_distance)
 		}
 	}
 
-	FOR(slist_tpl<uint16>, const &iter, dead_convoys)
+	FOR(slist_tpl<uint32>, const &iter, dead_convoys)
 	{
 		clear_estimated_timings(iter);
 	}
@@ -4968,6 +4978,10 @@ bool haltestelle_t::add_grund(grund_t *gr, bool relink_factories, bool recalc_ne
 	add_to_station_type( gr );
 	gr->set_halt( self );
 	tiles.append( gr );
+	if(  tiles.get_count() == 1  &&  init_pos != pos  ) {
+		// keep the spatial index at the basis position
+		set_init_pos( pos );
+	}
 
 	// add to hashtable
 	if (all_koords) {
@@ -4977,7 +4991,6 @@ bool haltestelle_t::add_grund(grund_t *gr, bool relink_factories, bool recalc_ne
 
 	// appends this to the ground
 	// after that, the surrounding ground will know of this station
-	vector_tpl<fabrik_t*> affected_fab_list;
 	uint16 cov;
 	if (get_pax_enabled() || get_mail_enabled()) {
 		cov = welt->get_settings().get_station_coverage();
@@ -4997,16 +5010,7 @@ bool haltestelle_t::add_grund(grund_t *gr, bool relink_factories, bool recalc_ne
 				{
 					plan->add_to_haltlist(self);
 				}
-				grund_t* gr = plan->get_kartenboden();
-				gr->set_flag(grund_t::dirty);
-				// If there's a factory here, add it to the working list
-				const gebaeude_t* gb = gr->find<gebaeude_t>();
-				if (gb) {
-					fabrik_t* fab = gb->get_fabrik();
-					if (fab && !affected_fab_list.is_contained(fab) ) {
-						affected_fab_list.append(fab);
-					}
-				}
+				plan->get_kartenboden()->set_flag(grund_t::dirty);
 			}
 		}
 	}
@@ -5087,7 +5091,7 @@ bool haltestelle_t::add_grund(grund_t *gr, bool relink_factories, bool recalc_ne
 	assert(gr->get_halt() == self);
 	assert(gr->is_halt());
 
-	init_pos = tiles.front().grund->get_pos().get_2d();
+	set_init_pos( tiles.front().grund->get_pos().get_2d() );
 	if (recalc_nearby_halts)
 	{
 		check_nearby_halts();
@@ -5135,7 +5139,7 @@ bool haltestelle_t::rem_grund(grund_t *gr)
 	world()->await_path_explorer();
 #endif
 	path_explorer_t::refresh_all_categories(false);
-	init_pos = tiles.empty() ? koord::invalid : tiles.front().grund->get_pos().get_2d();
+	set_init_pos( tiles.empty() ? koord::invalid : tiles.front().grund->get_pos().get_2d() );
 
 	// re-add name
 	if (station_name_to_transfer != NULL  &&  !tiles.empty()) {
@@ -5176,18 +5180,12 @@ bool haltestelle_t::rem_grund(grund_t *gr)
 					// (::remove_from_haltlist double-checks this)
 					nearby_plan->remove_from_haltlist(self);
 					nearby_plan->get_kartenboden()->set_flag(grund_t::dirty);
-					const grund_t* nearby_ground = nearby_plan->get_kartenboden();
-					// If there's a factory here, add it to the working list
-					const gebaeude_t* nearby_building = nearby_ground->find<gebaeude_t>();
-					if (nearby_building) {
-						fabrik_t* nearby_fab = nearby_building->get_fabrik();
-						if (nearby_fab && !affected_fab_list.is_contained(nearby_fab) ) {
-							affected_fab_list.append(nearby_fab);
-						}
-					}
 				}
 			}
 		}
+		// factories which were in reach need their halt lists updated
+		const koord k = gr->get_pos().get_2d();
+		welt->get_factories_in_area(k - koord(cov, cov), k + koord(cov, cov), affected_fab_list);
 
 
 		// Update nearby factories' lists of connected halts.
@@ -5736,18 +5734,18 @@ void haltestelle_t::add_waiting_time(uint32 time, halthandle_t halt, uint8 categ
 	}
 }
 
-void haltestelle_t::set_estimated_arrival_time(uint16 convoy_id, sint64 time)
+void haltestelle_t::set_estimated_arrival_time(uint32 convoy_id, sint64 time)
 {
 	estimated_convoy_arrival_times.set(convoy_id, time);
 }
 
 
-void haltestelle_t::set_estimated_departure_time(uint16 convoy_id, sint64 time)
+void haltestelle_t::set_estimated_departure_time(uint32 convoy_id, sint64 time)
 {
 	estimated_convoy_departure_times.set(convoy_id, time);
 }
 
-void haltestelle_t::clear_estimated_timings(uint16 convoy_id)
+void haltestelle_t::clear_estimated_timings(uint32 convoy_id)
 {
 	estimated_convoy_arrival_times.remove(convoy_id);
 	estimated_convoy_departure_times.remove(convoy_id);
@@ -119,6 +119,9 @@ private:
 	 * @author prissi
 	 */
 	static inthashtable_tpl<sint32,halthandle_t> *all_koords;
+
+	/// see get_halt_changes()
+	static uint32 halt_changes;
 	
 	/**
 	 * A list of lines and freight categories that have already been loaded with all available freight at the halt.
@@ -159,6 +162,9 @@ private:
 	uint8 control_towers;
 	koord init_pos;	// for halt without grounds, created during game initialisation
 
+	/// Sets init_pos and keeps the world's stop index in sync
+	void set_init_pos(koord k);
+
 	/**
 	 * Handle for ourselves. Can be used like the 'this' pointer
 	 * @author Hj. Malthaner
@@ -236,6 +242,14 @@ public:
 	static halthandle_t get_halt(const koord3d pos, const player_t *player );
 	static halthandle_t get_halt(const koord pos, const player_t *player );
 
+	/**
+	 * Counts the changes which may give get_halt() another result: stops built,
+	 * extended, reduced or taken over, and access to them granted or withdrawn.
+	 * For caches of resolved stops like schedule_t::stop_table_t.
+	 */
+	static uint32 get_halt_changes() { return halt_changes; }
+	static void halts_changed() { halt_changes++; }
+
 //	static slist_tpl<halthandle_t>& get_alle_haltestellen() { return alle_haltestellen; }
 	static const vector_tpl<halthandle_t>& get_alle_haltestellen() { return alle_haltestellen; }
 
@@ -361,7 +375,7 @@ public:
 	bool is_using() const;
 
 
-	typedef inthashtable_tpl<uint16, sint64> arrival_times_map;
+	typedef inthashtable_tpl<uint32, sint64> arrival_times_map;
 #ifdef MULTI_THREAD
 	uint32 get_transferring_cargoes_count() const;
 #else
@@ -1013,14 +1027,14 @@ public:
 
 	uint32 calc_service_frequency(halthandle_t destination, uint8 category) const;
 
-	void set_estimated_arrival_time(uint16 convoy_id, sint64 time);
-	void set_estimated_departure_time(uint16 convoy_id, sint64 time);
+	void set_estimated_arrival_time(uint32 convoy_id, sint64 time);
+	void set_estimated_departure_time(uint32 convoy_id, sint64 time);
 
 	/** 
 	* Removes a convoy from the time estimates.
 	* Used when deleting a convoy.
 	*/
-	void clear_estimated_timings(uint16 convoy_id);
+	void clear_estimated_timings(uint32 convoy_id);
 
 	const arrival_times_map& get_estimated_convoy_arrival_times() { return estimated_convoy_arrival_times; }
 	const arrival_times_map& get_estimated_convoy_departure_times() { return estimated_convoy_departure_times; }
@@ -512,8 +512,9 @@ void simline_t::finish_rd()
 void simline_t::register_stops(schedule_t * schedule)
 {
 	DBG_DEBUG("simline_t::register_stops()", "%d schedule entries in schedule %p", schedule->get_count(),schedule);
-	FOR(minivec_tpl<schedule_entry_t>,const &i, schedule->entries) {
-		halthandle_t const halt = haltestelle_t::get_halt(i.pos, player);
+	const schedule_t::stop_table_t &stops = schedule->get_stop_table(player);
+	for(  uint8 i = 0;  i < schedule->get_count();  i++  ) {
+		halthandle_t const halt = stops.get_halt(i);
 		if(halt.is_bound()) {
 			//DBG_DEBUG("simline_t::register_stops()", "halt not null");
 			halt->add_line(self);
@@ -551,8 +552,9 @@ void simline_t::unregister_stops()
 
 void simline_t::unregister_stops(schedule_t * schedule)
 {
-	FOR(minivec_tpl<schedule_entry_t>, const& i, schedule->entries) {
-		halthandle_t const halt = haltestelle_t::get_halt(i.pos, player);
+	const schedule_t::stop_table_t &stops = schedule->get_stop_table(player);
+	for(  uint8 i = 0;  i < schedule->get_count();  i++  ) {
+		halthandle_t const halt = stops.get_halt(i);
 		if(halt.is_bound()) {
 			halt->remove_line(self);
 		}
@@ -18,6 +18,7 @@
 #include "gui/simwin.h"
 #include "gui/gui_theme.h"
 #include "simhalt.h"
+#include "simconvoi.h"
 #include "display/simimg.h"
 #include "simcolor.h"
 #include "simskin.h"
@@ -62,6 +63,7 @@
 #include "dataobj/tabfile.h"
 #include "dataobj/settings.h"
 #include "dataobj/translator.h"
+#include "dataobj/block_graph.h"
 #include "network/pakset_info.h"
 
 #include "descriptor/reader/obj_reader.h"
@@ -73,6 +75,7 @@
 
 #include "utils/cbuffer_t.h"
 #include "utils/simrandom.h"
+#include "utils/step_profiler.h"
 
 #include "bauer/vehikelbauer.h"
 
@@ -198,6 +201,192 @@ static void show_times(karte_t *welt, main_view_t *view)
 #endif
 
 
+// benchmarks of the steps time their phases; keeps a recording started with -profile_steps
+static void start_benchmark_profiler()
+{
+	if(  !step_profiler_t::is_enabled()  ) {
+		step_profiler_t::set_enabled(true);
+	}
+}
+
+
+// the results of all benchmarks go to the console and to the log
+static void report_benchmark(const char *title, const cbuffer_t &buf)
+{
+	printf( "%s", buf.get_str() );
+	dbg->important( "%s results:\n%s", title, buf.get_str() );
+}
+
+
+/**
+ * Runs a loaded game headless for the given number of steps or months and reports
+ * the speed, the time spent in each phase and the final checklist, so that runs
+ * can be compared for speed and for determinism.
+ */
+static void run_benchmark(karte_t *welt, uint32 max_steps, uint32 max_months)
+{
+	start_benchmark_profiler();
+	intr_disable();
+
+	const sint32 first_step = welt->get_steps();
+	const uint64 start = step_profiler_t::get_time_us();
+	const checklist_t chk = welt->run_benchmark(max_steps, max_months);
+	const uint64 elapsed = step_profiler_t::get_time_us() - start;
+	const sint32 steps = welt->get_steps() - first_step;
+
+	cbuffer_t buf;
+	buf.printf("%d steps in %.3f s: %.2f steps/s\n", steps, elapsed / 1000000.0, elapsed > 0 ? steps * 1000000.0 / elapsed : 0.0);
+	for(  int i = 0;  i < step_profiler_t::MAX_PHASES;  i++  ) {
+		const step_profiler_t::phase_t phase = (step_profiler_t::phase_t)i;
+		buf.printf("  %-26s %10.3f s\n", step_profiler_t::get_phase_name(phase), step_profiler_t::get_total_us(phase) / 1000000.0);
+	}
+	step_profiler_t::print_allocations(buf);
+	char chk_text[2048];
+	chk.print(chk_text, "checklist");
+	buf.printf("%s\n", chk_text);
+
+	report_benchmark( "benchmark", buf );
+}
+
+
+// sums up the generated landscape, so that maps can be compared between runs
+static uint32 get_map_checksum(karte_t *welt)
+{
+	uint32 sum = 2166136261u;
+	koord k;
+	for(  k.y = 0;  k.y < welt->get_size().y;  k.y++  ) {
+		for(  k.x = 0;  k.x < welt->get_size().x;  k.x++  ) {
+			const grund_t *gr = welt->lookup_kartenboden(k);
+			sum = (sum ^ (uint8)welt->lookup_hgt(k)) * 16777619u;
+			sum = (sum ^ (uint8)welt->get_climate(k)) * 16777619u;
+			sum = (sum ^ gr->get_top()) * 16777619u;
+		}
+	}
+	sum = (sum ^ welt->get_cities().get_count()) * 16777619u;
+	sum = (sum ^ welt->get_fab_list().get_count()) * 16777619u;
+	return sum;
+}
+
+
+/**
+ * Generates new maps of the given sizes (comma separated) with the default settings
+ * and reports the time taken and a checksum of each map.
+ */
+static void run_mapgen_benchmark(karte_t *welt, const char *sizes)
+{
+	intr_disable();
+
+	cbuffer_t buf;
+	const char *p = sizes;
+	while(  *p  ) {
+		const sint32 size = atoi(p);
+		if(  size > 0  ) {
+			settings_t sets = env_t::default_settings;
+			sets.set_groesse( size, size );
+			const uint32 start = dr_time();
+			welt->init( &sets, 0 );
+			const uint32 elapsed = dr_time() - start;
+			buf.printf("%dx%d map %d: %.3f s, checksum %08x\n", size, size, sets.get_map_number(), elapsed / 1000.0, get_map_checksum(welt));
+		}
+		while(  *p  &&  *p != ','  ) {
+			p++;
+		}
+		if(  *p == ','  ) {
+			p++;
+		}
+	}
+
+	report_benchmark( "map generation benchmark", buf );
+}
+
+
+/**
+ * Draws the names of all stops, convoys and cities like list windows do,
+ * for the given number of frames, with and without the text run cache,
+ * and reports the time taken per frame.
+ */
+static void run_text_benchmark(karte_t *welt, sint32 frames)
+{
+	if(  display_get_width()==0  ) {
+		dbg->error( "run_text_benchmark()", "called without a display driver => nothing to draw!" );
+		return;
+	}
+
+	vector_tpl<const char *> names;
+	FOR( vector_tpl<halthandle_t>, const halt, haltestelle_t::get_alle_haltestellen() ) {
+		names.append( halt->get_name() );
+	}
+	FOR( vector_tpl<convoihandle_t>, const cnv, welt->convoys() ) {
+		names.append( cnv->get_name() );
+	}
+	FOR( weighted_vector_tpl<stadt_t*>, const city, welt->get_cities() ) {
+		names.append( city->get_name() );
+	}
+	if(  names.empty()  ) {
+		dbg->error( "run_text_benchmark()", "no names to draw; load a game with -load" );
+		return;
+	}
+
+	cbuffer_t buf;
+	const scr_coord_val width = display_get_width();
+	const scr_coord_val rows = max( 1, display_get_height() / LINESPACE );
+	for(  int cached = 1;  cached >= 0;  cached--  ) {
+		display_set_text_run_cache( cached != 0 );
+		const uint32 start = dr_time();
+		for(  sint32 frame = 0;  frame < frames;  frame++  ) {
+			for(  uint32 i = 0;  i < names.get_count();  i++  ) {
+				// a name column and a right aligned column, as in the convoy and stop lists
+				const scr_coord_val y = (i % rows) * LINESPACE;
+				display_proportional_ellipse_rgb( scr_rect( 0, y, width / 3, LINESPACE ), names[i], ALIGN_LEFT, color_idx_to_rgb(COL_BLACK), false );
+				display_proportional_rgb( width - 8, y, names[i], ALIGN_RIGHT, color_idx_to_rgb(COL_WHITE), false );
+			}
+		}
+		const uint32 elapsed = dr_time() - start;
+		buf.printf( "%d frames of %d names %s cache: %.3f ms per frame\n", frames, names.get_count(), cached ? "with" : "without", (double)elapsed / max( 1, frames ) );
+	}
+	display_set_text_run_cache( true );
+
+	report_benchmark( "text rendering benchmark", buf );
+}
+
+
+/**
+ * Runs the game given with -load for the given number of steps, once without
+ * and once (after loading it again) with the signal block graph, and reports
+ * the time spent reserving in rail_vehicle_t::block_reserver() for both.
+ */
+static void run_block_benchmark(karte_t *welt, const char *loadgame, uint32 steps)
+{
+	start_benchmark_profiler();
+	intr_disable();
+
+	cbuffer_t buf;
+	checklist_t chk[2];
+	for(  int with_graph = 0;  with_graph < 2;  with_graph++  ) {
+		if(  with_graph  &&  !welt->load( loadgame )  ) {
+			dbg->error( "run_block_benchmark()", "could not load %s again", loadgame );
+			return;
+		}
+		block_graph_t::set_enabled( with_graph != 0 );
+
+		// the profiler keeps running (e.g. for -profile_steps), so only count what this run added
+		const uint64 reserving_before = step_profiler_t::get_total_us( step_profiler_t::RESERVATIONS );
+		const uint64 start = step_profiler_t::get_time_us();
+		chk[with_graph] = welt->run_benchmark( steps, 0 );
+		const uint64 elapsed = step_profiler_t::get_time_us() - start;
+		const uint64 reserving = step_profiler_t::get_total_us( step_profiler_t::RESERVATIONS ) - reserving_before;
+		buf.printf( "%d steps %s block graph: %.3f s, of which reserving %.3f s\n",
+			steps, with_graph ? "with" : "without", elapsed / 1000000.0, reserving / 1000000.0 );
+	}
+	buf.printf( "%d sections of track between signals\n", block_graph_t::get_section_count() );
+	if(  !(chk[0] == chk[1])  ) {
+		buf.printf( "MISMATCH: the game ran differently with the block graph!\n" );
+	}
+
+	report_benchmark( "block graph benchmark", buf );
+}
+
+
 void modal_dialogue( gui_frame_t *gui, ptrdiff_t magic, karte_t *welt, bool (*quit)() )
 {
 	if(  display_get_width()==0  ) {
@@ -445,7 +634,20 @@ int simu_main(int argc, char** argv)
 			" -nomidi             turns off background music\n"
 			" -nosound            turns off ambient sounds\n"
 			" -objects DIR_NAME/  load the pakset in specified directory\n"
+			" -benchmark_steps N  runs the game given with -load for N steps as\n"
+			"                     fast as possible, reports the speed and quits\n"
+			" -benchmark_months N as -benchmark_steps, but runs for N months\n"
+			" -benchmark_mapgen N,M,... generates maps of N x N, M x M ... tiles,\n"
+			"                     reports the time taken and quits\n"
+			" -benchmark_text N   draws the names in the game given with -load\n"
+			"                     N times like list windows, reports the speed\n"
+			"                     with and without the text cache and quits\n"
+			" -benchmark_blocks N runs the game given with -load for N steps\n"
+			"                     with and without the signal block graph,\n"
+			"                     reports the time spent reserving and quits\n"
 			" -pause              starts game with paused after loading\n"
+			" -profile_steps NAME records the time spent in each phase of every\n"
+			"                     step; writes NAME.csv and NAME.json on exit\n"
 			" -res N              starts in specified resolution: \n"
 			"                      1=640x480, 2=800x600, 3=1024x768, 4=1280x1024\n"
 			" -screensize WxH     set screensize to width W and height H\n"
@@ -1310,6 +1512,46 @@ DBG_MESSAGE("simmain","demo file not found at %s",buf.get_str() );
 	}
 #endif
 
+	const char *profile_name = gimme_arg(argc, argv, "-profile_steps", 1);
+	if(  profile_name  ) {
+		step_profiler_t::set_enabled(true);
+	}
+
+	// headless benchmark of a saved game?
+	const char *benchmark_steps = gimme_arg(argc, argv, "-benchmark_steps", 1);
+	const char *benchmark_months = gimme_arg(argc, argv, "-benchmark_months", 1);
+	if(  benchmark_steps  ||  benchmark_months  ) {
+		if(  new_world  ) {
+			dbg->fatal("simu_main()", "-benchmark_steps and -benchmark_months need a saved game given with -load");
+		}
+		run_benchmark( welt, benchmark_steps ? atoi(benchmark_steps) : 0, benchmark_months ? atoi(benchmark_months) : 0 );
+		env_t::quit_simutrans = true;
+	}
+
+	// benchmark of the text rendering
+	const char *benchmark_text = gimme_arg(argc, argv, "-benchmark_text", 1);
+	if(  benchmark_text  ) {
+		run_text_benchmark( welt, atoi(benchmark_text) );
+		env_t::quit_simutrans = true;
+	}
+
+	// benchmark of the signal block graph
+	const char *benchmark_blocks = gimme_arg(argc, argv, "-benchmark_blocks", 1);
+	if(  benchmark_blocks  ) {
+		if(  new_world  ) {
+			dbg->fatal("simu_main()", "-benchmark_blocks needs a saved game given with -load");
+		}
+		run_block_benchmark( welt, loadgame.c_str(), atoi(benchmark_blocks) );
+		env_t::quit_simutrans = true;
+	}
+
+	// headless benchmark of the map generation?
+	const char *benchmark_mapgen = gimme_arg(argc, argv, "-benchmark_mapgen", 1);
+	if(  benchmark_mapgen  ) {
+		run_mapgen_benchmark( welt, benchmark_mapgen );
+		env_t::quit_simutrans = true;
+	}
+
 	welt->reset_timer();
 	if(  !env_t::networkmode  &&  !env_t::server  &&  new_world  ) {
 #ifdef display_in_main
@@ -1392,6 +1634,15 @@ DBG_MESSAGE("simmain","demo file not found at %s",buf.get_str() );
 
 	intr_disable();
 
+	if(  profile_name  ) {
+		// relative names are in the user directory, like the saved games
+		chdir( env_t::user_dir );
+		step_profiler_t::set_enabled(false);
+		std::string profile_file = profile_name;
+		step_profiler_t::write_csv( (profile_file + ".csv").c_str() );
+		step_profiler_t::write_trace( (profile_file + ".json").c_str() );
+	}
+
 	// save setting ...
 	chdir( env_t::user_dir );
 	if(file.wr_open(xml_filename,loadsave_t::xml,"settings only/",SAVEGAME_VER_NR, EXTENDED_VER_NR, EXTENDED_REVISION_NR)) 
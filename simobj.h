@@ -110,7 +110,7 @@ public:
 	/**
 	 * sets owner of object
 	 */
-	void set_owner(player_t *player);
+	virtual void set_owner(player_t *player);
 
 	/**
 	 * returns owner of object
@@ -29,16 +29,121 @@
 
 #include "dataobj/loadsave.h"
 #include "dataobj/environment.h"
+#include "dataobj/tile_arena.h"
 
 #include "gui/karte.h"
 
+#include "tpl/ptrhashtable_tpl.h"
+#include "tpl/vector_tpl.h"
+
+#ifdef MULTI_THREAD
+#include "utils/simthread.h"
+static pthread_mutex_t halt_pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
 
 karte_ptr_t planquadrat_t::welt;
 
+nearby_halt_t *planquadrat_t::halt_pool[planquadrat_t::HALT_POOL_MAX_PAGES];
+stadt_t *planquadrat_t::city_table[planquadrat_t::MAX_CITY_INDEX + 1];
+
+// end of the used part of the pool; offset 0 is never handed out, as it means "no list"
+static uint32 halt_pool_top = 1;
+
+// freed lists by their capacity (in steps of four, for up to 256 entries)
+static vector_tpl<uint32> free_halt_lists[65];
+
+static ptrhashtable_tpl<stadt_t *, uint16> city_indices;
+static vector_tpl<uint16> free_city_indices;
+static uint16 city_table_top = 1;
+
+
+uint32 planquadrat_t::alloc_halt_list(uint8 capacity)
+{
+	const uint32 size = capacity * HALT_LIST_STEP;
+#ifdef MULTI_THREAD
+	pthread_mutex_lock( &halt_pool_mutex );
+#endif
+	uint32 index;
+	if(  !free_halt_lists[capacity].empty()  ) {
+		index = free_halt_lists[capacity].pop_back();
+	}
+	else {
+		if(  (halt_pool_top & (HALT_POOL_PAGE_SIZE - 1)) + size > HALT_POOL_PAGE_SIZE  ) {
+			// lists do not cross pages
+			halt_pool_top = (halt_pool_top | (HALT_POOL_PAGE_SIZE - 1)) + 1;
+		}
+		const uint32 page = halt_pool_top >> HALT_POOL_PAGE_SHIFT;
+		if(  page >= HALT_POOL_MAX_PAGES  ) {
+			dbg->fatal( "planquadrat_t::alloc_halt_list()", "out of memory for halt lists" );
+		}
+		if(  halt_pool[page] == NULL  ) {
+			halt_pool[page] = new nearby_halt_t[HALT_POOL_PAGE_SIZE];
+		}
+		index = halt_pool_top;
+		halt_pool_top += size;
+	}
+#ifdef MULTI_THREAD
+	pthread_mutex_unlock( &halt_pool_mutex );
+#endif
+	return index;
+}
+
+
+void planquadrat_t::free_halt_list(uint32 index, uint8 capacity)
+{
+#ifdef MULTI_THREAD
+	pthread_mutex_lock( &halt_pool_mutex );
+#endif
+	free_halt_lists[capacity].append( index );
+#ifdef MULTI_THREAD
+	pthread_mutex_unlock( &halt_pool_mutex );
+#endif
+}
+
+
+void planquadrat_t::set_city(stadt_t* value)
+{
+	if(  value == NULL  ) {
+		city = 0;
+		return;
+	}
+	uint16 *index = city_indices.access( value );
+	if(  index  ) {
+		city = *index;
+		return;
+	}
+	// first tile of this city
+	uint16 new_index;
+	if(  !free_city_indices.empty()  ) {
+		new_index = free_city_indices.pop_back();
+	}
+	else {
+		if(  city_table_top == MAX_CITY_INDEX  ) {
+			dbg->fatal( "planquadrat_t::set_city()", "too many cities" );
+		}
+		new_index = city_table_top++;
+	}
+	city_table[new_index] = value;
+	city_indices.put( value, new_index );
+	city = new_index;
+}
+
+
+void planquadrat_t::remove_city(stadt_t *c)
+{
+	const uint16 index = city_indices.remove( c );
+	if(  index  ) {
+		city_table[index] = NULL;
+		free_city_indices.append( index );
+	}
+}
+
 
 void swap(planquadrat_t& a, planquadrat_t& b)
 {
-	sim::swap(a.halt_list, b.halt_list);
+	sim::swap(a.halt_list_index, b.halt_list_index);
+	sim::swap(a.halt_list_capacity, b.halt_list_capacity);
 	sim::swap(a.ground_size, b.ground_size);
 	sim::swap(a.halt_list_count, b.halt_list_count);
 	sim::swap(a.data, b.data);
@@ -69,7 +174,10 @@ planquadrat_t::~planquadrat_t()
 		}
 		delete [] data.some;
 	}
-	delete [] halt_list;
+	if(  halt_list_index  ) {
+		free_halt_list( halt_list_index, halt_list_capacity );
+		halt_list_index = 0;
+	}
 	halt_list_count = 0;
 	// to avoid access to this tile
 	ground_size = 0;
@@ -240,6 +348,7 @@ void planquadrat_t::boden_ersetzen(grund_t *alt, grund_t *neu)
 		}
 		delete alt;
 	}
+	welt->city_tile_changed( neu->get_pos().get_2d() );
 }
 
 
@@ -263,6 +372,8 @@ void planquadrat_t::rdwr(loadsave_t *file, koord pos )
 	else {
 		grund_t *gr;
 		sint8 hgt = welt->get_groundwater();
+		// keep the grounds of neighbouring tiles together
+		tile_arena_t::set_position( pos );
 		//DBG_DEBUG("planquadrat_t::rdwr()","Reading boden");
 		do {
 			short gtyp = file->rd_obj_id();
@@ -323,6 +434,7 @@ void planquadrat_t::rdwr(loadsave_t *file, koord pos )
 
 			if (halt_list_count > 0)
 			{
+				const nearby_halt_t *const halt_list = get_halt_list_data();
 				for (uint8 i = 0; i < halt_list_count; i++)
 				{
 					nearby_halt_t nearby_halt = halt_list[i];
@@ -379,6 +491,7 @@ void planquadrat_t::correct_water()
 	sint8 max_height = gr->get_hoehe() + slope_t::max_diff( slope );
 	koord k = gr->get_pos().get_2d();
 	sint8 water_hgt = welt->get_water_hgt(k);
+	tile_arena_t::set_position( k );
 	if(  gr  &&  gr->get_typ() != grund_t::wasser  &&  max_height <= water_hgt  ) {
 		// below water but ground => convert
 		kartenboden_setzen( new wasser_t(koord3d( k, water_hgt ) ) );
@@ -622,6 +735,7 @@ void planquadrat_t::display_overlay(const sint16 xpos, const sint16 ypos) const
 
 	// display station owner boxes
 	if(env_t::station_coverage_show  &&  halt_list_count>0) {
+		const nearby_halt_t *const halt_list = get_halt_list_data();
 
 		if(env_t::use_transparency_station_coverage) {
 
@@ -729,12 +843,15 @@ halthandle_t planquadrat_t::get_halt(player_t *player) const
 // these functions are private helper functions for halt_list
 void planquadrat_t::halt_list_remove( halthandle_t halt )
 {
+	nearby_halt_t *const halt_list = get_halt_list_data();
 	for( uint8 i=0;  i<halt_list_count;  i++ ) {
 		if(halt_list[i].halt == halt) {
 			for( uint8 j=i+1;  j<halt_list_count;  j++  ) {
 				halt_list[j-1] = halt_list[j];
 			}
 			halt_list_count--;
+			// docks are found through this list
+			haltestelle_t::halts_changed();
 			break;
 		}
 	}
@@ -744,17 +861,21 @@ void planquadrat_t::halt_list_remove( halthandle_t halt )
 void planquadrat_t::halt_list_insert_at(halthandle_t halt, uint8 pos, uint8 distance)
 {
 	// extend list?
-	if((halt_list_count%4)==0) {
-		nearby_halt_t *tmp = new nearby_halt_t[halt_list_count+4];
-		if(halt_list!=NULL) {
+	if(halt_list_count == halt_list_capacity*HALT_LIST_STEP) {
+		const uint32 tmp_index = alloc_halt_list(halt_list_capacity+1);
+		if(halt_list_index!=0) {
 			// now insert
+			nearby_halt_t *const tmp = halt_pool[tmp_index >> HALT_POOL_PAGE_SHIFT] + (tmp_index & (HALT_POOL_PAGE_SIZE - 1));
+			const nearby_halt_t *const old = get_halt_list_data();
 			for( uint8 i=0;  i<halt_list_count;  i++ ) {
-				tmp[i] = halt_list[i];
+				tmp[i] = old[i];
 			}
-			delete [] halt_list;
+			free_halt_list(halt_list_index, halt_list_capacity);
 		}
-		halt_list = tmp;
+		halt_list_index = tmp_index;
+		halt_list_capacity++;
 	}
+	nearby_halt_t *const halt_list = get_halt_list_data();
 	// now insert
 	for( uint8 i=halt_list_count;  i>pos;  i-- ) {
 		halt_list[i] = halt_list[i-1];
@@ -762,6 +883,7 @@ void planquadrat_t::halt_list_insert_at(halthandle_t halt, uint8 pos, uint8 dist
 	halt_list[pos].halt = halt;
 	halt_list[pos].distance = distance;
 	halt_list_count ++;
+	haltestelle_t::halts_changed();
 }
 
 
@@ -783,6 +905,7 @@ void planquadrat_t::add_to_haltlist(halthandle_t halt)
 			// Since only the first one gets all, we want the closest halt one to be first
 			halt_list_remove(halt);
 			
+			const nearby_halt_t *const halt_list = get_halt_list_data();
 			for(unsigned insert_pos = 0; insert_pos < halt_list_count; insert_pos++)
 			{			
 				if(halt_list[insert_pos].halt.is_bound() && koord_distance(halt_list[insert_pos].halt->get_next_pos(pos), pos) > distance)
@@ -846,6 +969,7 @@ void planquadrat_t::remove_from_haltlist(halthandle_t halt)
  */
 uint8 planquadrat_t::get_connected(halthandle_t halt) const
 {
+	const nearby_halt_t *const halt_list = get_halt_list_data();
 	for(uint8 i = 0; i < halt_list_count; i++)
 	{
 		if(halt_list[i].halt == halt) 
@@ -35,32 +35,63 @@ struct nearby_halt_t
 class planquadrat_t
 {
 	static karte_ptr_t welt;
+
+	/*
+	 * There is one of these for every 2D tile, so the members are ordered for size
+	 * (24 bytes with 64 bit pointers). Instead of pointers, the halt list is stored
+	 * as an offset into a shared pool and the city as an index into a table.
+	 */
+	enum {
+		HALT_POOL_PAGE_SHIFT = 16,
+		HALT_POOL_PAGE_SIZE = 1 << HALT_POOL_PAGE_SHIFT,
+		HALT_POOL_MAX_PAGES = 1 << (32 - HALT_POOL_PAGE_SHIFT),
+		HALT_LIST_STEP = 4,     // the halt lists grow by this many entries
+		MAX_CITY_INDEX = 65535
+	};
+
+	// pages of the pool of halt lists; pages never move, so lists can be read while others are added
+	static nearby_halt_t *halt_pool[HALT_POOL_MAX_PAGES];
+
+	// cities by the index stored in the tiles; entry 0 is NULL
+	static stadt_t *city_table[MAX_CITY_INDEX + 1];
+
 private:
-	/* list of stations that are reaching to this tile (saves lots of time for lookup) */
-	nearby_halt_t *halt_list;
+	union DATA {
+		grund_t ** some;    // valid if capacity > 1
+		grund_t * one;      // valid if capacity == 1
+	} data;
 
-	uint8 ground_size, halt_list_count;
+	/* list of stations that are reaching to this tile (saves lots of time for lookup)
+	 * offset into halt_pool, or 0 if there is none */
+	uint32 halt_list_index;
 
 	/**
-	 * If this tile belongs to a city, a pointer to that city.
+	 * If this tile belongs to a city, the index of that city in city_table.
 	 * This saves much lookup time
 	 */
-	stadt_t* city;
+	uint16 city;
+
+	uint8 ground_size, halt_list_count;
+
+	// size of the halt list in units of HALT_LIST_STEP
+	uint8 halt_list_capacity;
 
 	// stores climate related settings
 	uint8 climate_data;
 
-	union DATA {
-		grund_t ** some;    // valid if capacity > 1
-		grund_t * one;      // valid if capacity == 1
-	} data;
+	nearby_halt_t *get_halt_list_data() const {
+		return halt_pool[halt_list_index >> HALT_POOL_PAGE_SHIFT] + (halt_list_index & (HALT_POOL_PAGE_SIZE - 1));
+	}
+
+	static uint32 alloc_halt_list(uint8 capacity);
+	static void free_halt_list(uint32 index, uint8 capacity);
 
 public:
 	/**
 	 * Constructs a planquadrat (tile) with initial capacity of one ground
 	 * @author Hansjrg Malthaner
 	 */
-	planquadrat_t() { ground_size = 0; climate_data = 0; data.one = NULL; halt_list_count = 0;  halt_list = NULL; city = NULL; }
+	planquadrat_t() { ground_size = 0; climate_data = 0; data.one = NULL; halt_list_count = 0; halt_list_capacity = 0; halt_list_index = 0; city = 0; }
 
 	~planquadrat_t();
 
@@ -179,8 +210,11 @@ public:
 	*/
 	inline uint8 get_climate_corners() const { return (climate_data >> 4) & 15; }
 
-	stadt_t* get_city() const { return city; }
-	void set_city(stadt_t* value) { city = value; }
+	stadt_t* get_city() const { return city_table[city]; }
+	void set_city(stadt_t* value);
+
+	/// Frees the index of a city, which must not be set on any tile any more
+	static void remove_city(stadt_t *c);
 
 	/**
 	* sets climate transition corners
@@ -244,7 +278,7 @@ public:
 	* returns the internal array of halts
 	* @author prissi
 	*/
-	const nearby_halt_t *get_haltlist() const { return halt_list; }
+	const nearby_halt_t *get_haltlist() const { return halt_list_index ? get_halt_list_data() : NULL; }
 	uint8 get_haltlist_count() const { return halt_list_count; }
 
 	void rdwr(loadsave_t *file, koord pos );
@@ -8587,14 +8587,14 @@ static bool scenario_check_schedule(karte_t *welt, player_t *player, schedule_t
 bool tool_change_convoi_t::init( player_t *player )
 {
 	char tool = 0;
-	uint16 convoi_id = 0;
+	uint32 convoi_id = 0;
 
 	// skip the rest of the command
 	const char *p = default_param;
 	while(  *p  &&  *p<=' '  ) {
 		p++;
 	}
-	sscanf( p, "%c,%hi", &tool, &convoi_id );
+	sscanf( p, "%c,%u", &tool, &convoi_id );
 
 	// skip to the commands ...
 	for(  int z = 2;  *p  &&  z>0;  p++  ) {
@@ -8695,8 +8695,8 @@ bool tool_change_convoi_t::init( player_t *player )
 
 	case 'C': // Copy a replace datum
 	{
-		uint16 cnv_rpl_id;
-		sscanf(p, "%hi", &cnv_rpl_id);
+		uint32 cnv_rpl_id;
+		sscanf(p, "%u", &cnv_rpl_id);
 		convoihandle_t cnv_rpl;
 		cnv_rpl.set_id(cnv_rpl_id);
 		if (cnv_rpl.is_bound() && cnv_rpl->get_replace())
@@ -9135,7 +9135,7 @@ bool tool_change_depot_t::init( player_t *player )
 	char tool=0;
 	koord3d pos = koord3d::invalid;
 	sint16 z;
-	uint16 convoi_id;
+	uint32 convoi_id;
 	uint16 livery_scheme_index;
 
 	// skip the rest of the command
@@ -9143,7 +9143,7 @@ bool tool_change_depot_t::init( player_t *player )
 	while(  *p  &&  *p<=' '  ) {
 		p++;
 	}
-	sscanf( p, "%c,%hi,%hi,%hi,%hi,%hi", &tool, &pos.x, &pos.y, &z, &convoi_id, &livery_scheme_index );
+	sscanf( p, "%c,%hi,%hi,%hi,%u,%hi", &tool, &pos.x, &pos.y, &z, &convoi_id, &livery_scheme_index );
 	pos.z = (sint8)z;
 
 	// skip to the commands ...
@@ -9535,7 +9535,8 @@ bool tool_change_city_t::init( player_t *player )
  */
 bool tool_rename_t::init(player_t *player)
 {
-	uint16 id = 0;
+	uint32 id = 0;
+	sint16 z = 0;
 	koord3d pos = koord3d::invalid;
 
 	// skip the rest of the command
@@ -9553,7 +9554,7 @@ bool tool_rename_t::init(player_t *player)
 			break;
 		case 'm':
 		case 'f':
-			if(  3!=sscanf( p, "%hi,%hi,%hi", &pos.x, &pos.y, &id )  ) {
+			if(  3!=sscanf( p, "%hi,%hi,%hi", &pos.x, &pos.y, &z )  ) {
 				dbg->error( "tool_rename_t::init", "no position given for marker/factory! (%s)", default_param );
 				return false;
 			}
@@ -9563,8 +9564,7 @@ bool tool_rename_t::init(player_t *player)
 			}
 			while(  *p>0  &&  *p++!=','  ) {
 			}
-			pos.z = (sint8)id;
-			id = 0;
+			pos.z = (sint8)z;
 			break;
 		default:
 			dbg->error( "tool_rename_t::init", "illegal request! (%s)", default_param );
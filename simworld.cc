@@ -96,10 +96,13 @@
 #include "dataobj/powernet.h"
 #include "dataobj/records.h"
 #include "dataobj/marker.h"
+#include "dataobj/tile_arena.h"
+#include "dataobj/block_graph.h"
 
 #include "utils/cbuffer_t.h"
 #include "utils/simrandom.h"
 #include "utils/simstring.h"
+#include "utils/step_profiler.h"
 
 #include "network/memory_rw.h"
 
@@ -130,7 +133,6 @@
 #include "utils/simthread.h"
 
 static vector_tpl<pthread_t> private_car_route_threads;
-static vector_tpl<pthread_t> unreserve_route_threads;
 static vector_tpl<pthread_t> step_passengers_and_mail_threads;
 static vector_tpl<pthread_t> individual_convoy_step_threads;
 static vector_tpl<pthread_t> path_explorer_threads;
@@ -143,15 +145,12 @@ static pthread_mutexattr_t mutex_attributes;
 //static pthread_mutex_t private_car_route_mutex = PTHREAD_MUTEX_INITIALIZER;
 //pthread_mutex_t karte_t::step_passengers_and_mail_mutex = PTHREAD_MUTEX_INITIALIZER;
 //static pthread_mutex_t path_explorer_await_mutex = PTHREAD_MUTEX_INITIALIZER;
-//pthread_mutex_t karte_t::unreserve_route_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 static pthread_mutex_t private_car_route_mutex;
 pthread_mutex_t karte_t::step_passengers_and_mail_mutex;
 static pthread_mutex_t path_explorer_await_mutex;
-pthread_mutex_t karte_t::unreserve_route_mutex;
 
 static simthread_barrier_t private_car_barrier;
-simthread_barrier_t karte_t::unreserve_route_barrier;
 static simthread_barrier_t step_passengers_and_mail_barrier;
 static simthread_barrier_t path_explorer_barrier;
 static simthread_barrier_t step_convoys_barrier_internal;
@@ -334,6 +333,90 @@ void karte_t::world_xy_loop(xy_loop_func function, uint8 flags)
 }
 
 
+#ifdef MULTI_THREAD
+// to start a thread of world_range_loop()
+typedef struct{
+	karte_t *welt;
+	range_loop_func function;
+	uint32 first;
+	uint32 last;
+} world_range_param_t;
+#endif
+
+
+void *karte_t::world_range_loop_thread(void *ptr)
+{
+#ifdef MULTI_THREAD
+	world_range_param_t *param = reinterpret_cast<world_range_param_t *>(ptr);
+	(param->welt->*(param->function))( param->first, param->last );
+#endif
+	return ptr;
+}
+
+
+void karte_t::world_range_loop(range_loop_func function, uint32 count)
+{
+#ifdef MULTI_THREAD
+	set_random_mode( INTERACTIVE_RANDOM ); // do not allow simrand() here!
+
+	const uint32 num_threads = min( (uint32)env_t::num_threads, max( 1u, count ) );
+	world_range_param_t param[MAX_THREADS];
+	pthread_t thread[MAX_THREADS];
+	for(  uint32 t = 0;  t < num_threads;  t++  ) {
+		param[t].welt = this;
+		param[t].function = function;
+		param[t].first = (uint32)( ((uint64)t * count) / num_threads );
+		param[t].last = (uint32)( ((uint64)(t + 1) * count) / num_threads );
+	}
+
+	// the threads only live for this loop, since it is rarely needed (e.g. for rotation)
+	for(  uint32 t = 0;  t < num_threads - 1;  t++  ) {
+		if(  pthread_create( &thread[t], NULL, world_range_loop_thread, (void *)&param[t] )  ) {
+			dbg->fatal( "karte_t::world_range_loop()", "cannot multithread, error at thread #%i", t+1 );
+		}
+	}
+	// the last we can run ourselves
+	world_range_loop_thread( &param[num_threads-1] );
+	for(  uint32 t = 0;  t < num_threads - 1;  t++  ) {
+		pthread_join( thread[t], NULL );
+	}
+
+	clear_random_mode( INTERACTIVE_RANDOM );
+#else
+	(this->*function)( 0, count );
+#endif
+}
+
+
+// rows per band of world_band_loop(); must not depend on the number of threads
+#define MAP_BAND_ROWS (64)
+
+// the job of the current world_band_loop()
+static karte_t::band_job_t *band_job = NULL;
+static uint32 band_seed = 0;
+
+
+void karte_t::world_band_loop_range(uint32 first, uint32 last)
+{
+	for(  uint32 band = first;  band < last;  band++  ) {
+		simrand_scope_t random( band_seed + band * 0x9E3779B9u );
+		const sint16 y_min = (sint16)(band * MAP_BAND_ROWS);
+		const sint16 y_max = (sint16)min( (band + 1) * MAP_BAND_ROWS, get_size().y );
+		band_job->run_rows( y_min, y_max );
+	}
+}
+
+
+void karte_t::world_band_loop(band_job_t &job)
+{
+	const uint32 bands = (get_size().y + MAP_BAND_ROWS - 1) / MAP_BAND_ROWS;
+	band_job = &job;
+	band_seed = simrand_plain();
+	world_range_loop( &karte_t::world_band_loop_range, bands );
+	band_job = NULL;
+}
+
+
 checklist_t::checklist_t(uint32 _ss, uint32 _st, uint8 _nfc, uint32 _random_seed, uint16 _halt_entry, uint16 _line_entry, uint16 _convoy_entry, uint32 *_rands, uint32 *_debug_sums)
 	: ss(_ss), st(_st), nfc(_nfc), random_seed(_random_seed), halt_entry(_halt_entry), line_entry(_line_entry), convoy_entry(_convoy_entry)
 {
@@ -380,6 +463,147 @@ int checklist_t::print(char *buffer, const char *entity) const
 }
 
 
+uint32 world_hash_t::get_diverged(const world_hash_t &other) const
+{
+	uint32 diverged = 0;
+	for(  uint8 i = 0;  i < MAX_WORLD_HASHES;  i++  ) {
+		if(  hash[i] != other.hash[i]  ) {
+			diverged |= 1u << i;
+		}
+	}
+	return diverged;
+}
+
+
+const char *world_hash_t::get_name(uint8 part)
+{
+	static const char *const names[MAX_WORLD_HASHES] = { "halts", "convoys", "cities", "factories", "ways", "players" };
+	return part < MAX_WORLD_HASHES ? names[part] : "";
+}
+
+
+void world_hash_t::rdwr(memory_rw_t *buffer)
+{
+	buffer->rdwr_long(st);
+	for(  uint8 i = 0;  i < MAX_WORLD_HASHES;  i++  ) {
+		buffer->rdwr_long(hash[i]);
+	}
+}
+
+
+int world_hash_t::print(char *buffer, const char *entity) const
+{
+	return sprintf(buffer, "%s=[st=%u halts=%08x convoys=%08x cities=%08x factories=%08x ways=%08x players=%08x] ",
+		entity, st, hash[HALTS], hash[CONVOYS], hash[CITIES], hash[FACTORIES], hash[WAYS], hash[PLAYERS]
+	);
+}
+
+
+// FNV-1a over the values of one object
+static inline uint32 hash_long(uint32 h, uint32 v)
+{
+	for(  int i = 0;  i < 4;  i++  ) {
+		h = (h ^ ((v >> (i * 8)) & 0xFF)) * 0x01000193u;
+	}
+	return h;
+}
+
+static inline uint32 hash_longlong(uint32 h, sint64 v)
+{
+	return hash_long( hash_long( h, (uint32)v ), (uint32)((uint64)v >> 32) );
+}
+
+static inline uint32 hash_pos(uint32 h, koord3d pos)
+{
+	return hash_long( h, ((uint32)(uint16)pos.x << 16) | (uint16)pos.y ) ^ (uint8)pos.z;
+}
+
+#define HASH_START (0x811C9DC5u)
+
+
+void karte_t::calc_world_hash()
+{
+	// the objects are summed up, since their order differs after loading
+	world_hash_t h;
+	h.st = steps;
+
+	FOR(vector_tpl<halthandle_t>, const halt, haltestelle_t::get_alle_haltestellen()) {
+		uint32 oh = hash_long( HASH_START, halt.get_id() );
+		oh = hash_long( oh, ((uint32)(uint16)halt->get_basis_pos().x << 16) | (uint16)halt->get_basis_pos().y );
+		oh = hash_longlong( oh, halt->get_finance_history( 0, HALT_ARRIVED ) );
+		oh = hash_longlong( oh, halt->get_finance_history( 0, HALT_DEPARTED ) );
+		oh = hash_longlong( oh, halt->get_finance_history( 0, HALT_WAITING ) );
+		h.hash[world_hash_t::HALTS] += oh;
+	}
+
+	FOR(vector_tpl<convoihandle_t>, const cnv, convoi_array) {
+		uint32 oh = hash_long( HASH_START, cnv.get_id() );
+		oh = hash_pos( oh, cnv->get_pos() );
+		oh = hash_long( oh, cnv->get_akt_speed() );
+		oh = hash_longlong( oh, cnv->get_jahresgewinn() );
+		h.hash[world_hash_t::CONVOYS] += oh;
+	}
+
+	FOR(weighted_vector_tpl<stadt_t*>, const city, stadt) {
+		uint32 oh = hash_long( HASH_START, ((uint32)(uint16)city->get_pos().x << 16) | (uint16)city->get_pos().y );
+		oh = hash_long( oh, city->get_einwohner() );
+		oh = hash_long( oh, city->get_buildings() );
+		h.hash[world_hash_t::CITIES] += oh;
+	}
+
+	FOR(vector_tpl<fabrik_t*>, const fab, fab_list) {
+		uint32 oh = hash_pos( HASH_START, fab->get_pos() );
+		oh = hash_long( oh, fab->get_total_in() );
+		oh = hash_long( oh, fab->get_total_transit() );
+		oh = hash_long( oh, fab->get_total_out() );
+		h.hash[world_hash_t::FACTORIES] += oh;
+	}
+
+	// there are far more ways than anything else: each time only one diagonal slice of them is hashed
+	const uint32 way_slice = (steps / WORLD_HASH_INTERVAL) % WAY_HASH_SLICES;
+	FOR(vector_tpl<weg_t *>, const w, weg_t::get_alle_wege()) {
+		if(  ((uint32)(uint16)w->get_pos().x + (uint16)w->get_pos().y) % WAY_HASH_SLICES != way_slice  ) {
+			continue;
+		}
+		uint32 oh = hash_pos( HASH_START, w->get_pos() );
+		oh = hash_long( oh, w->get_waytype() );
+		oh = hash_long( oh, w->get_max_speed() );
+		oh = hash_long( oh, w->get_remaining_wear_capacity() );
+		h.hash[world_hash_t::WAYS] += oh;
+	}
+
+	for(  int i = 0;  i < MAX_PLAYER_COUNT;  i++  ) {
+		if(  players[i] != NULL  ) {
+			uint32 oh = hash_long( HASH_START, i );
+			oh = hash_longlong( oh, players[i]->get_finance()->get_account_balance() );
+			h.hash[world_hash_t::PLAYERS] += oh;
+		}
+	}
+
+	for(  int i = 1;  i < LAST_WORLD_HASHES_COUNT;  i++  ) {
+		last_world_hashes[i - 1] = last_world_hashes[i];
+	}
+	last_world_hashes[LAST_WORLD_HASHES_COUNT - 1] = h;
+}
+
+
+const world_hash_t *karte_t::get_world_hash_at(uint32 st) const
+{
+	for(  int i = 0;  i < LAST_WORLD_HASHES_COUNT;  i++  ) {
+		if(  last_world_hashes[i].st == st  &&  st != 0  ) {
+			return &last_world_hashes[i];
+		}
+	}
+	return NULL;
+}
+
+
+const world_hash_t &karte_t::get_last_world_hash() const
+{
+	return last_world_hashes[LAST_WORLD_HASHES_COUNT - 1];
+}
+
+
 void karte_t::recalc_season_snowline(bool set_pending)
 {
 	static const sint8 mfactor[12] = { 99, 95, 80, 50, 25, 10, 0, 5, 20, 35, 65, 85 };
@@ -477,6 +701,7 @@ void karte_t::cleanup_grounds_loop( sint16 x_min, sint16 x_max, sint16 y_min, si
 			}
 
 			gr->set_pos( koord3d( k, height) );
+			tile_arena_t::set_position( k );
 			if(  gr->get_typ() != grund_t::wasser  &&  max_hgt_nocheck(k) <= water_hgt  ) {
 				// below water but ground => convert
 				pl->kartenboden_setzen( new wasser_t(gr->get_pos()) );
@@ -547,12 +772,15 @@ void karte_t::destroy()
 
 	passenger_origins.clear();
 	mail_origins_and_targets.clear();
+	block_graph_t::clear();
 
 	for (uint8 i = 0; i < goods_manager_t::passengers->get_number_of_classes(); i++)
 	{
 		commuter_targets[i].clear();
 		visitor_targets[i].clear();
 	}
+	destination_index.clear();
+	clear_walking_destinations();
 
 	uint32 max_display_progress = 256+stadt.get_count()*10 + haltestelle_t::get_alle_haltestellen().get_count() + convoi_array.get_count() + (cached_size.x*cached_size.y)*2;
 	uint32 old_progress = 0;
@@ -662,10 +890,15 @@ void karte_t::destroy()
 		delete f;
 	}
 	fab_list.clear();
+	fab_index.clear();
+	max_fab_extent = 0;
 	DBG_MESSAGE("karte_t::destroy()", "factories destroyed");
 
 	// hier nur entfernen, aber nicht loeschen
 	world_attractions.clear();
+	attraction_index.clear();
+	city_index.clear();
+	halt_index.clear();
 	DBG_MESSAGE("karte_t::destroy()", "attraction list destroyed");
 
 	weg_t::clear_list_of__ways();
@@ -714,6 +947,21 @@ void karte_t::add_city(stadt_t *s)
 {
 	settings.set_city_count(settings.get_city_count() + 1);
 	stadt.append(s, s->get_einwohner());
+	city_index.insert(s->get_pos(), s);
+}
+
+
+void karte_t::city_tile_changed(koord k)
+{
+	if(  destroying  ) {
+		return;
+	}
+	// tiles outside of all cities are not noted by planquadrat_t at all
+	if(  const planquadrat_t *plan = access(k)  ) {
+		if(  stadt_t *s = plan->get_city()  ) {
+			s->growth_tile_changed(k);
+		}
+	}
 }
 
 
@@ -729,6 +977,7 @@ bool karte_t::remove_city(stadt_t *s)
 		DBG_MESSAGE("karte_t::remove_city()", "%s", s->get_name());
 	}
 	stadt.remove(s);
+	city_index.remove(s->get_pos(), s);
 	DBG_DEBUG4("karte_t::remove_city()", "reduce city to %i", settings.get_city_count() - 1);
 	settings.set_city_count(settings.get_city_count() - 1);
 
@@ -754,6 +1003,8 @@ void karte_t::init_tiles()
 	water_hgts = new sint8[x * y];
 	MEMZERON(water_hgts, x * y);
 
+	rebuild_spatial_indices();
+
 	win_set_world( this );
 	reliefkarte_t::get_karte()->init();
 
@@ -1309,40 +1560,37 @@ void karte_t::distribute_cities(settings_t const * const sets, sint16 old_x, sin
 	}
 }
 
-void karte_t::distribute_groundobjs_cities( settings_t const * const sets, sint16 old_x, sint16 old_y)
+/**
+ * Distributes the groundobjs on the rows of a band,
+ * but not in the rectangle from (0,0) till (old_x, old_y).
+ */
+class groundobj_band_job_t : public karte_t::band_job_t
 {
-	DBG_DEBUG("karte_t::distribute_groundobjs_cities()","distributing groundobjs");
-
-	if (env_t::river_types > 0 && settings.get_river_number() > 0) {
-		create_rivers(settings.get_river_number());
-	}
+	karte_t *welt;
+	sint16 old_x, old_y;
 
-	sint32 new_city_count = abs(sets->get_city_count());
-	// Do city and road creation if (and only if) cities were requested.
-	if (new_city_count > 0) {
-		this->distribute_cities(sets, old_x, old_y);
-	}
+public:
+	groundobj_band_job_t(karte_t *w, sint16 ox, sint16 oy) : welt(w), old_x(ox), old_y(oy) {}
 
-	DBG_DEBUG("karte_t::distribute_groundobjs_cities()","distributing groundobjs");
-	if(  env_t::ground_object_probability > 0  ) {
-		// add eyecandy like rocky, moles, flowers, ...
+	void run_rows(sint16 y_min, sint16 y_max) OVERRIDE
+	{
 		koord k;
 		sint32 queried = simrand(env_t::ground_object_probability*2-1, "karte_t::distribute_groundobjs_cities(), distributing groundobjs - 1st instance");
-		for(  k.y=0;  k.y<get_size().y;  k.y++  ) {
-			for(  k.x=(k.y<old_y)?old_x:0;  k.x<get_size().x;  k.x++  ) {
-				grund_t *gr = lookup_kartenboden_nocheck(k);
+		for(  k.y=y_min;  k.y<y_max;  k.y++  ) {
+			for(  k.x=(k.y<old_y)?old_x:0;  k.x<welt->get_size().x;  k.x++  ) {
+				grund_t *gr = welt->lookup_kartenboden(k);
 				if(  gr->get_typ()==grund_t::boden  &&  !gr->hat_wege()  ) {
 					queried --;
 					if(  queried<0  ) {
 						// test for beach
 						bool neighbour_water = false;
 						for(int i=0; i<8; i++) {
-							if(  is_within_limits(k + koord::neighbours[i])  &&  get_climate( k + koord::neighbours[i] ) == water_climate  ) {
+							if(  welt->is_within_limits(k + koord::neighbours[i])  &&  welt->get_climate( k + koord::neighbours[i] ) == water_climate  ) {
 								neighbour_water = true;
 								break;
 							}
 						}
-						const climate_bits cl = neighbour_water ? water_climate_bit : (climate_bits)(1<<get_climate(k));
+						const climate_bits cl = neighbour_water ? water_climate_bit : (climate_bits)(1<<welt->get_climate(k));
 						const groundobj_desc_t *desc = groundobj_t::random_groundobj_for_climate( cl, gr->get_grund_hang() );
 						if(desc) {
 							queried = simrand(env_t::ground_object_probability*2-1, "karte_t::distribute_groundobjs_cities(), distributing groundobjs - 2nd instance");
@@ -1353,6 +1601,29 @@ void karte_t::distribute_groundobjs_cities( settings_t const * const sets, sint1
 			}
 		}
 	}
+};
+
+
+void karte_t::distribute_groundobjs_cities( settings_t const * const sets, sint16 old_x, sint16 old_y)
+{
+	DBG_DEBUG("karte_t::distribute_groundobjs_cities()","distributing groundobjs");
+
+	if (env_t::river_types > 0 && settings.get_river_number() > 0) {
+		create_rivers(settings.get_river_number());
+	}
+
+	sint32 new_city_count = abs(sets->get_city_count());
+	// Do city and road creation if (and only if) cities were requested.
+	if (new_city_count > 0) {
+		this->distribute_cities(sets, old_x, old_y);
+	}
+
+	DBG_DEBUG("karte_t::distribute_groundobjs_cities()","distributing groundobjs");
+	if(  env_t::ground_object_probability > 0  ) {
+		// add eyecandy like rocky, moles, flowers, ...
+		groundobj_band_job_t job( this, old_x, old_y );
+		world_band_loop( job );
+	}
 
 
 DBG_DEBUG("karte_t::distribute_groundobjs_cities()","distributing movingobjs");
@@ -1629,8 +1900,11 @@ void *check_road_connexions_threaded(void *args)
 				continue;
 			}
 
-			city->check_all_private_car_routes();
-			city->set_check_road_connexions(false);
+			{
+				step_profiler_scope_t profile_scope(step_profiler_t::PRIVATE_CAR_ROUTES);
+				city->check_all_private_car_routes();
+				city->set_check_road_connexions(false);
+			}
 
 			simthread_barrier_wait(&private_car_barrier);
 		}
@@ -1685,6 +1959,10 @@ void *step_passengers_and_mail_threaded(void* args)
 			break;
 		}
 
+		// Not a scope timer, as this must not include the waiting at the barriers below
+		const bool profiling = step_profiler_t::is_enabled();
+		const uint64 profile_start = profiling ? step_profiler_t::get_time_us() : 0;
+
 		// The generate passengers function is called many times (often well > 100) each step; the mail version is called only once or twice each step, sometimes not at all.
 		sint32 units_this_step = 0;
 		total_units_passenger = 0;
@@ -1787,6 +2065,11 @@ void *step_passengers_and_mail_threaded(void* args)
 		}
 #endif
 
+		if (profiling)
+		{
+			step_profiler_t::add(step_profiler_t::PASSENGERS_AND_MAIL, profile_start, step_profiler_t::get_time_us());
+		}
+
 		simthread_barrier_wait(&step_passengers_and_mail_barrier); // Having three of these is intentional.
 		int mutex_error = pthread_mutex_lock(&karte_t::step_passengers_and_mail_mutex);
 		assert(mutex_error == 0);
@@ -1874,13 +2157,16 @@ void* step_individual_convoy_threaded(void* args)
 			return NULL;
 		}
 		
-		const uint32 convoys_next_step_count = convoys_next_step.get_count();
-		for (uint32 i = thread_number; i < convoys_next_step_count; i += karte_t::world->get_parallel_operations())
 		{
-			convoihandle_t cnv = convoys_next_step[i];
-			if (cnv.is_bound())
+			step_profiler_scope_t profile_scope(step_profiler_t::CONVOYS_THREADED);
+			const uint32 convoys_next_step_count = convoys_next_step.get_count();
+			for (uint32 i = thread_number; i < convoys_next_step_count; i += karte_t::world->get_parallel_operations())
 			{
-				cnv->threaded_step();
+				convoihandle_t cnv = convoys_next_step[i];
+				if (cnv.is_bound())
+				{
+					cnv->threaded_step();
+				}
 			}
 		}
 
@@ -1919,7 +2205,10 @@ void* path_explorer_threaded(void* args)
 		{
 			return NULL;
 		}
-		path_explorer_t::step();
+		{
+			step_profiler_scope_t profile_scope(step_profiler_t::PATH_EXPLORER);
+			path_explorer_t::step();
+		}
 		simthread_barrier_wait(&path_explorer_barrier);
 	}
 
@@ -1957,52 +2246,6 @@ void karte_t::start_path_explorer()
 	path_explorer_working = true;
 #endif 
 }
-
-void* unreserve_route_threaded(void* args)
-{
-	const uint32* thread_number_ptr = (const uint32*)args;
-	const uint32 thread_number = *thread_number_ptr;
-	delete thread_number_ptr;
-
-	do
-	{
-		simthread_barrier_wait(&karte_t::unreserve_route_barrier);
-		
-		if (karte_t::world->is_terminating_threads())
-		{
-			break;
-		}
-		if (convoi_t::current_unreserver == 0)
-		{
-			int error = pthread_mutex_unlock(&karte_t::unreserve_route_mutex);
-			assert(error == 0);
-			continue;
-		}
-
-		const uint32 max_count = weg_t::get_all_ways_count() - 1;
-		const uint32 fraction = max_count / karte_t::world->get_parallel_operations();
-
-		route_range_specification range;
-
-		range.start = thread_number * fraction;
-		if (thread_number == karte_t::world->get_parallel_operations() - 1)
-		{
-			range.end = max_count;
-		}
-		else
-		{
-			range.end = min(((thread_number + 1) * fraction - 1), max_count);
-		}
-
-		convoi_t::unreserve_route_range(range);
-
-		simthread_barrier_wait(&karte_t::unreserve_route_barrier);
-		
-	} while (!karte_t::world->is_terminating_threads());
-
-	pthread_exit(NULL);
-	return args;
-}
 #endif
 
 void karte_t::await_all_threads()
@@ -2036,7 +2279,6 @@ void karte_t::init_threads()
 	pthread_attr_setdetachstate(&thread_attributes, PTHREAD_CREATE_JOINABLE);
 
 	simthread_barrier_init(&private_car_barrier, NULL, parallel_operations + 1);
-	simthread_barrier_init(&karte_t::unreserve_route_barrier, NULL, parallel_operations + 2); // This and the next does not run concurrently with anything significant on the main thread, so the number of parallel operations need to be +1 compared to the others.
 	simthread_barrier_init(&step_passengers_and_mail_barrier, NULL, parallel_operations + 2); 
 	simthread_barrier_init(&step_convoys_barrier_external, NULL, 2);
 	simthread_barrier_init(&step_convoys_barrier_internal, NULL, parallel_operations + 1);	
@@ -2049,7 +2291,6 @@ void karte_t::init_threads()
 	pthread_mutex_init(&private_car_route_mutex, &mutex_attributes);
 	pthread_mutex_init(&step_passengers_and_mail_mutex, &mutex_attributes);
 	pthread_mutex_init(&path_explorer_await_mutex, &mutex_attributes);
-	pthread_mutex_init(&unreserve_route_mutex, &mutex_attributes);
 
 	pthread_t thread;
 	
@@ -2070,19 +2311,7 @@ void karte_t::init_threads()
 			}
 		}
 
-		// The next two need an extra thread compared with the others, as they do not run concurrently with anything non-trivial on the main thread
-		sint32* thread_number_unres = new sint32;
-		*thread_number_unres = i;
-		rc = pthread_create(&thread, &thread_attributes, &unreserve_route_threaded, (void*)thread_number_unres);
-		if (rc)
-		{
-			dbg->fatal("void karte_t::init_threads()", "Failed to create private car thread, error %d. See here for a translation of the error numbers: http://epydoc.sourceforge.net/stdlib/errno-module.html", rc);
-		}
-		else
-		{
-			unreserve_route_threads.append(thread);
-		}
-		
+		// The next one needs an extra thread compared with the others, as it does not run concurrently with anything non-trivial on the main thread
 #ifdef MULTI_THREAD_PASSENGER_GENERATION
 		sint32* thread_number_pass = new sint32;
 		*thread_number_pass = i + 1; // +1 because we need thread number 0 to represent the main thread.
@@ -2166,7 +2395,6 @@ void karte_t::destroy_threads()
 		simthread_barrier_wait(&step_passengers_and_mail_barrier);
 #endif
 		simthread_barrier_wait(&private_car_barrier);
-		simthread_barrier_wait(&unreserve_route_barrier);
 #ifdef MULTI_THREAD_PATH_EXPLORER
 		simthread_barrier_wait(&path_explorer_barrier);
 		pthread_join(path_explorer_thread, 0);
@@ -2184,8 +2412,6 @@ void karte_t::destroy_threads()
 		step_passengers_and_mail_threads.clear();
 #endif
 
-		clean_threads(&unreserve_route_threads);
-		unreserve_route_threads.clear();
 #ifdef MULTI_THREAD_CONVOYS
 		simthread_barrier_destroy(&step_convoys_barrier_external);
 		simthread_barrier_destroy(&step_convoys_barrier_internal);
@@ -2194,7 +2420,6 @@ void karte_t::destroy_threads()
 		simthread_barrier_destroy(&step_passengers_and_mail_barrier);
 #endif
 		simthread_barrier_destroy(&private_car_barrier);
-		simthread_barrier_destroy(&unreserve_route_barrier);
 #ifdef MULTI_THREAD_PATH_EXPLORER
 		simthread_barrier_destroy(&path_explorer_barrier);
 #endif 
@@ -2203,7 +2428,6 @@ void karte_t::destroy_threads()
 		pthread_mutex_destroy(&private_car_route_mutex);
 		pthread_mutex_destroy(&step_passengers_and_mail_mutex);
 		pthread_mutex_destroy(&path_explorer_await_mutex);
-		pthread_mutex_destroy(&unreserve_route_mutex);
 
 		pthread_mutexattr_destroy(&mutex_attributes);
 	}
@@ -2430,6 +2654,30 @@ void karte_t::flood_to_depth( sint8 new_water_height, sint8 *stage )
 }
 
 
+void karte_t::headlands_loop(sint16 x_min, sint16 x_max, sint16 y_min, sint16 y_max)
+{
+	for(  sint16 iy = y_min;  iy < y_max;  iy++  ) {
+		for(  sint16 ix = x_min;  ix < x_max;  ix++  ) {
+			koord k( ix, iy );
+			grund_t *gr = lookup_kartenboden_nocheck(k);
+			if(  !gr->is_water()  &&  gr->get_pos().z == groundwater  ) {
+				uint8 neighbour_water = 0;
+				for(  int i = 0;  i < 8;  i++  ) {
+					grund_t *gr2 = lookup_kartenboden( k + koord::neighbours[i] );
+					if(  !gr2  ||  gr2->is_water()  ) {
+						neighbour_water++;
+					}
+				}
+				// if a lot of water nearby we are a headland
+				if(  neighbour_water > 3  ) {
+					access_nocheck(k)->set_climate( get_climate_at_height( groundwater + 1 ) );
+				}
+			}
+		}
+	}
+}
+
+
 void karte_t::create_beaches(  int xoff, int yoff  )
 {
 	const uint16 size_x = get_size().x;
@@ -2474,23 +2722,12 @@ void karte_t::create_beaches(  int xoff, int yoff  )
 	}
 
 	// headlands should not have beaches at all
-	for(  uint16 iy = 0;  iy < size_y;  iy++  ) {
-		for(  uint16 ix = (iy >= yoff - 19) ? 0 : max( xoff - 19, 0 );  ix < size_x;  ix++  ) {
-			koord k( ix, iy );
-			grund_t *gr = lookup_kartenboden_nocheck(k);
-			if(  !gr->is_water()  &&  gr->get_pos().z == groundwater  ) {
-				uint8 neighbour_water = 0;
-				for(  int i = 0;  i < 8;  i++  ) {
-					grund_t *gr2 = lookup_kartenboden( k + koord::neighbours[i] );
-					if(  !gr2  ||  gr2->is_water()  ) {
-						neighbour_water++;
-					}
-				}
-				// if a lot of water nearby we are a headland
-				if(  neighbour_water > 3  ) {
-					access_nocheck(k)->set_climate( get_climate_at_height( groundwater + 1 ) );
-				}
-			}
+	if(  xoff == 0  &&  yoff == 0  ) {
+		world_xy_loop(&karte_t::headlands_loop, 0);
+	}
+	else {
+		for(  uint16 iy = 0;  iy < size_y;  iy++  ) {
+			headlands_loop( (iy >= yoff - 19) ? 0 : max( xoff - 19, 0 ), size_x, iy, iy + 1 );
 		}
 	}
 
@@ -2559,6 +2796,7 @@ void karte_t::enlarge_map(settings_t const* sets, sint8 const* const h_field)
 {
 	sint16 new_size_x = sets->get_size_x();
 	sint16 new_size_y = sets->get_size_y();
+	block_graph_t::clear();
 	//const sint32 map_size = max (new_size_x, new_size_y);
 
 	if(  cached_grid_size.y>0  &&  cached_grid_size.y!=new_size_y  ) {
@@ -2584,6 +2822,9 @@ void karte_t::enlarge_map(settings_t const* sets, sint8 const* const h_field)
 	cached_size.x = cached_grid_size.x-1;
 	cached_size.y = cached_grid_size.y-1;
 
+	// existing objects must be re-bucketed for the new size before new ones get added
+	rebuild_spatial_indices();
+
 	intr_disable();
 
 	bool reliefkarte = reliefkarte_t::is_visible;
@@ -2715,6 +2956,7 @@ void karte_t::enlarge_map(settings_t const* sets, sint8 const* const h_field)
 		for (sint16 iy = 0; iy<new_size_y; iy++) {
 			for (sint16 ix = (iy>=old_y)?0:old_x; ix<new_size_x; ix++) {
 				koord k(ix,iy);
+				tile_arena_t::set_position( k );
 				access_nocheck(k)->kartenboden_setzen( new boden_t( koord3d( ix, iy, max( min_hgt_nocheck(k), get_water_hgt_nocheck(k) ) ), 0 ) );
 			}
 		}
@@ -2739,11 +2981,14 @@ void karte_t::enlarge_map(settings_t const* sets, sint8 const* const h_field)
 	}
 
 	// set climates in new area and old map near seam
-	for(  sint16 iy = 0;  iy < new_size_y;  iy++  ) {
-		for(  sint16 ix = (iy >= old_y - 19) ? 0 : max( old_x - 19, 0 );  ix < new_size_x;  ix++  ) {
-			calc_climate( koord( ix, iy ), false );
+	if (  old_x > 0  &&  old_y > 0  ) {
+		for(  sint16 iy = 0;  iy < new_size_y;  iy++  ) {
+			calc_climate_loop( (iy >= old_y - 19) ? 0 : max( old_x - 19, 0 ), new_size_x, iy, iy + 1 );
 		}
 	}
+	else {
+		world_xy_loop(&karte_t::calc_climate_loop, 0);
+	}
 	if (  old_x == 0  &&  old_y == 0  ) {
 		ls.set_progress(14);
 	}
@@ -2933,6 +3178,7 @@ karte_t::karte_t() :
 	convoi_array(0),
 	world_attractions(16),
 	stadt(0),
+	max_fab_extent(0),
 	idle_time(0),
 	speed_factors_are_set(false)
 {
@@ -2947,6 +3193,7 @@ karte_t::karte_t() :
 	next_step_time = last_step_time = 0;
 	fix_ratio_frame_time = 200;
 	idle_time = 0;
+	walking_destinations_x = 0;
 	network_frame_count = 0;
 	sync_steps = 0;
 	sync_steps_barrier = sync_steps;
@@ -4301,12 +4548,40 @@ void karte_t::rotate90_plans(sint16 x_min, sint16 x_max, sint16 y_min, sint16 y_
 }
 
 
+void karte_t::rotate90_cities(uint32 first, uint32 last)
+{
+	for(  uint32 i = first;  i < last;  i++  ) {
+		stadt[i]->rotate90( cached_size.x );
+	}
+}
+
+
+void karte_t::rotate90_halts(uint32 first, uint32 last)
+{
+	const vector_tpl<halthandle_t> &halts = haltestelle_t::get_alle_haltestellen();
+	for(  uint32 i = first;  i < last;  i++  ) {
+		halts[i]->rotate90( cached_size.x );
+	}
+}
+
+
+void karte_t::rotate90_convoys(uint32 first, uint32 last)
+{
+	for(  uint32 i = first;  i < last;  i++  ) {
+		convoi_array[i]->rotate90( cached_size.x );
+	}
+}
+
+
 void karte_t::rotate90()
 {
 DBG_MESSAGE( "karte_t::rotate90()", "called" );
 	// Wait for any threaded work
 	await_all_threads();
 
+	// the sections of the signal blocks are built again for the new positions
+	block_graph_t::clear();
+
 	// assume we can save this rotation
 	nosave_warning = nosave = false;
 
@@ -4360,19 +4635,18 @@ DBG_MESSAGE( "karte_t::rotate90()", "called" );
 	cached_grid_size.x = cached_grid_size.y;
 	cached_grid_size.y = wx;
 
-	// now step all towns (to generate passengers)
-	FOR(weighted_vector_tpl<stadt_t*>, const i, stadt) {
-		i->rotate90(cached_size.x);
-	}
+	// the towns, halts and convoys only change themselves, so each of them is rotated in parallel
+	world_range_loop( &karte_t::rotate90_cities, stadt.get_count() );
 
 	//fixed order factory, halts, convois
+	// (factories update the halts nearby, so they stay in one thread)
 	FOR(vector_tpl<fabrik_t*>, const f, fab_list) {
 		f->rotate90(cached_size.x);
 	}
 	// after rotation of factories, rotate everything that holds freight: stations and convoys
-	FOR(vector_tpl<halthandle_t>, const s, haltestelle_t::get_alle_haltestellen()) {
-		s->rotate90(cached_size.x);
-	}
+	world_range_loop( &karte_t::rotate90_halts, haltestelle_t::get_alle_haltestellen().get_count() );
+	rebuild_spatial_indices();
+
 	for (uint32 i = 0; i < get_parallel_operations(); i++)
 	{
 		vector_tpl<transferring_cargo_t>& tcarray = transferring_cargoes[i];
@@ -4416,8 +4690,11 @@ DBG_MESSAGE( "karte_t::rotate90()", "called" );
 	}
 
 
+	world_range_loop( &karte_t::rotate90_convoys, convoi_array.get_count() );
+	// eventually correct freight destinations (and remove all stale freight)
+	// this updates the transit amounts of factories, and thus cannot be done in parallel
 	FOR(vector_tpl<convoihandle_t>, const i, convoi_array) {
-		i->rotate90(cached_size.x);
+		i->check_freight();
 	}
 
 	for(  int i=0;  i<MAX_PLAYER_COUNT;  i++  ) {
@@ -4449,10 +4726,8 @@ DBG_MESSAGE( "karte_t::rotate90()", "called" );
 	//  rotate map search array
 	factory_builder_t::new_world();
 
-	// update minimap
-	if(reliefkarte_t::is_visible) {
-		reliefkarte_t::get_karte()->set_mode( reliefkarte_t::get_karte()->get_mode() );
-	}
+	// update minimap (its layers hold the colours of the old orientation)
+	reliefkarte_t::get_karte()->calc_map();
 
 	get_scenario()->rotate90( cached_size.x );
 
@@ -4471,6 +4746,11 @@ bool karte_t::add_fab(fabrik_t *fab)
 	assert(fab != NULL);
 	//fab_list.insert( fab );
 	fab_list.append(fab);
+	fab_index.insert(fab->get_pos().get_2d(), fab);
+	if(  fab->get_desc()  &&  fab->get_desc()->get_building()  ) {
+		const koord size = fab->get_desc()->get_building()->get_size();
+		max_fab_extent = max( max_fab_extent, max(size.x, size.y) );
+	}
 	goods_in_game.clear(); // Force rebuild of goods list
 	return true;
 }
@@ -4486,6 +4766,7 @@ bool karte_t::rem_fab(fabrik_t *fab)
 	else
 	{
 		fab_list.remove(fab);
+		fab_index.remove(fab->get_pos().get_2d(), fab);
 	}
 
 	// Force rebuild of goods list
@@ -4538,6 +4819,7 @@ void karte_t::add_attraction(gebaeude_t *gb)
 {
 	assert(gb != NULL);
 	world_attractions.append(gb, gb->get_adjusted_visitor_demand());
+	attraction_index.insert(gb->get_pos().get_2d(), gb);
 }
 
 
@@ -4545,6 +4827,7 @@ void karte_t::remove_attraction(gebaeude_t *gb)
 {
 	assert(gb != NULL);
 	world_attractions.remove(gb);
+	attraction_index.remove(gb->get_pos().get_2d(), gb);
 	stadt_t* city = get_city(gb->get_pos().get_2d());
 	if(!city)
 	{
@@ -4553,6 +4836,225 @@ void karte_t::remove_attraction(gebaeude_t *gb)
 }
 
 
+void karte_t::rebuild_spatial_indices()
+{
+	const koord size(cached_grid_size.x, cached_grid_size.y);
+
+	fab_index.init(size);
+	max_fab_extent = 0;
+	FOR(vector_tpl<fabrik_t*>, const fab, fab_list) {
+		fab_index.insert(fab->get_pos().get_2d(), fab);
+		if(  fab->get_desc()  &&  fab->get_desc()->get_building()  ) {
+			const koord fab_size = fab->get_desc()->get_building()->get_size();
+			max_fab_extent = max( max_fab_extent, max(fab_size.x, fab_size.y) );
+		}
+	}
+
+	attraction_index.init(size);
+	FOR(weighted_vector_tpl<gebaeude_t*>, const gb, world_attractions) {
+		attraction_index.insert(gb->get_pos().get_2d(), gb);
+	}
+
+	city_index.init(size);
+	FOR(weighted_vector_tpl<stadt_t*>, const city, stadt) {
+		city_index.insert(city->get_pos(), city);
+	}
+
+	halt_index.init(size);
+	FOR(vector_tpl<halthandle_t>, const halt, haltestelle_t::get_alle_haltestellen()) {
+		halt_index.insert(halt->get_init_pos(), halt);
+	}
+
+	// a building may be a destination of several kinds, but must be indexed only once
+	vector_tpl<gebaeude_t *> destinations( mail_origins_and_targets.get_count() );
+	FOR(weighted_vector_tpl<gebaeude_t*>, const gb, mail_origins_and_targets) {
+		destinations.append(gb);
+	}
+	for(  uint8 i = 0;  commuter_targets  &&  i < goods_manager_t::passengers->get_number_of_classes();  i++  ) {
+		FOR(weighted_vector_tpl<gebaeude_t*>, const gb, commuter_targets[i]) {
+			destinations.append(gb);
+		}
+		FOR(weighted_vector_tpl<gebaeude_t*>, const gb, visitor_targets[i]) {
+			destinations.append(gb);
+		}
+	}
+	std::sort( destinations.begin(), destinations.end() );
+	destination_index.init(size);
+	for(  uint32 i = 0;  i < destinations.get_count();  i++  ) {
+		if(  i == 0  ||  destinations[i] != destinations[i - 1]  ) {
+			destination_index.insert(destinations[i]->get_pos().get_2d(), destinations[i]);
+		}
+	}
+
+	clear_walking_destinations();
+	walking_destinations_x = (size.x + walking_destinations_t::REGION_SIZE - 1) >> walking_destinations_t::REGION_SHIFT;
+	const sint32 regions_y = (size.y + walking_destinations_t::REGION_SIZE - 1) >> walking_destinations_t::REGION_SHIFT;
+	for(  sint32 i = 0;  i < walking_destinations_x * regions_y;  i++  ) {
+		walking_destinations.append( new walking_destinations_t() );
+	}
+}
+
+
+void karte_t::clear_walking_destinations()
+{
+	FOR(vector_tpl<walking_destinations_t *>, const wd, walking_destinations) {
+		delete wd;
+	}
+	walking_destinations.clear();
+}
+
+
+void karte_t::invalidate_walking_destinations(koord pos)
+{
+	if(  walking_destinations.empty()  ) {
+		return;
+	}
+	const uint32 max_distance = get_max_walking_distance();
+	const sint32 radius = max_distance < 0x7FFF ? (sint32)max_distance : 0x7FFF;
+	const sint32 regions_y = walking_destinations.get_count() / walking_destinations_x;
+	const sint32 x0 = max( 0, (pos.x - radius) >> walking_destinations_t::REGION_SHIFT );
+	const sint32 y0 = max( 0, (pos.y - radius) >> walking_destinations_t::REGION_SHIFT );
+	const sint32 x1 = min( walking_destinations_x - 1, (pos.x + radius) >> walking_destinations_t::REGION_SHIFT );
+	const sint32 y1 = min( regions_y - 1, (pos.y + radius) >> walking_destinations_t::REGION_SHIFT );
+	for(  sint32 y = y0;  y <= y1;  y++  ) {
+		for(  sint32 x = x0;  x <= x1;  x++  ) {
+			walking_destinations[y * walking_destinations_x + x]->dirty = true;
+		}
+	}
+}
+
+
+uint32 karte_t::get_max_walking_distance() const
+{
+	// the largest tolerance is that of a trip with the most onward journeys;
+	// walking tolerances never exceed the journey's tolerance (see generate_passengers_or_mail)
+	const uint32 min_commuting_tolerance = settings.get_min_commuting_tolerance();
+	const uint32 range_commuting_tolerance = max(0, settings.get_range_commuting_tolerance() - min_commuting_tolerance);
+	const uint32 min_visiting_tolerance = settings.get_min_visiting_tolerance();
+	const uint32 range_visiting_tolerance = max(0, settings.get_range_visiting_tolerance() - min_visiting_tolerance);
+	const uint64 onward_trips = max(1, settings.get_max_onward_trips());
+	const uint64 max_commuting_tolerance = range_commuting_tolerance + min_commuting_tolerance * onward_trips;
+	const uint64 max_visiting_tolerance = range_visiting_tolerance + min_visiting_tolerance * onward_trips;
+	const uint64 max_tolerance = max_commuting_tolerance > max_visiting_tolerance ? max_commuting_tolerance : max_visiting_tolerance;
+
+	// make sure that the speed factors are set
+	walking_time_tenths_from_distance(0);
+	if(  walking_numerator == 0  ) {
+		return UINT32_MAX_VALUE;
+	}
+	// invert walking_time_tenths_from_distance(), erring on the far side
+	const uint64 distance = ((max_tolerance + 1) << movement_denominator_shift) / walking_numerator + 1;
+	return distance < UINT32_MAX_VALUE ? (uint32)distance : UINT32_MAX_VALUE;
+}
+
+
+uint32 karte_t::get_destination_weight(const gebaeude_t *gb, uint8 trip, uint8 g_class) const
+{
+	const building_desc_t *building = gb->get_tile()->get_desc();
+	const uint8 number_of_classes = goods_manager_t::passengers->get_number_of_classes();
+	switch(  trip  ) {
+		case commuting_trip:
+			if(  building->get_class_proportions_sum_jobs() > 0  ) {
+				return gb->get_adjusted_jobs() * building->get_class_proportion_jobs(g_class) / building->get_class_proportions_sum_jobs();
+			}
+			return gb->get_adjusted_jobs() / number_of_classes;
+
+		case visiting_trip:
+			if(  building->get_class_proportions_sum() > 0  ) {
+				return gb->get_adjusted_visitor_demand() * building->get_class_proportion(g_class) / building->get_class_proportions_sum();
+			}
+			return gb->get_adjusted_visitor_demand() / number_of_classes;
+
+		default:
+			return gb->get_adjusted_mail_demand();
+	}
+}
+
+
+karte_t::walking_destinations_t *karte_t::get_walking_destinations(koord pos)
+{
+	if(  !is_within_limits(pos)  ||  walking_destinations.empty()  ) {
+		return NULL;
+	}
+	const uint32 radius = get_max_walking_distance();
+	const koord region( pos.x >> walking_destinations_t::REGION_SHIFT, pos.y >> walking_destinations_t::REGION_SHIFT );
+	const sint64 lo_x = ((sint64)region.x << walking_destinations_t::REGION_SHIFT) - radius;
+	const sint64 lo_y = ((sint64)region.y << walking_destinations_t::REGION_SHIFT) - radius;
+	const sint64 ru_x = ((sint64)(region.x + 1) << walking_destinations_t::REGION_SHIFT) - 1 + radius;
+	const sint64 ru_y = ((sint64)(region.y + 1) << walking_destinations_t::REGION_SHIFT) - 1 + radius;
+	if(  lo_x <= 0  &&  lo_y <= 0  &&  ru_x >= cached_grid_size.x  &&  ru_y >= cached_grid_size.y  ) {
+		// everything is in walking range: the global lists are just as good
+		return NULL;
+	}
+
+	walking_destinations_t *wd = walking_destinations[region.y * walking_destinations_x + region.x];
+#ifdef MULTI_THREAD
+	// only the other passenger generation threads may want this block at the same time
+	int mutex_error = pthread_mutex_lock(&wd->rebuild_mutex);
+	assert(mutex_error == 0);
+#endif
+	if(  !wd->dirty  &&  wd->radius == radius  ) {
+#ifdef MULTI_THREAD
+		mutex_error = pthread_mutex_unlock(&wd->rebuild_mutex);
+		assert(mutex_error == 0);
+#endif
+		return wd;
+	}
+
+	const uint8 number_of_classes = goods_manager_t::passengers->get_number_of_classes();
+	if(  !wd->commuter_targets  ) {
+		wd->commuter_targets = new weighted_vector_tpl<gebaeude_t *>[number_of_classes];
+		wd->visitor_targets = new weighted_vector_tpl<gebaeude_t *>[number_of_classes];
+	}
+
+	vector_tpl<gebaeude_t *> candidates;
+	const koord lo( (sint16)(lo_x > 0 ? lo_x : 0), (sint16)(lo_y > 0 ? lo_y : 0) );
+	const koord ru( (sint16)(ru_x < cached_grid_size.x ? ru_x : cached_grid_size.x), (sint16)(ru_y < cached_grid_size.y ? ru_y : cached_grid_size.y) );
+	destination_index.find_in_area( lo, ru, candidates );
+	// the index order depends on the history of insertions, so sort to give the same result on every client
+	std::sort( candidates.begin(), candidates.end(), stadt_t::compare_gebaeude_pos );
+
+	for(  uint8 i = 0;  i < number_of_classes;  i++  ) {
+		wd->commuter_targets[i].clear();
+		wd->visitor_targets[i].clear();
+		FOR(vector_tpl<gebaeude_t *>, const gb, candidates) {
+			wd->commuter_targets[i].append( gb, get_destination_weight(gb, commuting_trip, i) );
+			wd->visitor_targets[i].append( gb, get_destination_weight(gb, visiting_trip, i) );
+		}
+	}
+	wd->mail_targets.clear();
+	FOR(vector_tpl<gebaeude_t *>, const gb, candidates) {
+		wd->mail_targets.append( gb, get_destination_weight(gb, mail_trip, 0) );
+	}
+
+	wd->radius = radius;
+	wd->dirty = false;
+#ifdef MULTI_THREAD
+	mutex_error = pthread_mutex_unlock(&wd->rebuild_mutex);
+	assert(mutex_error == 0);
+#endif
+	return wd;
+}
+
+
+void karte_t::get_factories_in_area(koord lo, koord ru, vector_tpl<fabrik_t *> &result) const
+{
+	// factories are indexed by their origin, so look a bit further to the north west
+	vector_tpl<fabrik_t *> candidates;
+	fab_index.find_in_area( lo - koord(max_fab_extent, max_fab_extent), ru, candidates );
+	FOR(vector_tpl<fabrik_t*>, const fab, candidates) {
+		const koord pos = fab->get_pos().get_2d();
+		koord size(1, 1);
+		if(  fab->get_desc()  &&  fab->get_desc()->get_building()  ) {
+			size = fab->get_desc()->get_building()->get_size(fab->get_rotate());
+		}
+		if(  pos.x <= ru.x  &&  pos.y <= ru.y  &&  pos.x + size.x - 1 >= lo.x  &&  pos.y + size.y - 1 >= lo.y  ) {
+			result.append_unique(fab);
+		}
+	}
+}
+
+
 // -------- Verwaltung von Staedten -----------------------------
 // "look for next city" (Babelfish)
 
@@ -4684,6 +5186,7 @@ void karte_t::sync_list_t::sync_step(uint32 delta_t)
  */
 void karte_t::sync_step(uint32 delta_t, bool do_sync_step, bool display )
 {
+	step_profiler_scope_t profile_scope(step_profiler_t::SYNC_STEP);
 rands[0] = get_random_seed();
 rands[2] = 0;
 rands[3] = 0;
@@ -4895,8 +5398,23 @@ inline sint32 get_population(stadt_t const* const c)
 }
 
 
+// the ways worn out by this month's wear, indexed like weg_t::get_alle_wege()
+static vector_tpl<uint8> worn_ways;
+
+
+void karte_t::wear_ways_loop(uint32 first, uint32 last)
+{
+	const vector_tpl<weg_t *> &ways = weg_t::get_alle_wege();
+	for(  uint32 i = first;  i < last;  i++  ) {
+		worn_ways[i] = ways[i]->apply_monthly_wear();
+	}
+}
+
+
 void karte_t::new_month()
 {
+	step_profiler_scope_t profile_scope(step_profiler_t::NEW_MONTH);
+
 	update_history();
 
 	// advance history ...
@@ -4918,8 +5436,16 @@ void karte_t::new_month()
 
 	// this should be done before a map update, since the map may want an update of the way usage
 //	DBG_MESSAGE("karte_t::new_month()","ways");
-	FOR(vector_tpl<weg_t*>, const w, weg_t::get_alle_wege()) {
-		w->new_month();
+	weg_t::next_statistics_month();
+	const uint32 way_count = weg_t::get_alle_wege().get_count();
+	worn_ways.resize( way_count );
+	worn_ways.set_count( way_count );
+	world_range_loop( &karte_t::wear_ways_loop, way_count );
+	// renewing may cost money and rebuild, so this is done in the same order as before
+	for(  uint32 i = 0;  i < way_count;  i++  ) {
+		if(  worn_ways[i]  ) {
+			weg_t::get_alle_wege()[i]->new_month();
+		}
 	}
 
 	// recalc old settings (and maybe update the stops with the current values)
@@ -5304,6 +5830,10 @@ void karte_t::set_schedule_counter()
 
 void karte_t::step()
 {
+	// the summary of the previous step includes the sync steps since then
+	step_profiler_t::end_step(steps);
+	step_profiler_scope_t profile_scope(step_profiler_t::STEP);
+
 	rands[8] = get_random_seed();
 	DBG_DEBUG4("karte_t::step", "start step");
 	uint32 time = dr_time();
@@ -5401,6 +5931,7 @@ void karte_t::step()
 		cities_to_process = min(cities_awaiting_private_car_route_check.get_count() - 1, parallel_operations);
 		simthread_barrier_wait(&private_car_barrier); // One wait barrier to activate all the private car checker threads, the second to wait until they have all finished. This is the first.
 #else			
+		step_profiler_scope_t profile_scope(step_profiler_t::PRIVATE_CAR_ROUTES);
 		const uint32 cities_to_process = min(cities_awaiting_private_car_route_check.get_count() - 1, parallel_operations);
 		for (uint32 j = 0; j < cities_to_process; j++)
 		{
@@ -5419,6 +5950,7 @@ void karte_t::step()
 	const bool season_change = pending_season_change > 0;
 	const bool snowline_change = pending_snowline_change > 0;
 	if(  season_change  ||  snowline_change  ) {
+		step_profiler_scope_t profile_scope(step_profiler_t::SEASONS);
 		DBG_DEBUG4("karte_t::step", "pending_season_change");
 		// process
 		const uint32 end_count = min( cached_grid_size.x * cached_grid_size.y,  tile_counter + max( 16384, cached_grid_size.x * cached_grid_size.y / 16 ) );
@@ -5450,8 +5982,11 @@ void karte_t::step()
 	// Stop the path explorer before we use its results.
 	await_path_explorer();
 #else
-	// Knightly : calling global path explorer
-	path_explorer_t::step();
+	{
+		// Knightly : calling global path explorer
+		step_profiler_scope_t profile_scope(step_profiler_t::PATH_EXPLORER);
+		path_explorer_t::step();
+	}
 #endif
 	rands[12] = get_random_seed();
 	
@@ -5461,21 +5996,27 @@ void karte_t::step()
 	// Finish the threaded part of the convoys' steps: this is mainly route searches. Block reservation, etc., is in the single threaded part. 
 	await_convoy_threads();
 #else
-	for (uint32 i = convoi_array.get_count(); i-- != 0;)
 	{
-		convoihandle_t cnv = convoi_array[i];
-		cnv->threaded_step();
+		step_profiler_scope_t profile_scope(step_profiler_t::CONVOYS_THREADED);
+		for (uint32 i = convoi_array.get_count(); i-- != 0;)
+		{
+			convoihandle_t cnv = convoi_array[i];
+			cnv->threaded_step();
+		}
 	}
 #endif
 	
 	// The more computationally intensive parts of this have been extracted and made multi-threaded.
 	DBG_DEBUG4("karte_t::step 4", "step %d convois", convoi_array.get_count());
-	// since convois will be deleted during stepping, we need to step backwards
-	for (uint32 i = convoi_array.get_count(); i-- != 0;) {
-		convoihandle_t cnv = convoi_array[i];
-		cnv->step();
-		if((i&7)==0) {
-			INT_CHECK("karte_t::step 3");
+	{
+		step_profiler_scope_t profile_scope(step_profiler_t::CONVOYS);
+		// since convois will be deleted during stepping, we need to step backwards
+		for (uint32 i = convoi_array.get_count(); i-- != 0;) {
+			convoihandle_t cnv = convoi_array[i];
+			cnv->step();
+			if((i&7)==0) {
+				INT_CHECK("karte_t::step 3");
+			}
 		}
 	}
 
@@ -5488,10 +6029,13 @@ void karte_t::step()
 	// now step all towns 
 	// This is not very computationally intensive at present, but might become more so when town growth is reworked.
 	DBG_DEBUG4("karte_t::step 6", "step cities");
-	FOR(weighted_vector_tpl<stadt_t*>, const i, stadt) {
-		i->step(delta_t);
-		rands[21] += i->get_einwohner();
-		rands[22] += i->get_buildings();
+	{
+		step_profiler_scope_t profile_scope(step_profiler_t::CITIES);
+		FOR(weighted_vector_tpl<stadt_t*>, const i, stadt) {
+			i->step(delta_t);
+			rands[21] += i->get_einwohner();
+			rands[22] += i->get_buildings();
+		}
 	}
 	rands[14] = get_random_seed();
 
@@ -5580,7 +6124,10 @@ void karte_t::step()
 	INT_CHECK("karte_t::step 4");
 
 	// This does nothing if the threading is disabled.
-	await_passengers_and_mail_threads();
+	{
+		step_profiler_scope_t profile_scope(step_profiler_t::AWAIT_PASSENGERS_AND_MAIL);
+		await_passengers_and_mail_threads();
+	}
 
 #ifdef MULTI_THREAD
 	// This is necessary in network mode to ensure that all cars set in motion
@@ -5644,8 +6191,11 @@ void karte_t::step()
 	INT_CHECK("karte_t::step 5");
 
 	DBG_DEBUG4("karte_t::step", "step factories");
-	FOR(vector_tpl<fabrik_t*>, const f, fab_list) {
-		f->step(delta_t);
+	{
+		step_profiler_scope_t profile_scope(step_profiler_t::FACTORIES);
+		FOR(vector_tpl<fabrik_t*>, const f, fab_list) {
+			f->step(delta_t);
+		}
 	}
 	rands[16] = get_random_seed();
 
@@ -5654,9 +6204,12 @@ void karte_t::step()
 	// step powerlines - required order: pumpe, senke, then powernet
 	// This is not computationally intensive.
 	DBG_DEBUG4("karte_t::step", "step poweline stuff");
-	pumpe_t::step_all( delta_t );
-	senke_t::step_all( delta_t );
-	powernet_t::step_all( delta_t );
+	{
+		step_profiler_scope_t profile_scope(step_profiler_t::POWERNET);
+		pumpe_t::step_all( delta_t );
+		senke_t::step_all( delta_t );
+		powernet_t::step_all( delta_t );
+	}
 	rands[17] = get_random_seed();
 
 	INT_CHECK("karte_t::step 6");
@@ -5664,9 +6217,12 @@ void karte_t::step()
 	DBG_DEBUG4("karte_t::step", "step players");
 	// then step all players
 	// This is not computationally intensive (except possibly occasionally when liquidating a company)
-	for(  int i=0;  i<MAX_PLAYER_COUNT;  i++  ) {
-		if(  players[i] != NULL  ) {
-			players[i]->step();
+	{
+		step_profiler_scope_t profile_scope(step_profiler_t::PLAYERS);
+		for(  int i=0;  i<MAX_PLAYER_COUNT;  i++  ) {
+			if(  players[i] != NULL  ) {
+				players[i]->step();
+			}
 		}
 	}
 	rands[18] = get_random_seed();
@@ -5675,7 +6231,10 @@ void karte_t::step()
 
 	// This is not computationally intensive
 	DBG_DEBUG4("karte_t::step", "step halts");
-	haltestelle_t::step_all();
+	{
+		step_profiler_scope_t profile_scope(step_profiler_t::HALTS);
+		haltestelle_t::step_all();
+	}
 	rands[19] = get_random_seed();
 
 	// Re-check paths if the time has come. 
@@ -5687,12 +6246,21 @@ void karte_t::step()
 	// This is not the computationally intensive bit of the path explorer.
 	if((steps % get_settings().get_reroute_check_interval_steps()) == 0)
 	{
+		step_profiler_scope_t profile_scope(step_profiler_t::REROUTE);
 		path_explorer_t::refresh_all_categories(false);
 	}
 	
 	INT_CHECK("karte_t::step 8");
 
-	check_transferring_cargoes();
+	{
+		step_profiler_scope_t profile_scope(step_profiler_t::TRANSFERRING_CARGOES);
+		check_transferring_cargoes();
+	}
+
+	if(  env_t::networkmode  &&  steps > 0  &&  (steps % WORLD_HASH_INTERVAL) == 0  ) {
+		// before the threads start again, so the state is the same everywhere
+		calc_world_hash();
+	}
 
 #ifdef MULTI_THREAD_PATH_EXPLORER
 	// Start the path explorer ready for the next step. This can be very 
@@ -5720,7 +6288,10 @@ void karte_t::step()
 	recalc_season_snowline(true);
 
 	// This is not particularly computationally intensive.
-	step_time_interval_signals();
+	{
+		step_profiler_scope_t profile_scope(step_profiler_t::TIME_INTERVAL_SIGNALS);
+		step_time_interval_signals();
+	}
 
 	/** END OF THREADABLE AREA **/
 
@@ -5805,6 +6376,7 @@ sint32 karte_t::calc_adjusted_step_interval(const uint32 weight, uint32 trips_pe
 
 void karte_t::step_passengers_and_mail(uint32 delta_t)
 {
+	step_profiler_scope_t profile_scope(step_profiler_t::PASSENGERS_AND_MAIL);
 	if(delta_t > ticks_per_world_month) 
 	{
 		delta_t = 1;
@@ -6205,7 +6777,13 @@ sint32 karte_t::generate_passengers_or_mail(const goods_desc_t * wtyp)
 			pax.comfort_preference_percentage = simrand(settings.get_max_comfort_preference_percentage() - 100, "karte_t::generate_passengers_and_mail (comfort_preference_percentage)") + 100;
 		}
 
-		first_destination = find_destination(trip, pax.get_class());
+		// Without a private car or a nearby stop, only destinations within walking range are reachable.
+#ifdef MULTI_THREAD
+		const koord walking_origin = !has_private_car && start_halts[passenger_generation_thread_number].empty() ? origin_pos.get_2d() : koord::invalid;
+#else
+		const koord walking_origin = !has_private_car && start_halts.empty() ? origin_pos.get_2d() : koord::invalid;
+#endif
+		first_destination = find_destination(trip, pax.get_class(), walking_origin);
 		current_destination = first_destination;
 
 		if(trip == commuting_trip)
@@ -6313,7 +6891,7 @@ sint32 karte_t::generate_passengers_or_mail(const goods_desc_t * wtyp)
 					*/
 					if (n < destination_count - 1)
 					{
-						current_destination = find_destination(trip, pax.get_class());
+						current_destination = find_destination(trip, pax.get_class(), walking_origin);
 
 						if (extend_count < destination_count * 4)
 						{
@@ -6349,7 +6927,7 @@ sint32 karte_t::generate_passengers_or_mail(const goods_desc_t * wtyp)
 
 						if (n < destination_count + extend_count - 1)
 						{
-							current_destination = find_destination(trip, pax.get_class());
+							current_destination = find_destination(trip, pax.get_class(), walking_origin);
 						}
 						continue;
 					}
@@ -6379,7 +6957,7 @@ sint32 karte_t::generate_passengers_or_mail(const goods_desc_t * wtyp)
 				*/
 				if (n < destination_count + extend_count - 1)
 				{
-					current_destination = find_destination(trip, pax.get_class());
+					current_destination = find_destination(trip, pax.get_class(), walking_origin);
 				}
 				continue;
 			}
@@ -6746,7 +7324,7 @@ sint32 karte_t::generate_passengers_or_mail(const goods_desc_t * wtyp)
 				// or if this is the last destination to be assigned,
 				// or else entirely the wrong information will be recorded
 				// below!
-				current_destination = find_destination(trip, pax.get_class());
+				current_destination = find_destination(trip, pax.get_class(), walking_origin);
 			}
 
 		} // For loop (route_status)
@@ -7338,26 +7916,46 @@ return_on_foot:
 	return (sint32)units_this_step;
 }
 
-karte_t::destination karte_t::find_destination(trip_type trip, uint8 g_class)
+karte_t::destination karte_t::find_destination(trip_type trip, uint8 g_class, koord walking_origin)
 {
 	destination current_destination;
 	current_destination.type = karte_t::invalid;
-	gebaeude_t* gb;
+	gebaeude_t* gb = NULL;
+	bool found = false;
 
-	switch(trip)
+	if(walking_origin != koord::invalid && settings.get_local_walking_destinations())
 	{
-	case commuting_trip: 
-		gb = pick_any_weighted(commuter_targets[g_class]);
-		break;
+		// The lists are built on demand and shared by all passenger generation threads.
+		const walking_destinations_t* wd = get_walking_destinations(walking_origin);
+		if(wd)
+		{
+			const weighted_vector_tpl<gebaeude_t*>& targets = trip == commuting_trip ? wd->commuter_targets[g_class] : trip == visiting_trip ? wd->visitor_targets[g_class] : wd->mail_targets;
+			// If nothing is within walking range, fall back to the global lists as before.
+			if(!targets.empty())
+			{
+				gb = pick_any_weighted(targets);
+				found = true;
+			}
+		}
+	}
 
-	case visiting_trip:
-		gb = pick_any_weighted(visitor_targets[g_class]);
-		break;
+	if(!found)
+	{
+		switch(trip)
+		{
+		case commuting_trip:
+			gb = pick_any_weighted(commuter_targets[g_class]);
+			break;
+
+		case visiting_trip:
+			gb = pick_any_weighted(visitor_targets[g_class]);
+			break;
 
-	default:
-	case mail_trip:
-		gb = pick_any_weighted(mail_origins_and_targets);
-	};
+		default:
+		case mail_trip:
+			gb = pick_any_weighted(mail_origins_and_targets);
+		};
+	}
 	if(!gb)
 	{
 		// Might happen if the relevant collection object is empty.		
@@ -8676,6 +9274,9 @@ void karte_t::load(loadsave_t *file)
 		for(  int i=0;  i<LAST_CHECKLISTS_COUNT;  ++i  ) {
 			last_checklists[i] = checklist_t();
 		}
+		for(  int i=0;  i<LAST_WORLD_HASHES_COUNT;  ++i  ) {
+			last_world_hashes[i] = world_hash_t();
+		}
 		for(  int i = 0;  i < CHK_RANDS  ;  i++  ) {
 			rands[i] = 0;
 		}
@@ -9101,6 +9702,9 @@ DBG_MESSAGE("karte_t::load()", "laden_abschliesen for tiles finished" );
 		f->finish_rd();
 	}
 
+	// all factories, attractions, towns and stops are known now
+	rebuild_spatial_indices();
+
 DBG_MESSAGE("karte_t::load()", "%d factories loaded", fab_list.get_count());
 
 	ls.set_progress( (get_size().y*3)/2+256+get_size().y/3 );
@@ -9126,6 +9730,13 @@ DBG_MESSAGE("karte_t::load()", "%d factories loaded", fab_list.get_count());
 
 	ls.set_progress( (get_size().y*3)/2+256+(get_size().y*3)/8 );
 
+	// the ways were loaded before the convoys, so only now can the convoys learn which tiles they have reserved
+	FOR(vector_tpl<weg_t*>, const w, weg_t::get_alle_wege()) {
+		if(  w->is_rail_type()  ||  w->get_waytype() == air_wt  ) {
+			((schiene_t *)w)->finish_rd_reservation();
+		}
+	}
+
 	// adding lines and other stuff for convois
 	for(unsigned i=0;  i<convoi_array.get_count();  i++ ) {
 		convoihandle_t cnv = convoi_array[i];
@@ -9564,6 +10175,16 @@ void karte_t::calc_climate(koord k, bool recalc)
 }
 
 
+void karte_t::calc_climate_loop(sint16 x_min, sint16 x_max, sint16 y_min, sint16 y_max)
+{
+	for(  sint16 iy = y_min;  iy < y_max;  iy++  ) {
+		for(  sint16 ix = x_min;  ix < x_max;  ix++  ) {
+			calc_climate( koord( ix, iy ), false );
+		}
+	}
+}
+
+
 // fills array with neighbour heights
 void karte_t::get_neighbour_heights(const koord k, sint8 neighbour_height[8][4]) const
 {
@@ -9725,6 +10346,7 @@ void karte_t::create_grounds_loop( sint16 x_min, sint16 x_max, sint16 y_min, sin
 	for(  int y = y_min;  y < y_max;  y++  ) {
 		for(  int x = x_min; x < x_max;  x++  ) {
 			koord k(x,y);
+			tile_arena_t::set_position( k );
 			access_nocheck(k)->kartenboden_setzen( new boden_t( koord3d( x, y, max(min_hgt_nocheck(k),get_water_hgt_nocheck(k)) ), 0 ) );
 		}
 	}
@@ -10296,7 +10918,26 @@ void karte_t::do_network_world_command(network_world_command_t *nwc)
 		const int offset2 = offset + client_checklist.print(buf + offset, "client");
 		assert(offset2 < 2048);
 		dbg->warning("karte_t:::do_network_world_command", "sync_step=%u  %s", server_sync_step, buf);
-		if(client_checklist != server_checklist) {
+
+		// which parts of the world went out of sync?
+		const world_hash_t &server_hash = nwcheck->server_world_hash;
+		const world_hash_t *client_hash = get_world_hash_at(server_hash.st);
+		uint32 diverged = 0;
+		if(  client_hash  ) {
+			diverged = client_hash->get_diverged(server_hash);
+			if(  diverged  ) {
+				const int offset = server_hash.print(buf, "server");
+				client_hash->print(buf + offset, "client");
+				dbg->warning("karte_t:::do_network_world_command", "world hash mismatch %s", buf);
+				for(  uint8 i = 0;  i < world_hash_t::MAX_WORLD_HASHES;  i++  ) {
+					if(  diverged & (1u << i)  ) {
+						dbg->warning("karte_t:::do_network_world_command", "%s out of sync at step %u", world_hash_t::get_name(i), server_hash.st);
+					}
+				}
+			}
+		}
+
+		if(client_checklist != server_checklist  ||  diverged) {
 			dbg->warning("karte_t:::do_network_world_command", "disconnecting due to checklist mismatch" );
 			network_disconnect();
 		}
@@ -10357,6 +10998,40 @@ sint16 karte_t::get_sound_id(grund_t *gr)
 }
 
 
+checklist_t karte_t::run_benchmark(uint32 max_steps, uint32 max_months)
+{
+	// the same seed as a client joining a network game would use
+	setsimrand(settings.get_random_counter(), 0xFFFFFFFFu);
+
+	const uint32 quit_month = max_months > 0 ? get_current_month() + max_months : 0x7FFFFFFFu;
+	const sint64 last_step = max_steps > 0 ? (sint64)steps + max_steps : 0x7FFFFFFF;
+	const uint32 frame_delta = (fix_ratio_frame_time * time_multiplier) / 16;
+
+	// no pause, no fast forward timing, no network
+	const uint8 old_step_mode = step_mode;
+	step_mode = FIX_RATIO;
+	network_frame_count = 0;
+	sync_steps = steps * settings.get_frames_per_step();
+
+	while(  steps < last_step  &&  get_current_month() < quit_month  &&  !env_t::quit_simutrans  &&  !finish_loop  ) {
+		sync_step( frame_delta, true, false );
+		if(  ++network_frame_count == settings.get_frames_per_step()  ) {
+			set_random_mode( STEP_RANDOM );
+			step();
+			clear_random_mode( STEP_RANDOM );
+			network_frame_count = 0;
+		}
+		sync_steps = steps * settings.get_frames_per_step() + network_frame_count;
+	}
+
+	// let the threads finish this step, so that the results do not depend on their timing
+	await_all_threads();
+	step_mode = old_step_mode;
+
+	return checklist_t(sync_steps, (uint32)steps, network_frame_count, get_random_seed(), halthandle_t::get_next_check(), linehandle_t::get_next_check(), convoihandle_t::get_next_check(), rands, debug_sums);
+}
+
+
 bool karte_t::interactive(uint32 quit_month)
 {
 
@@ -10378,6 +11053,9 @@ bool karte_t::interactive(uint32 quit_month)
 		for(  int i=0;  i<LAST_CHECKLISTS_COUNT;  ++i  ) {
 			last_checklists[i] = checklist_t();
 		}
+		for(  int i=0;  i<LAST_WORLD_HASHES_COUNT;  ++i  ) {
+			last_world_hashes[i] = world_hash_t();
+		}
 	}
 	sint32 ms_difference = 0;
 	reset_timer();
@@ -10505,7 +11183,7 @@ bool karte_t::interactive(uint32 quit_month)
 								dbg->warning("karte_t::interactive", "server lagging by %lli", timelag );
 							}
 
-							nwc_check_t* nwc = new nwc_check_t(sync_steps + 1, map_counter, LCHKLST(sync_steps), sync_steps);
+							nwc_check_t* nwc = new nwc_check_t(sync_steps + 1, map_counter, LCHKLST(sync_steps), sync_steps, get_last_world_hash());
 							network_send_all(nwc, true);
 						}
 						else {
@@ -10863,68 +11541,19 @@ void karte_t::add_building_to_world_list(gebaeude_t *gb, bool ordered)
 
 	if(ordered)
 	{
-		
-		if (building->get_class_proportions_sum() > 0)
-		{
-			for (uint8 i = 0; i < number_of_classes; i++)
-			{
-				visitor_targets[i].insert_ordered(gb, gb->get_adjusted_visitor_demand() * building->get_class_proportion(i) / building->get_class_proportions_sum(), stadt_t::compare_gebaeude_pos);
-			}
-		}
-		else
-		{
-			for (uint8 i = 0; i < number_of_classes; i++)
-			{
-				visitor_targets[i].insert_ordered(gb, gb->get_adjusted_visitor_demand() / number_of_classes, stadt_t::compare_gebaeude_pos);
-			}
-		}
-
-		if (building->get_class_proportions_sum_jobs() > 0)
+		for (uint8 i = 0; i < number_of_classes; i++)
 		{
-			for (uint8 i = 0; i < number_of_classes; i++)
-			{
-				commuter_targets[i].insert_ordered(gb, gb->get_adjusted_jobs() * building->get_class_proportion_jobs(i) / building->get_class_proportions_sum_jobs(), stadt_t::compare_gebaeude_pos);
-			}
+			visitor_targets[i].insert_ordered(gb, get_destination_weight(gb, visiting_trip, i), stadt_t::compare_gebaeude_pos);
+			commuter_targets[i].insert_ordered(gb, get_destination_weight(gb, commuting_trip, i), stadt_t::compare_gebaeude_pos);
 		}
-		else
-		{
-			for (uint8 i = 0; i < number_of_classes; i++)
-			{
-				commuter_targets[i].insert_ordered(gb, gb->get_adjusted_jobs() / number_of_classes, stadt_t::compare_gebaeude_pos);
-			}
-		}		
 	}
 	else
 	{
-		if (building->get_class_proportions_sum() > 0)
+		for (uint8 i = 0; i < number_of_classes; i++)
 		{
-			for (uint8 i = 0; i < number_of_classes; i++)
-			{
-				visitor_targets[i].append(gb, gb->get_adjusted_visitor_demand() * building->get_class_proportion(i) / building->get_class_proportions_sum());
-			}
+			visitor_targets[i].append(gb, get_destination_weight(gb, visiting_trip, i));
+			commuter_targets[i].append(gb, get_destination_weight(gb, commuting_trip, i));
 		}
-		else
-		{
-			for (uint8 i = 0; i < number_of_classes; i++)
-			{
-				visitor_targets[i].append(gb, gb->get_adjusted_visitor_demand() / number_of_classes);
-			}
-		}
-
-		if (building->get_class_proportions_sum_jobs() > 0)
-		{
-			for (uint8 i = 0; i < number_of_classes; i++)
-			{
-				commuter_targets[i].append(gb, gb->get_adjusted_jobs() * building->get_class_proportion_jobs(i) / building->get_class_proportions_sum_jobs());
-			}
-		}
-		else
-		{
-			for (uint8 i = 0; i < number_of_classes; i++)
-			{
-				commuter_targets[i].append(gb, gb->get_adjusted_jobs() / number_of_classes);
-			}
-		}		
 	}
 
 	if(gb->get_adjusted_mail_demand() > 0)
@@ -10939,6 +11568,11 @@ void karte_t::add_building_to_world_list(gebaeude_t *gb, bool ordered)
 		}
 		mail_step_interval = calc_adjusted_step_interval(mail_origins_and_targets.get_sum_weight(), get_settings().get_mail_packets_per_month_hundredths());
 	}
+
+	// This may be called again for a building already in the lists: index it only once.
+	destination_index.remove(gb->get_pos().get_2d(), gb);
+	destination_index.insert(gb->get_pos().get_2d(), gb);
+	invalidate_walking_destinations(gb->get_pos().get_2d());
 }
 
 void karte_t::remove_building_from_world_list(gebaeude_t *gb)
@@ -10956,6 +11590,8 @@ void karte_t::remove_building_from_world_list(gebaeude_t *gb)
 		visitor_targets[i].remove_all(gb);
 	}
 	mail_origins_and_targets.remove_all(gb);
+	destination_index.remove(gb->get_pos().get_2d(), gb);
+	invalidate_walking_destinations(gb->get_pos().get_2d());
 
 	passenger_step_interval = calc_adjusted_step_interval(passenger_origins.get_sum_weight(), get_settings().get_passenger_trips_per_month_hundredths());
 	mail_step_interval = calc_adjusted_step_interval(mail_origins_and_targets.get_sum_weight(), get_settings().get_mail_packets_per_month_hundredths());
@@ -10996,6 +11632,7 @@ void karte_t::update_weight_of_building_in_world_list(gebaeude_t *gb)
 		mail_origins_and_targets.update_at(mail_origins_and_targets.index_of(gb), gb->get_adjusted_mail_demand());
 		mail_step_interval = calc_adjusted_step_interval(mail_origins_and_targets.get_sum_weight(), get_settings().get_mail_packets_per_month_hundredths());
 	}
+	invalidate_walking_destinations(gb->get_pos().get_2d());
 }
 
 void karte_t::remove_all_building_references_to_city(stadt_t* city)
@@ -24,6 +24,7 @@
 #include "tpl/vector_tpl.h"
 #include "tpl/slist_tpl.h"
 #include "tpl/koordhashtable_tpl.h"
+#include "tpl/spatial_index_tpl.h"
 
 #include "dataobj/settings.h"
 #include "network/pwd_hash.h"
@@ -79,9 +80,6 @@ class records_t;
 #ifndef FORBID_MULTI_THREAD_PATH_EXPLORER
 #define MULTI_THREAD_PATH_EXPLORER 
 #endif
-#ifndef FORBID_MULTI_THREAD_ROUTE_UNRESERVER
-#define MULTI_THREAD_ROUTE_UNRESERVER
-#endif
 #endif
 
 #ifndef FORBID_MULTI_THREAD_PASSENGER_GENERATION_IN_NETWORK_MODE
@@ -156,6 +154,35 @@ struct checklist_t
 	int print(char *buffer, const char *entity) const;
 };
 
+/**
+ * Hashes of the state of the parts of the world, taken every
+ * WORLD_HASH_INTERVAL steps in network games. Unlike the checklist, they
+ * tell which part of the game went out of sync.
+ */
+struct world_hash_t
+{
+	enum { HALTS, CONVOYS, CITIES, FACTORIES, WAYS, PLAYERS, MAX_WORLD_HASHES };
+
+	/// the step these were taken at, zero if none
+	uint32 st;
+	uint32 hash[MAX_WORLD_HASHES];
+
+	world_hash_t() : st(0)
+	{
+		for(  uint8 i = 0;  i < MAX_WORLD_HASHES;  i++  ) {
+			hash[i] = 0;
+		}
+	}
+
+	/// @return bit i is set, if the hashes of part i differ
+	uint32 get_diverged(const world_hash_t &other) const;
+
+	static const char *get_name(uint8 part);
+
+	void rdwr(memory_rw_t *buffer);
+	int print(char *buffer, const char *entity) const;
+};
+
 // Private car ownership information.
 // @author: jamespetts
 // (But much of this code is adapted from the speed bonus code,
@@ -189,6 +216,7 @@ public:
  * Threaded function caller.
  */
 typedef void (karte_t::*xy_loop_func)(sint16, sint16, sint16, sint16 /*, sint32*/);
+typedef void (karte_t::*range_loop_func)(uint32, uint32);
 
 
 /**
@@ -431,6 +459,29 @@ private:
 	 */
 	weighted_vector_tpl<stadt_t*> stadt;
 
+	/**
+	 * Spatial indices of factories, tourist attractions, towns and stops,
+	 * so that "what is near this tile" does not need to scan the global lists.
+	 * Factories and attractions are keyed by their origin tile, towns by the
+	 * townhall position and stops by their init_pos.
+	 */
+	spatial_index_tpl<fabrik_t *> fab_index;
+	spatial_index_tpl<gebaeude_t *> attraction_index;
+	spatial_index_tpl<stadt_t *> city_index;
+	spatial_index_tpl<halthandle_t> halt_index;
+
+	/**
+	 * Largest extent of any factory in either direction,
+	 * to widen fab_index searches for factories overlapping an area.
+	 */
+	sint16 max_fab_extent;
+
+	/**
+	 * All buildings which are passenger or mail destinations,
+	 * keyed by the position of their first tile.
+	 */
+	spatial_index_tpl<gebaeude_t *> destination_index;
+
 	sint64 last_month_bev;
 
 	/**
@@ -635,6 +686,15 @@ private:
 	checklist_t last_checklists[LAST_CHECKLISTS_COUNT];
 #define LCHKLST(x) (last_checklists[(x) % LAST_CHECKLISTS_COUNT])
 	uint32 rands[CHK_RANDS];
+
+#define WORLD_HASH_INTERVAL (64)
+#define WAY_HASH_SLICES (16)
+#define LAST_WORLD_HASHES_COUNT (4)
+	/// the latest world hashes, in order of their steps
+	world_hash_t last_world_hashes[LAST_WORLD_HASHES_COUNT];
+
+	/// hashes the world into the next entry of last_world_hashes
+	void calc_world_hash();
 	uint32 debug_sums[CHK_DEBUG_SUMS];
 
 
@@ -811,6 +871,12 @@ private:
 	 */
 	void create_beaches( int xoff, int yoff );
 
+	/**
+	 * Headlands should not have beaches: second pass of create_beaches(),
+	 * only changes the climates of the tiles in the given area - suitable for multithreading
+	 */
+	void headlands_loop(sint16, sint16, sint16, sint16);
+
 	/**
 	 * Distribute groundobjs and cities on the map but not
 	 * in the rectangle from (0,0) till (old_x, old_y).
@@ -858,6 +924,18 @@ private:
 	void world_xy_loop(xy_loop_func func, uint8 flags);
 	static void *world_xy_loop_thread(void *);
 
+	/**
+	 * Calls func for disjoint ranges of the indices 0 ... count-1, one range per thread.
+	 */
+	void world_range_loop(range_loop_func func, uint32 count);
+	static void *world_range_loop_thread(void *);
+
+	/// runs the bands first ... last-1 of the current world_band_loop()
+	void world_band_loop_range(uint32 first, uint32 last);
+
+	/// applies the monthly wear to the ways first ... last-1 and notes the worn out ones
+	void wear_ways_loop(uint32 first, uint32 last);
+
 	/**
 	 * Loops over plans after load.
 	 */
@@ -924,14 +1002,78 @@ private:
 	// A helper method for use in init/new month
 	void recalc_passenger_destination_weights();
 
+	/**
+	 * The destinations which passengers and mail from one block of the map
+	 * could possibly reach on foot, weighted as in the global lists.
+	 * Origins which can neither reach a stop nor use a private car draw their
+	 * destinations from here instead of from the whole map, as anything further
+	 * away would be rejected as unreachable anyway.
+	 */
+	struct walking_destinations_t
+	{
+		enum { REGION_SHIFT = 6, REGION_SIZE = 1 << REGION_SHIFT };
+
+		/// Walking range in tiles for which the lists were built
+		uint32 radius;
+
+		/// Set when a destination within range changes; rebuilt on next use
+		bool dirty;
+
+		/// Indexed by class
+		weighted_vector_tpl<gebaeude_t *> *commuter_targets;
+		weighted_vector_tpl<gebaeude_t *> *visitor_targets;
+		weighted_vector_tpl<gebaeude_t *> mail_targets;
+
+#ifdef MULTI_THREAD
+		/// Held by a passenger generation thread while it rebuilds the lists of this block
+		pthread_mutex_t rebuild_mutex;
+
+		walking_destinations_t() : radius(0), dirty(true), commuter_targets(NULL), visitor_targets(NULL) { pthread_mutex_init(&rebuild_mutex, NULL); }
+		~walking_destinations_t() { delete [] commuter_targets; delete [] visitor_targets; pthread_mutex_destroy(&rebuild_mutex); }
+#else
+		walking_destinations_t() : radius(0), dirty(true), commuter_targets(NULL), visitor_targets(NULL) {}
+		~walking_destinations_t() { delete [] commuter_targets; delete [] visitor_targets; }
+#endif
+	};
+
+	/**
+	 * One per map block; the lists themselves are only filled on first use.
+	 * They are only marked dirty while no passengers are generated, so once
+	 * a thread has brought a block up to date, it can read it without a lock.
+	 */
+	vector_tpl<walking_destinations_t *> walking_destinations;
+	sint16 walking_destinations_x;
+
+	/// Discards all walking destination lists, e.g. when the map changes size or rotates
+	void clear_walking_destinations();
+
+	/// Marks the walking destination lists which could contain a destination at @p pos as outdated
+	void invalidate_walking_destinations(koord pos);
+
+	/**
+	 * @returns the up to date walking destination lists for an origin at @p pos,
+	 * or NULL if they would cover the whole map.
+	 */
+	walking_destinations_t *get_walking_destinations(koord pos);
+
+	/**
+	 * @returns the furthest distance in tiles which any passenger or mail
+	 * could walk within the largest possible journey time tolerance.
+	 */
+	uint32 get_max_walking_distance() const;
+
+	/**
+	 * @returns the weight of building @p gb as a destination of a trip
+	 * of type @p trip for class @p g_class.
+	 */
+	uint32 get_destination_weight(const gebaeude_t *gb, uint8 trip, uint8 g_class) const;
+
 #ifdef MULTI_THREAD
 	bool passengers_and_mail_threads_working;
 	bool convoy_threads_working;
 	bool path_explorer_working;
 public:
 	static simthread_barrier_t step_convoys_barrier_external;
-	static simthread_barrier_t unreserve_route_barrier;
-	static pthread_mutex_t unreserve_route_mutex;
 	static pthread_mutex_t step_passengers_and_mail_mutex;
 	void start_passengers_and_mail_threads();
 	void start_convoy_threads();
@@ -969,11 +1111,15 @@ private:
 
 	sint32 generate_passengers_or_mail(const goods_desc_t * wtyp);
 
-	destination find_destination(trip_type trip, uint8 g_class);
+	/**
+	 * Picks a random destination for a trip.
+	 * If @p walking_origin is valid, the trip is known to be possible only on foot from there,
+	 * and the destination is picked from those within walking range if the settings allow this.
+	 */
+	destination find_destination(trip_type trip, uint8 g_class, koord walking_origin = koord::invalid);
 
 #ifdef MULTI_THREAD
 	friend void *check_road_connexions_threaded(void* args);
-	friend void *unreserve_route_threaded(void* args);
 	friend void *step_passengers_and_mail_threaded(void* args);
 	friend void *step_convoys_threaded(void* args);
 	friend void *path_explorer_threaded(void* args);
@@ -2301,12 +2447,41 @@ public:
 
 	void add_city(stadt_t *s);
 
+	/**
+	 * Tells the towns containing @p k that it may have become or stopped being
+	 * a place to grow onto (ways, stops or the ground itself changed).
+	 */
+	void city_tile_changed(koord k);
+
 	/**
 	 * Removes town from map, houses will be left overs.
 	 * @author prissi
 	 */
 	bool remove_city(stadt_t *s);
 
+	/**
+	 * Rebuilds the spatial indices from the global lists,
+	 * e.g. after loading, rotating or resizing the map.
+	 */
+	void rebuild_spatial_indices();
+
+	const spatial_index_tpl<fabrik_t *> &get_factory_spatial_index() const { return fab_index; }
+	const spatial_index_tpl<gebaeude_t *> &get_attraction_index() const { return attraction_index; }
+	const spatial_index_tpl<stadt_t *> &get_city_index() const { return city_index; }
+	const spatial_index_tpl<halthandle_t> &get_halt_index() const { return halt_index; }
+
+	/// To be called when a town hall moves
+	void update_city_index(stadt_t *s, koord old_pos, koord new_pos) { city_index.move(old_pos, new_pos, s); }
+
+	/// To be called when a stop's init_pos changes; use koord::invalid when adding or removing a stop
+	void update_halt_index(halthandle_t halt, koord old_pos, koord new_pos) { halt_index.move(old_pos, new_pos, halt); }
+
+	/**
+	 * Appends all factories with at least one tile inside the rectangle @p lo .. @p ru
+	 * to @p result (unless already contained).
+	 */
+	void get_factories_in_area(koord lo, koord ru, vector_tpl<fabrik_t *> &result) const;
+
 	/* tourist attraction list */
 	void add_attraction(gebaeude_t *gb);
 	void remove_attraction(gebaeude_t *gb);
@@ -2347,6 +2522,11 @@ public:
 	/// rotate plans by 90 degrees
 	void rotate90_plans(sint16 x_min, sint16 x_max, sint16 y_min, sint16 y_max);
 
+	/// rotate the objects which only change themselves by 90 degrees (the ranges are indices into their lists)
+	void rotate90_cities(uint32 first, uint32 last);
+	void rotate90_halts(uint32 first, uint32 last);
+	void rotate90_convoys(uint32 first, uint32 last);
+
 	// rotate map view by 90 degrees
 	void rotate90();
 
@@ -2498,6 +2678,31 @@ public:
 	 */
 	void cleanup_grounds_loop(sint16, sint16, sint16, sint16);
 
+	/**
+	 * Loop calculating the climates (without transitions) - suitable for multithreading
+	 */
+	void calc_climate_loop(sint16, sint16, sint16, sint16);
+
+	/**
+	 * A pass over all rows of the map, see world_band_loop().
+	 */
+	class band_job_t
+	{
+	public:
+		virtual ~band_job_t() {}
+
+		/// does the rows y_min ... y_max-1; only the tiles of these rows may be changed
+		virtual void run_rows(sint16 y_min, sint16 y_max) = 0;
+	};
+
+	/**
+	 * Calls job.run_rows() for bands of a fixed number of rows, several bands in parallel.
+	 * Each band draws its random numbers from a sequence of its own, which is seeded
+	 * from simrand() of the calling thread. Thus the result neither depends on the
+	 * number of threads nor on their timing, as needed for network games.
+	 */
+	void world_band_loop(band_job_t &job);
+
 private:
 	/**
 	 * @return Minimum height of the planquadrats (tile) at i, j. - for speed no checks performed that coordinates are valid
@@ -2591,6 +2796,16 @@ public:
 
 	bool interactive(uint32 quit_month);
 
+	/**
+	 * Runs the simulation as fast as possible without display or user input,
+	 * with the same fixed ratio of sync steps to steps as a network game,
+	 * until @p max_steps steps are done or @p max_months months have passed
+	 * (zero for no limit). The random seed is reset from the savegame first,
+	 * so that runs of the same game with the same number of threads can be compared.
+	 * @returns the checklist after the last sync step
+	 */
+	checklist_t run_benchmark(uint32 max_steps, uint32 max_months);
+
 	uint32 get_sync_steps() const { return sync_steps; }
 
 	/**
@@ -2601,6 +2816,10 @@ public:
 	void set_checklist_at(const uint32 sync_step, const checklist_t &chklst) { LCHKLST(sync_step) = chklst; }
 
 	const checklist_t& get_last_checklist() const { return LCHKLST(sync_steps); }
+
+	/// @return the world hashes taken at step @p st, NULL if they are not kept any more
+	const world_hash_t *get_world_hash_at(uint32 st) const;
+	const world_hash_t& get_last_world_hash() const;
 	uint32 get_last_checklist_sync_step() const { return sync_steps; }
 
 	void command_queue_append(network_world_command_t*) const;
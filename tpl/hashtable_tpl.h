@@ -1,17 +1,27 @@
 #ifndef tpl_hashtable_tpl_h
 #define tpl_hashtable_tpl_h
 
+#include <stdio.h>
+
 #include "slist_tpl.h"
 #include "../macros.h"
-
-#define STHT_BAGSIZE 101
-#define STHT_BAG_COUNTER_T uint8
+#include "../simdebug.h"
+#include "../dataobj/freelist.h"
 
 
 /*
  * Generic hashtable, which maps key_t to value_t. key_t depended functions
  * like the hash generation is implemented by the third template parameter
  * hash_t (see ifc/hash_tpl.h)
+ *
+ * This is an open addressing table with linear probing, which grows as needed.
+ * The slots are kept sorted by (scrambled hash, key), i.e. Robin Hood hashing
+ * with ties broken by the key. Hence the order of iteration only depends on
+ * the keys in the table, not on the order of insertion or the size of the
+ * table, which keeps network games in sync.
+ *
+ * The nodes themselves are allocated separately, so pointers returned by
+ * access() stay valid until that very entry is removed.
  */
 template<class key_t, class value_t, class hash_t>
 class hashtable_tpl
@@ -23,12 +33,144 @@ protected:
 		value_t	value;
 
 		int operator == (const node_t &x) const { return key == x.key; }
+
+		void* operator new(size_t) { return freelist_t::gimme_node(sizeof(node_t)); }
+		void operator delete(void* p) { freelist_t::putback_node(sizeof(node_t), p); }
+	};
+
+	struct slot_t {
+		uint32 hash;  // scrambled hash of node->key
+		node_t *node; // NULL for an empty slot
 	};
 
-	// the entires in the lists are sorted according to their keys
-	slist_tpl <node_t> bags[STHT_BAGSIZE];
+	static const uint32 MIN_CAPACITY = 8;
+
+	// capacity is a power of two; the table grows when it is three quarters full.
+	// The slots beyond the capacity take up entries pushed past the last home slot.
+	slot_t *slots;
+	uint32 slot_count;
+	uint32 capacity;
+	uint8 shift;
 	uint32 count;
 
+	// spread the (often sequential) hash values over the upper bits, which select the home slot
+	static uint32 scramble(uint32 h) { return h * 0x9E3779B9u; }
+
+	uint32 get_home(uint32 hash) const { return hash >> shift; }
+
+	// true, if the entry in slot should be before (hash, key)
+	static bool is_before(const slot_t &slot, uint32 hash, const key_t &key)
+	{
+		return slot.hash < hash  ||  (slot.hash == hash  &&  hash_t::comp(slot.node->key, key) < 0);
+	}
+
+	/*
+	 * @returns the slot where key is, or where it would have to be inserted;
+	 * this is either an empty slot or the first one sorted after key.
+	 * slot_count is returned if this would be beyond the end.
+	 */
+	uint32 find_slot(const key_t &key, uint32 hash) const
+	{
+		uint32 i = get_home(hash);
+		while(  i < slot_count  &&  slots[i].node  &&  is_before(slots[i], hash, key)  ) {
+			i++;
+		}
+		return i;
+	}
+
+	bool is_at(uint32 i, const key_t &key, uint32 hash) const
+	{
+		return i < slot_count  &&  slots[i].node  &&  slots[i].hash == hash  &&  hash_t::comp(slots[i].node->key, key) == 0;
+	}
+
+	void resize(uint32 new_capacity)
+	{
+		slot_t *const old_slots = slots;
+		const uint32 old_slot_count = slot_count;
+
+		capacity = new_capacity;
+		shift = 32;
+		for(  uint32 c = capacity;  c > 1;  c >>= 1  ) {
+			shift--;
+		}
+		slot_count = capacity + capacity/8 + 4;
+		slots = new slot_t[slot_count];
+		for(  uint32 i = 0;  i < slot_count;  i++  ) {
+			slots[i].node = NULL;
+		}
+
+		// the old slots are sorted already, so each entry goes either to its home or right after the previous one
+		uint32 next = 0;
+		for(  uint32 i = 0;  i < old_slot_count;  i++  ) {
+			if(  old_slots[i].node  ) {
+				const uint32 home = get_home(old_slots[i].hash);
+				next = home > next ? home : next;
+				if(  next >= slot_count  ) {
+					// extremely unlucky distribution: start again with more space
+					delete [] slots;
+					slots = old_slots;
+					slot_count = old_slot_count;
+					resize(new_capacity * 2);
+					return;
+				}
+				slots[next++] = old_slots[i];
+			}
+		}
+		delete [] old_slots;
+	}
+
+	/*
+	 * Inserts a new node for key, which must not be in the table yet,
+	 * into slot i as returned by find_slot()
+	 */
+	node_t *insert_at(uint32 i, const key_t &key, uint32 hash)
+	{
+		if(  slots == NULL  ||  (count + 1) * 4 > capacity * 3  ) {
+			resize( slots ? capacity * 2 : MIN_CAPACITY );
+			i = find_slot(key, hash);
+		}
+		// find the end of the run and make room
+		uint32 end = i;
+		while(  end < slot_count  &&  slots[end].node  ) {
+			end++;
+		}
+		if(  end == slot_count  ) {
+			// the run reaches past the end
+			resize( capacity * 2 );
+			return insert_at( find_slot(key, hash), key, hash );
+		}
+		for(  ;  end > i;  end--  ) {
+			slots[end] = slots[end - 1];
+		}
+		node_t *node = new node_t();
+		node->key = key;
+		slots[i].hash = hash;
+		slots[i].node = node;
+		count++;
+		return node;
+	}
+
+	// removes the entry in slot i and closes the gap
+	void remove_at(uint32 i)
+	{
+		delete slots[i].node;
+		slots[i].node = NULL;
+		// pull back the following entries, unless they are at their home already
+		for(  uint32 j = i + 1;  j < slot_count  &&  slots[j].node  &&  get_home(slots[j].hash) < j;  j++  ) {
+			slots[j - 1] = slots[j];
+			slots[j].node = NULL;
+		}
+		count--;
+	}
+
+	uint32 next_used(uint32 i) const
+	{
+		while(  i < slot_count  &&  slots[i].node == NULL  ) {
+			i++;
+		}
+		return i;
+	}
+
 /*
  * assigning hashtables seems also not sound
  */
@@ -37,12 +179,12 @@ private:
 	hashtable_tpl& operator=( hashtable_tpl const&);
 
 public:
-	hashtable_tpl() { count = 0; }
+	hashtable_tpl() : slots(NULL), slot_count(0), capacity(0), shift(32), count(0) {}
 
-public:
-	STHT_BAG_COUNTER_T get_hash(const key_t key) const
+	~hashtable_tpl()
 	{
-		return (STHT_BAG_COUNTER_T)(hash_t::hash(key) % STHT_BAGSIZE);
+		clear();
+		delete [] slots;
 	}
 
 	class iterator
@@ -55,41 +197,28 @@ public:
 			typedef node_t*                   pointer;
 			typedef node_t&                   reference;
 
-			iterator() : bag_i(), bag_end(), node_i() {}
+			iterator() : table(NULL), i(0) {}
 
-			iterator(slist_tpl<node_t>* const bag_i,  slist_tpl<node_t>* const bag_end, typename slist_tpl<node_t>::iterator const& node_i) :
-				bag_i(bag_i),
-				bag_end(bag_end),
-				node_i(node_i)
+			iterator(hashtable_tpl* const table, uint32 const i) :
+				table(table),
+				i(i)
 			{}
 
-			pointer   operator ->() const { return &*node_i; }
-			reference operator *()  const { return  *node_i; }
+			pointer   operator ->() const { return table->slots[i].node; }
+			reference operator *()  const { return *table->slots[i].node; }
 
 			iterator& operator ++()
 			{
-				if (++node_i == bag_i->end()) {
-					for (;;) {
-						if (++bag_i == bag_end) {
-							node_i = typename slist_tpl<node_t>::iterator();
-							break;
-						}
-						if (!bag_i->empty()) {
-							node_i = bag_i->begin();
-							break;
-						}
-					}
-				}
+				i = table->next_used(i + 1);
 				return *this;
 			}
 
-			bool operator ==(iterator const& o) const { return bag_i == o.bag_i && node_i == o.node_i; }
+			bool operator ==(iterator const& o) const { return i == o.i; }
 			bool operator !=(iterator const& o) const { return !(*this == o); }
 
 		private:
-			slist_tpl<node_t>*                   bag_i;
-			slist_tpl<node_t>*                   bag_end;
-			typename slist_tpl<node_t>::iterator node_i;
+			hashtable_tpl* table;
+			uint32         i;
 	};
 
 	/* Erase element at pos
@@ -97,24 +226,9 @@ public:
 	 * An iterator pointing to the successor of the erased element is returned */
 	iterator erase(iterator old)
 	{
-		iterator pos(old);
-		pos.bag_end = old.bag_end;
-		pos.bag_i = old.bag_i;
-		pos.node_i = old.bag_i->erase( old.node_i );
-		if(  pos.node_i ==  pos.bag_i->end()  ) {
-			for (;;) {
-				if (++pos.bag_i == pos.bag_end) {
-					pos.node_i = typename slist_tpl<node_t>::iterator();
-					break;
-				}
-				if (!pos.bag_i->empty()) {
-					pos.node_i = pos.bag_i->begin();
-					break;
-				}
-			}
-		}
-		count --;
-		return pos;
+		remove_at( old.i );
+		// the successor may have moved into the freed slot
+		return iterator( this, next_used(old.i) );
 	}
 
 	class const_iterator
@@ -126,115 +240,82 @@ public:
 			typedef node_t const*             pointer;
 			typedef node_t const&             reference;
 
-			const_iterator() : bag_i(), bag_end(), node_i() {}
+			const_iterator() : table(NULL), i(0) {}
 
-			const_iterator(slist_tpl<node_t> const* const bag_i,  slist_tpl<node_t> const* const bag_end, typename slist_tpl<node_t>::const_iterator const& node_i) :
-				bag_i(bag_i),
-				bag_end(bag_end),
-				node_i(node_i)
+			const_iterator(hashtable_tpl const* const table, uint32 const i) :
+				table(table),
+				i(i)
 			{}
 
-			pointer   operator ->() const { return &*node_i; }
-			reference operator *()  const { return  *node_i; }
+			pointer   operator ->() const { return table->slots[i].node; }
+			reference operator *()  const { return *table->slots[i].node; }
 
 			const_iterator& operator ++()
 			{
-				if (++node_i == bag_i->end()) {
-					for (;;) {
-						if (++bag_i == bag_end) {
-							node_i = typename slist_tpl<node_t>::const_iterator();
-							break;
-						}
-						if (!bag_i->empty()) {
-							node_i = bag_i->begin();
-							break;
-						}
-					}
-				}
+				i = table->next_used(i + 1);
 				return *this;
 			}
 
-			bool operator ==(const_iterator const& o) const { return bag_i == o.bag_i && node_i == o.node_i; }
+			bool operator ==(const_iterator const& o) const { return i == o.i; }
 			bool operator !=(const_iterator const& o) const { return !(*this == o); }
 
 		private:
-			slist_tpl<node_t> const*                   bag_i;
-			slist_tpl<node_t> const*                   bag_end;
-			typename slist_tpl<node_t>::const_iterator node_i;
+			hashtable_tpl const* table;
+			uint32               i;
 	};
 
 	iterator begin()
 	{
-		for (slist_tpl<node_t>* i = bags; i != endof(bags); ++i) {
-			if (!i->empty()) {
-				return iterator(i, endof(bags), i->begin());
-			}
-		}
-		return end();
+		return iterator(this, next_used(0));
 	}
 
 	iterator end()
 	{
-		return iterator(endof(bags), endof(bags), typename slist_tpl<node_t>::iterator());
+		return iterator(this, slot_count);
 	}
 
 	const_iterator begin() const
 	{
-		for (slist_tpl<node_t> const* i = bags; i != endof(bags); ++i) {
-			if (!i->empty()) {
-				return const_iterator(i, endof(bags), i->begin());
-			}
-		}
-		return end();
+		return const_iterator(this, next_used(0));
 	}
 
 	const_iterator end() const
 	{
-		return const_iterator(endof(bags), endof(bags), typename slist_tpl<node_t>::iterator());
+		return const_iterator(this, slot_count);
 	}
 
+	// keeps the allocated slots, as the table will likely be filled again
 	void clear()
 	{
-		for(STHT_BAG_COUNTER_T i=0; i<STHT_BAGSIZE; i++) {
-			bags[i].clear();
+		for(  uint32 i = 0;  i < slot_count;  i++  ) {
+			if(  slots[i].node  ) {
+				delete slots[i].node;
+				slots[i].node = NULL;
+			}
 		}
 		count = 0;
 	}
 
-	// the elements are inserted with increasing key
-	// => faster retrieval (we only have to check half of the lists)
 	const value_t &get(const key_t key) const
 	{
 		static value_t nix;
-		FORT(slist_tpl<node_t>, const& node, bags[get_hash(key)]) {
-			typename hash_t::diff_type diff = hash_t::comp(node.key, key);
-			if(  diff == 0  ) {
-				return node.value;
-			}
-			if(  diff > 0  ) {
-				// not contained
-				break;
-			}
+		if(  count == 0  ) {
+			return nix;
 		}
-		return nix;
+		const uint32 hash = scramble( hash_t::hash(key) );
+		const uint32 i = find_slot(key, hash);
+		return is_at(i, key, hash) ? slots[i].node->value : nix;
 	}
 
-	// the elements are inserted with increasing key
-	// => faster retrivial, but never ever change a key later!!!
+	// never ever change a key later!!!
 	value_t *access(const key_t key)
 	{
-		slist_tpl<node_t>& bag = bags[get_hash(key)];
-		FORT(slist_tpl<node_t>, & node, bag) {
-			typename hash_t::diff_type diff = hash_t::comp(node.key, key);
-			if(  diff == 0  ) {
-				return &node.value;
-			}
-			if(  diff > 0  ) {
-				// not contained
-				break;
-			}
+		if(  count == 0  ) {
+			return NULL;
 		}
-		return NULL;
+		const uint32 hash = scramble( hash_t::hash(key) );
+		const uint32 i = find_slot(key, hash);
+		return is_at(i, key, hash) ? &slots[i].node->value : NULL;
 	}
 
 	//
@@ -243,32 +324,13 @@ public:
 	//
 	bool put(const key_t key, value_t object)
 	{
-		slist_tpl<node_t>& bag = bags[get_hash(key)];
-
-		/* Duplicate values are hard to debug, so better check here.
-		 * we also enter it sorted, saving lookout time for large lists ...
-		 */
-		for(  typename slist_tpl<node_t>::iterator iter = bag.begin(), end = bag.end();  iter != end;  ++iter  ) {
-			typename hash_t::diff_type diff = hash_t::comp(iter->key, key);
-			if(  diff>0  ) {
-				node_t n;
-				n.key   = key;
-				n.value = object;
-				bag.insert( iter, n );
-				count ++;
-				return true;
-			}
-			if(  diff == 0  ) {
-				//dbg->message( "hashtable_tpl::put", "Duplicate hash!" );
-				return false;
-			}
+		const uint32 hash = scramble( hash_t::hash(key) );
+		const uint32 i = slots ? find_slot(key, hash) : 0;
+		if(  slots  &&  is_at(i, key, hash)  ) {
+			// Duplicate values are hard to debug, so better check here.
+			return false;
 		}
-		// here only for empty lists or everything was smaller
-		node_t n;
-		n.key = key;
-		n.value = object;
-		bag.append( n );
-		count ++;
+		insert_at(i, key, hash)->value = object;
 		return true;
 	}
 
@@ -279,18 +341,11 @@ public:
 	//
 	bool is_contained(const key_t key) const
 	{
-		const slist_tpl<node_t>& bag = bags[get_hash(key)];
-		FORT(slist_tpl<node_t>, const& node, bag) {
-			typename hash_t::diff_type diff = hash_t::comp(node.key, key);
-			if(  diff == 0  ) {
-				return true;
-			}
-			if(  diff > 0  ) {
-				// not contained
-				break;
-			}
+		if(  count == 0  ) {
+			return false;
 		}
-		return false;
+		const uint32 hash = scramble( hash_t::hash(key) );
+		return is_at( find_slot(key, hash), key, hash );
 	}
 
 	// Inserts a new instantiated value - failure, if key exists in table
@@ -298,28 +353,13 @@ public:
 	//
 	bool put(const key_t key)
 	{
-		slist_tpl<node_t>& bag = bags[get_hash(key)];
-
-		/* Duplicate values are hard to debug, so better check here.
-		 * we also enter it sorted, saving lookout time for large lists ...
-		 */
-		for(  typename slist_tpl<node_t>::iterator iter = bag.begin(), end = bag.end();  iter != end;  ++iter  ) {
-			typename hash_t::diff_type diff = hash_t::comp(iter->key, key);
-			if(  diff>0  ) {
-				iter = bag.insert( iter );
-				iter->key = key;
-				count ++;
-				return true;
-			}
-			if(  diff == 0  ) {
-				// already initialized
-				return false;
-			}
+		const uint32 hash = scramble( hash_t::hash(key) );
+		const uint32 i = slots ? find_slot(key, hash) : 0;
+		if(  slots  &&  is_at(i, key, hash)  ) {
+			// already initialized
+			return false;
 		}
-		// here only for empty lists or everything was smaller
-		bag.append();
-		bag.back().key = key;
-		count ++;
+		insert_at(i, key, hash);
 		return true;
 	}
 
@@ -331,29 +371,14 @@ public:
 	//
 	value_t set(const key_t key, value_t object)
 	{
-		slist_tpl<node_t>& bag = bags[get_hash(key)];
-		for(  typename slist_tpl<node_t>::iterator iter = bag.begin(), end = bag.end();  iter != end;  ++iter  ) {
-			typename hash_t::diff_type diff = hash_t::comp(iter->key, key);
-			if(  diff == 0  ) {
-				value_t value = iter->value;
-				iter->value = object;
-				return value;
-			}
-			if(  diff > 0  ) {
-				node_t node;
-				node.key   = key;
-				node.value = object;
-				bag.insert( iter, node );
-				count ++;
-				return value_t();
-			}
+		const uint32 hash = scramble( hash_t::hash(key) );
+		const uint32 i = slots ? find_slot(key, hash) : 0;
+		if(  slots  &&  is_at(i, key, hash)  ) {
+			value_t value = slots[i].node->value;
+			slots[i].node->value = object;
+			return value;
 		}
-		// empty list or really last one ...
-		node_t node;
-		node.key   = key;
-		node.value = object;
-		bag.append(node);
-		count ++;
+		insert_at(i, key, hash)->value = object;
 		return value_t();
 	}
 
@@ -361,46 +386,46 @@ public:
 	// otherwise the value that was associated to the key.
 	value_t remove(const key_t key)
 	{
-		slist_tpl<node_t>& bag = bags[get_hash(key)];
-		for(  typename slist_tpl<node_t>::iterator iter = bag.begin(), end = bag.end();  iter != end;  ++iter  ) {
-			typename hash_t::diff_type diff = hash_t::comp(iter->key, key);
-			if(  diff == 0  ) {
-				value_t v = iter->value;
-				bag.erase(iter);
-				count --;
-				return v;
-			}
-			if(  diff > 0  ) {
-				// not in list
-				break;
-			}
+		if(  count == 0  ) {
+			return value_t();
 		}
-		return value_t();
+		const uint32 hash = scramble( hash_t::hash(key) );
+		const uint32 i = find_slot(key, hash);
+		if(  !is_at(i, key, hash)  ) {
+			return value_t();
+		}
+		value_t v = slots[i].node->value;
+		remove_at(i);
+		return v;
 	}
 
 	value_t remove_first()
 	{
-		for(STHT_BAG_COUNTER_T i = 0; i < STHT_BAGSIZE; i++) {
-			if(  !bags[i].empty()  ) {
-				count --;
-				return bags[i].remove_first().value;
-			}
+		const uint32 i = next_used(0);
+		if(  i == slot_count  ) {
+			dbg->fatal( "hashtable_tpl::remove_first()", "Hashtable already empty!" );
+			return value_t();
 		}
-		dbg->fatal( "hashtable_tpl::remove_first()", "Hashtable already empty!" );
-		return value_t();
+		value_t v = slots[i].node->value;
+		remove_at(i);
+		return v;
 	}
 
 	void dump_stats()
 	{
-		for(STHT_BAG_COUNTER_T i = 0; i < STHT_BAGSIZE; i++) {
-			printf("Bag %d contains %ud elements\n", i, bags[i].get_count());
-
-			FORT(slist_tpl<node_t>, const& node, bags[i]) {
-				printf(" ");
-				hash_t::dump(node.key);
+		uint32 max_distance = 0;
+		uint64 sum_distance = 0;
+		for(  uint32 i = 0;  i < slot_count;  i++  ) {
+			if(  slots[i].node  ) {
+				const uint32 distance = i - get_home(slots[i].hash);
+				max_distance = distance > max_distance ? distance : max_distance;
+				sum_distance += distance;
+				printf("Slot %u (distance %u): ", i, distance);
+				hash_t::dump(slots[i].node->key);
 				printf("\n");
 			}
 		}
+		printf("%u elements in %u slots, mean distance %.2f, max distance %u\n", count, slot_count, count ? (double)sum_distance / count : 0.0, max_distance);
 	}
 
 	uint32 get_count() const
@@ -0,0 +1,316 @@
+#ifndef quickstone32_tpl_h
+#define quickstone32_tpl_h
+
+#include <string.h>
+
+#include "../simtypes.h"
+#include "../simdebug.h"
+
+/**
+ * A tombstone handle like quickstone_tpl, but for more than 65535 objects.
+ *
+ * The 32 bits of a handle hold the index into the table of pointers (lower
+ * INDEX_BITS) and the generation of that entry (upper bits). The generation is
+ * incremented whenever an object is detached, so handles to an object that is
+ * gone are not bound any more, even if the entry has been reused since.
+ *
+ * The free entries form a doubly linked list, so that allocation as well as
+ * claiming a particular id (when loading) takes constant time. Freed entries
+ * are appended to the end of the list and thus reused as late as possible.
+ * After init() the list is in ascending order, so that the ids handed out
+ * only depend on the history since the last init(), as needed for network games.
+ *
+ * The ids (without generation) are what should be written to savegames;
+ * see rdwr() for files which still contain 16 bit ids.
+ */
+template <class T> class quickstone32_tpl
+{
+public:
+	enum {
+		INDEX_BITS = 22,
+		INDEX_MASK = (1u << INDEX_BITS) - 1,
+		MAX_SIZE = INDEX_MASK + 1
+	};
+
+private:
+	struct slot_t
+	{
+		T *ptr;
+		uint32 generation; // only the lower 32-INDEX_BITS bits are used
+		uint32 prev_free;  // free list links; 0 terminates (entry 0 is never free)
+		uint32 next_free;
+	};
+
+	/**
+	 * Table of entries. The first entry is always NULL!
+	 */
+	static slot_t *data;
+	static uint32 size;
+
+	static uint32 first_free;
+	static uint32 last_free;
+
+	static uint32 make_entry(uint32 index) { return index | (data[index].generation << INDEX_BITS); }
+
+	static void append_free(uint32 i)
+	{
+		data[i].prev_free = last_free;
+		data[i].next_free = 0;
+		if(  last_free  ) {
+			data[last_free].next_free = i;
+		}
+		else {
+			first_free = i;
+		}
+		last_free = i;
+	}
+
+	static void unlink_free(uint32 i)
+	{
+		if(  data[i].prev_free  ) {
+			data[data[i].prev_free].next_free = data[i].next_free;
+		}
+		else {
+			first_free = data[i].next_free;
+		}
+		if(  data[i].next_free  ) {
+			data[data[i].next_free].prev_free = data[i].prev_free;
+		}
+		else {
+			last_free = data[i].prev_free;
+		}
+	}
+
+	static void enlarge()
+	{
+		if(  size == MAX_SIZE  ) {
+			// completely out of handles
+			dbg->fatal("quickstone32<T>::enlarge()","no free index found (size=%u)",size);
+		}
+		const uint32 newsize = size*2 < MAX_SIZE ? size*2 : MAX_SIZE;
+		slot_t *newdata = new slot_t[newsize];
+		memcpy( newdata, data, sizeof(slot_t)*size );
+		delete [] data;
+		data = newdata;
+		for(  uint32 i=size;  i<newsize;  i++  ) {
+			data[i].ptr = NULL;
+			data[i].generation = 0;
+			append_free(i);
+		}
+		size = newsize;
+	}
+
+	/**
+	 * Index and generation of this handle.
+	 */
+	uint32 entry;
+
+	uint32 get_index() const { return entry & INDEX_MASK; }
+
+public:
+	/**
+	 * Initializes the tombstone table. Calling init() makes all existing
+	 * quickstones invalid.
+	 *
+	 * @param n number of elements
+	 */
+	static void init(const uint32 n)
+	{
+		delete [] data;
+		size = n < 2 ? 2 : (n > MAX_SIZE ? MAX_SIZE : n);
+		data = new slot_t[size];
+		first_free = last_free = 0;
+		// all NULL pointers are mapped to entry 0
+		data[0].ptr = NULL;
+		data[0].generation = 0;
+		for(  uint32 i=1;  i<size;  i++  ) {
+			data[i].ptr = NULL;
+			data[i].generation = 0;
+			append_free(i);
+		}
+	}
+
+	// empty handle (entry 0 is always zero)
+	quickstone32_tpl() : entry(0) {}
+
+	// connects with free handle
+	explicit quickstone32_tpl(T* p)
+	{
+		if(p) {
+			if(  first_free == 0  ) {
+				enlarge();
+			}
+			const uint32 i = first_free;
+			unlink_free(i);
+			data[i].ptr = p;
+			entry = make_entry(i);
+		}
+		else {
+			// all NULL pointers are mapped to entry 0
+			entry = 0;
+		}
+	}
+
+	// connects with last handle
+	explicit quickstone32_tpl(T* p, bool)
+	{
+		if(  first_free == 0  ) {
+			enlarge();
+		}
+		uint32 i = size-1;
+		while(  data[i].ptr  ) {
+			i--;
+		}
+		unlink_free(i);
+		data[i].ptr = p;
+		entry = make_entry(i);
+	}
+
+	// creates handle with id, fails if already taken
+	quickstone32_tpl(T* p, uint32 id)
+	{
+		if(p) {
+			if(  id == 0  ) {
+				dbg->fatal("quickstone32<T>::quickstone32_tpl(T*,uint32)","wants to assign non-null pointer to null index");
+			}
+			if(  id >= MAX_SIZE  ) {
+				dbg->fatal("quickstone32<T>::quickstone32_tpl(T*,uint32)","index %u out of range", id);
+			}
+			while(  id >= size  ) {
+				enlarge();
+			}
+			if(  data[id].ptr!=NULL  &&  data[id].ptr!=p  ) {
+				dbg->fatal("quickstone32<T>::quickstone32_tpl(T*,uint32)","slot (%u) already taken", id);
+			}
+			if(  data[id].ptr==NULL  ) {
+				unlink_free(id);
+				data[id].ptr = p;
+			}
+			entry = make_entry(id);
+		}
+		else {
+			if(  id!=0  ) {
+				dbg->fatal("quickstone32<T>::quickstone32_tpl(T*,uint32)","wants to assign null pointer to non-null index");
+			}
+			// all NULL pointers are mapped to entry 0
+			entry = 0;
+		}
+	}
+
+	quickstone32_tpl(const quickstone32_tpl& r) : entry(r.entry) {}
+
+	// returns true, if no handles left
+	static bool is_exhausted()
+	{
+		return first_free == 0  &&  size == MAX_SIZE;
+	}
+
+	inline bool is_bound() const
+	{
+		// ids from files or the network may be beyond the table
+		const uint32 i = get_index();
+		return i < size  &&  data[i].ptr != 0  &&  make_entry(i) == entry;
+	}
+
+	inline bool is_null() const
+	{
+		return entry == 0;
+	}
+
+	/**
+	 * Removes the object from the tombstone table - this affects all
+	 * handles to the object!
+	 */
+	T* detach()
+	{
+		if(  !is_bound()  ) {
+			return NULL;
+		}
+		const uint32 i = get_index();
+		T* p = data[i].ptr;
+		data[i].ptr = NULL;
+		data[i].generation = (data[i].generation + 1) & (0xFFFFFFFFu >> INDEX_BITS);
+		append_free(i);
+		return p;
+	}
+
+	/**
+	 * Danger - use with care.
+	 * Useful to hand the underlying pointer to subsystems
+	 * that don't know about quickstones - but take care that such pointers
+	 * are never ever deleted or that by some means detach() is called
+	 * upon deletion, i.e. from the ~T() destructor!!!
+	 */
+	T* get_rep() const { return is_bound() ? data[get_index()].ptr : NULL; }
+
+	/**
+	 * @return the index into the tombstone table. May be used as
+	 * an ID for the referenced object. The generation is not included.
+	 */
+	inline uint32 get_id() const { return get_index(); }
+
+	/**
+	 * For read/write from/to a file. Savegames before @p long_version
+	 * (given as loadsave_t::get_extended_version()) stored 16 bit ids.
+	 * The generation is not saved; loaded handles refer to whatever
+	 * occupies the entry when they are used, like quickstone_tpl.
+	 */
+	template <class STORAGE>
+	void rdwr(STORAGE *store, uint32 long_version)
+	{
+		if(  store->get_extended_version() >= long_version  ) {
+			uint32 id = get_index();
+			store->rdwr_long(id);
+			set_id(id);
+		}
+		else {
+			uint16 id = get_index() < 65536 ? (uint16)get_index() : 0;
+			store->rdwr_short(id);
+			set_id(id);
+		}
+	}
+
+	/**
+	 * Sets the current id: Needed to recreate stuff via network.
+	 * ATTENTION: This may be harmful. DO not use unless really really needed!
+	 */
+	void set_id(uint32 e)
+	{
+		e &= INDEX_MASK;
+		entry = e < size ? make_entry(e) : e;
+	}
+
+	/**
+	 * Overloaded dereference operator. With this, quickstones can
+	 * be used as if they were pointers.
+	 */
+	T* operator->() const { return get_rep(); }
+
+	T& operator *() const { return *get_rep(); }
+
+	bool operator== (const quickstone32_tpl<T> &other) const { return entry == other.entry; }
+
+	bool operator!= (const quickstone32_tpl<T> &other) const { return entry != other.entry; }
+
+	// For sorting of handles according to their id
+	bool operator<= (const quickstone32_tpl<T> &other) const
+	{
+		return get_index() <= other.get_index();
+	}
+
+	static uint32 get_size() { return size; }
+
+	/**
+	 * For checking the consistency of handle allocation
+	 * among the server and the clients in network mode
+	 */
+	static uint32 get_next_check() { return first_free; }
+};
+
+template <class T> typename quickstone32_tpl<T>::slot_t *quickstone32_tpl<T>::data = 0;
+
+template <class T> uint32 quickstone32_tpl<T>::size = 0;
+template <class T> uint32 quickstone32_tpl<T>::first_free = 0;
+template <class T> uint32 quickstone32_tpl<T>::last_free = 0;
+
+#endif
@@ -0,0 +1,257 @@
+/*
+ * This file is part of the Simutrans project under the artistic license.
+ * (see license.txt)
+ */
+
+#ifndef tpl_spatial_index_tpl_h
+#define tpl_spatial_index_tpl_h
+
+#include "vector_tpl.h"
+#include "../dataobj/koord.h"
+
+
+/**
+ * A map-wide grid bucket index for objects which are located at a single
+ * map coordinate (factories, attractions, towns, stops ...).
+ *
+ * The map is divided into square cells of (1<<CELL_SHIFT) tiles; each cell
+ * keeps an unordered list of the objects located within it. This answers
+ * "what is near this tile" by looking only at the few cells overlapping the
+ * search area rather than at every object in the world.
+ *
+ * The object type T must be comparable with ==.
+ * Positions outside the indexed area (including koord::invalid) are ignored.
+ */
+template <class T>
+class spatial_index_tpl
+{
+public:
+	enum { CELL_SHIFT = 5, CELL_SIZE = 1 << CELL_SHIFT };
+
+private:
+	struct entry_t
+	{
+		koord pos;
+		T obj;
+
+		entry_t() {}
+		entry_t(koord p, T o) : pos(p), obj(o) {}
+	};
+
+	vector_tpl<entry_t> *cells;
+	sint16 cells_x, cells_y;
+	uint32 count;
+
+	bool is_indexed(koord k) const
+	{
+		return k.x >= 0  &&  k.y >= 0  &&  (k.x >> CELL_SHIFT) < cells_x  &&  (k.y >> CELL_SHIFT) < cells_y;
+	}
+
+	vector_tpl<entry_t> &cell_at(koord k) const
+	{
+		return cells[ (k.y >> CELL_SHIFT) * cells_x + (k.x >> CELL_SHIFT) ];
+	}
+
+	// Chebyshev distance between a tile and the closest tile of a cell
+	static uint32 cell_gap(sint32 k, sint32 cell)
+	{
+		const sint32 lo = cell << CELL_SHIFT;
+		const sint32 hi = lo + CELL_SIZE - 1;
+		return k < lo ? lo - k : (k > hi ? k - hi : 0);
+	}
+
+	// copying would need a deep copy of all cells; no user needs this
+	spatial_index_tpl(const spatial_index_tpl&);
+	spatial_index_tpl& operator=(const spatial_index_tpl&);
+
+public:
+	spatial_index_tpl() : cells(NULL), cells_x(0), cells_y(0), count(0) {}
+
+	~spatial_index_tpl() { delete [] cells; }
+
+	/**
+	 * Discards all entries and prepares the index for a map of the given size.
+	 */
+	void init(koord size)
+	{
+		delete [] cells;
+		cells_x = max(0, (size.x + CELL_SIZE - 1) >> CELL_SHIFT);
+		cells_y = max(0, (size.y + CELL_SIZE - 1) >> CELL_SHIFT);
+		cells = cells_x * cells_y > 0 ? new vector_tpl<entry_t>[cells_x * cells_y] : NULL;
+		count = 0;
+	}
+
+	void clear()
+	{
+		for(  sint32 i = 0;  i < cells_x * cells_y;  i++  ) {
+			cells[i].clear();
+		}
+		count = 0;
+	}
+
+	uint32 get_count() const { return count; }
+
+	bool empty() const { return count == 0; }
+
+	/**
+	 * Adds @p obj at position @p pos.
+	 * @returns false if the position is not covered by the index.
+	 */
+	bool insert(koord pos, T obj)
+	{
+		if(  !is_indexed(pos)  ) {
+			return false;
+		}
+		cell_at(pos).append( entry_t(pos, obj) );
+		count++;
+		return true;
+	}
+
+	/**
+	 * Removes @p obj, which must have been inserted at position @p pos.
+	 * @returns false if it was not found.
+	 */
+	bool remove(koord pos, T obj)
+	{
+		if(  !is_indexed(pos)  ) {
+			return false;
+		}
+		vector_tpl<entry_t> &cell = cell_at(pos);
+		for(  uint32 i = 0;  i < cell.get_count();  i++  ) {
+			if(  cell[i].pos == pos  &&  cell[i].obj == obj  ) {
+				cell.remove_at(i, false);
+				count--;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/**
+	 * Moves @p obj from @p old_pos to @p new_pos.
+	 * Either position may be outside the index.
+	 */
+	void move(koord old_pos, koord new_pos, T obj)
+	{
+		if(  old_pos != new_pos  ) {
+			remove(old_pos, obj);
+			insert(new_pos, obj);
+		}
+	}
+
+	/**
+	 * Appends all objects within the rectangle @p lo .. @p ru (inclusive) to @p result.
+	 */
+	void find_in_area(koord lo, koord ru, vector_tpl<T> &result) const
+	{
+		if(  count == 0  ) {
+			return;
+		}
+		const sint16 cx0 = max(0, lo.x >> CELL_SHIFT);
+		const sint16 cy0 = max(0, lo.y >> CELL_SHIFT);
+		const sint16 cx1 = min(cells_x - 1, ru.x >> CELL_SHIFT);
+		const sint16 cy1 = min(cells_y - 1, ru.y >> CELL_SHIFT);
+		for(  sint16 cy = cy0;  cy <= cy1;  cy++  ) {
+			for(  sint16 cx = cx0;  cx <= cx1;  cx++  ) {
+				const vector_tpl<entry_t> &cell = cells[cy * cells_x + cx];
+				for(  uint32 i = 0;  i < cell.get_count();  i++  ) {
+					const koord k = cell[i].pos;
+					if(  k.x >= lo.x  &&  k.x <= ru.x  &&  k.y >= lo.y  &&  k.y <= ru.y  ) {
+						result.append( cell[i].obj );
+					}
+				}
+			}
+		}
+	}
+
+	/**
+	 * Appends all objects within a square of @p radius tiles around @p center to @p result,
+	 * i.e. the same area which a station coverage of @p radius would cover.
+	 */
+	void find_in_range(koord center, uint16 radius, vector_tpl<T> &result) const
+	{
+		find_in_area( center - koord(radius, radius), center + koord(radius, radius), result );
+	}
+
+	/**
+	 * Finds up to @p max_count objects closest to @p center (Manhattan distance),
+	 * ignoring anything further away than @p max_distance.
+	 * The results are appended to @p result ordered by increasing distance;
+	 * if @p distances is given, the matching distances are appended to it.
+	 * @returns the number of objects found.
+	 */
+	uint32 find_nearest(koord center, uint32 max_count, vector_tpl<T> &result, uint32 max_distance = 0xFFFFFFFFu, vector_tpl<uint32> *distances = NULL) const
+	{
+		if(  count == 0  ||  max_count == 0  ) {
+			return 0;
+		}
+		vector_tpl<T> best(max_count);
+		vector_tpl<uint32> best_dist(max_count);
+
+		const sint16 ccx = center.x >> CELL_SHIFT;
+		const sint16 ccy = center.y >> CELL_SHIFT;
+		const sint16 max_ring = max( max(ccx, (sint16)(cells_x - 1 - ccx)), max(ccy, (sint16)(cells_y - 1 - ccy)) );
+
+		for(  sint16 r = 0;  r <= max_ring;  r++  ) {
+			// every tile in ring r is at least this far away; stop once it cannot improve the result
+			const uint32 ring_min = r == 0 ? 0 : ((uint32)(r - 1) << CELL_SHIFT) + 1;
+			if(  ring_min > max_distance  ||  (best.get_count() == max_count  &&  ring_min > best_dist.back())  ) {
+				break;
+			}
+			for(  sint16 cy = ccy - r;  cy <= ccy + r;  cy++  ) {
+				if(  cy < 0  ||  cy >= cells_y  ) {
+					continue;
+				}
+				// inner rows only touch the left and right cells of the ring
+				const sint16 step = (cy == ccy - r  ||  cy == ccy + r  ||  r == 0) ? 1 : 2 * r;
+				for(  sint16 cx = ccx - r;  cx <= ccx + r;  cx += step  ) {
+					if(  cx < 0  ||  cx >= cells_x  ) {
+						continue;
+					}
+					if(  cell_gap(center.x, cx) + cell_gap(center.y, cy) > max_distance  ) {
+						continue;
+					}
+					const vector_tpl<entry_t> &cell = cells[cy * cells_x + cx];
+					for(  uint32 i = 0;  i < cell.get_count();  i++  ) {
+						const uint32 dist = koord_distance( center, cell[i].pos );
+						if(  dist > max_distance  ||  (best.get_count() == max_count  &&  dist >= best_dist.back())  ) {
+							continue;
+						}
+						// insertion sort into the small result list
+						uint32 j = best.get_count();
+						while(  j > 0  &&  best_dist[j - 1] > dist  ) {
+							j--;
+						}
+						if(  best.get_count() == max_count  ) {
+							best.remove_at( max_count - 1 );
+							best_dist.remove_at( max_count - 1 );
+						}
+						best.insert_at( j, cell[i].obj );
+						best_dist.insert_at( j, dist );
+					}
+				}
+			}
+		}
+
+		for(  uint32 i = 0;  i < best.get_count();  i++  ) {
+			result.append( best[i] );
+			if(  distances  ) {
+				distances->append( best_dist[i] );
+			}
+		}
+		return best.get_count();
+	}
+
+	/**
+	 * @returns the Manhattan distance from @p center to the closest object,
+	 * or 0xFFFFFFFF if the index is empty.
+	 */
+	uint32 get_nearest_distance(koord center) const
+	{
+		vector_tpl<T> nearest(1);
+		vector_tpl<uint32> dist(1);
+		return find_nearest( center, 1, nearest, 0xFFFFFFFFu, &dist ) ? dist[0] : 0xFFFFFFFFu;
+	}
+};
+
+#endif
@@ -0,0 +1,287 @@
+/**
+ * This file is part of the Simutrans project under the artistic license.
+ * (see license.txt)
+ *
+ * Unit test and microbenchmark for hashtable_tpl.h
+ * Compares the open addressing table with the former table of 101 sorted lists.
+ * Do NOT link this into simutrans!  This is a unit test!
+ *
+ * g++ -O2 -o test_hashtable tpl/test_hashtable_tpl.cc
+ */
+#include <stdlib.h>
+#include <chrono>
+
+#include "../simtypes.h"
+#include "inthashtable_tpl.h"
+#include "koordhashtable_tpl.h"
+#include "vector_tpl.h"
+
+// This is a hack, but it's worth it.  The templates need logging and the freelist in order to link.
+#include "../simdebug.cc"
+#include "../utils/dumb-log.cc"
+#include "../simmem.cc"
+#include "../dataobj/freelist.cc"
+
+
+/*
+ * The former hashtable: a fixed number of bags, each a list sorted by key.
+ * Only what is needed for the comparison.
+ */
+template<class key_t, class value_t, class hash_t>
+class bag_hashtable_tpl
+{
+	struct node_t {
+		key_t key;
+		value_t value;
+	};
+
+	enum { BAGSIZE = 101 };
+	slist_tpl<node_t> bags[BAGSIZE];
+	uint32 count;
+
+	slist_tpl<node_t> &bag(const key_t key) { return bags[hash_t::hash(key) % BAGSIZE]; }
+
+public:
+	bag_hashtable_tpl() : count(0) {}
+
+	value_t *access(const key_t key)
+	{
+		FORT(slist_tpl<node_t>, & node, bag(key)) {
+			typename hash_t::diff_type diff = hash_t::comp(node.key, key);
+			if(  diff == 0  ) {
+				return &node.value;
+			}
+			if(  diff > 0  ) {
+				break;
+			}
+		}
+		return NULL;
+	}
+
+	bool put(const key_t key, value_t object)
+	{
+		slist_tpl<node_t> &b = bag(key);
+		node_t n;
+		n.key = key;
+		n.value = object;
+		for(  typename slist_tpl<node_t>::iterator iter = b.begin(), end = b.end();  iter != end;  ++iter  ) {
+			typename hash_t::diff_type diff = hash_t::comp(iter->key, key);
+			if(  diff > 0  ) {
+				b.insert( iter, n );
+				count++;
+				return true;
+			}
+			if(  diff == 0  ) {
+				return false;
+			}
+		}
+		b.append( n );
+		count++;
+		return true;
+	}
+
+	value_t remove(const key_t key)
+	{
+		slist_tpl<node_t> &b = bag(key);
+		for(  typename slist_tpl<node_t>::iterator iter = b.begin(), end = b.end();  iter != end;  ++iter  ) {
+			if(  hash_t::comp(iter->key, key) == 0  ) {
+				value_t v = iter->value;
+				b.erase(iter);
+				count--;
+				return v;
+			}
+		}
+		return value_t();
+	}
+
+	uint32 get_count() const { return count; }
+};
+
+
+static int failures = 0;
+
+#define CHECK(cond) \
+	if(  !(cond)  ) { \
+		fprintf( stderr, "FAILED line %d: %s\n", __LINE__, #cond ); \
+		failures++; \
+	}
+
+
+static uint64 now_us()
+{
+	return (uint64)std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+
+static void shuffle(vector_tpl<koord> &v, uint32 seed)
+{
+	for(  uint32 i = v.get_count();  i > 1;  i--  ) {
+		seed = seed * 1103515245u + 12345u;
+		const uint32 j = (seed >> 8) % i;
+		const koord tmp = v[i - 1];
+		v[i - 1] = v[j];
+		v[j] = tmp;
+	}
+}
+
+
+static void test_correctness()
+{
+	inthashtable_tpl<uint32, uint32> table;
+	bag_hashtable_tpl<uint32, uint32, inthash_tpl<uint32> > reference;
+
+	uint32 seed = 4711;
+	for(  int i = 0;  i < 200000;  i++  ) {
+		seed = seed * 1103515245u + 12345u;
+		const uint32 key = (seed >> 8) % 5000;
+		if(  seed & 0x80000000u  ) {
+			CHECK( table.put(key, i) == reference.put(key, i) );
+		}
+		else {
+			CHECK( table.remove(key) == reference.remove(key) );
+		}
+	}
+	CHECK( table.get_count() == reference.get_count() );
+	for(  uint32 key = 0;  key < 5000;  key++  ) {
+		uint32 *a = table.access(key);
+		uint32 *b = reference.access(key);
+		CHECK( (a == NULL) == (b == NULL) );
+		CHECK( a == NULL  ||  *a == *b );
+		CHECK( table.is_contained(key) == (b != NULL) );
+	}
+
+	// pointers to values must survive the growth of the table
+	table.put( 100000, 42 );
+	uint32 *stable = table.access( 100000 );
+	for(  uint32 key = 200000;  key < 300000;  key++  ) {
+		table.put( key, key );
+	}
+	CHECK( table.access( 100000 ) == stable );
+
+	// erasing while iterating must visit every entry exactly once
+	uint32 visited = 0, kept = 0;
+	const uint32 before = table.get_count();
+	for(  inthashtable_tpl<uint32, uint32>::iterator iter = table.begin();  iter != table.end();  ) {
+		visited++;
+		if(  iter->key & 1  ) {
+			iter = table.erase( iter );
+		}
+		else {
+			++iter;
+			kept++;
+		}
+	}
+	CHECK( visited == before );
+	CHECK( table.get_count() == kept );
+
+	table.clear();
+	CHECK( table.empty()  &&  table.begin() == table.end() );
+}
+
+
+static void test_order()
+{
+	// the order of iteration must not depend on the order of insertion or on the size of the table
+	vector_tpl<koord> keys;
+	for(  sint16 i = 0;  i < 3000;  i++  ) {
+		keys.append( koord( (i * 37) % 1024, (i * 101) % 1024 ) );
+	}
+	koordhashtable_tpl<koord, uint32> a, b;
+	FOR(vector_tpl<koord>, const k, keys) {
+		a.put( k, 0 );
+	}
+	// b has been bigger before
+	for(  sint16 i = 0;  i < 20000;  i++  ) {
+		b.put( koord( -1 - i, 7 ), 0 );
+	}
+	shuffle( keys, 42 );
+	FOR(vector_tpl<koord>, const k, keys) {
+		b.put( k, 0 );
+	}
+	for(  sint16 i = 0;  i < 20000;  i++  ) {
+		b.remove( koord( -1 - i, 7 ) );
+	}
+	CHECK( a.get_count() == b.get_count() );
+	koordhashtable_tpl<koord, uint32>::iterator ia = a.begin(), ib = b.begin();
+	for(  ;  ia != a.end()  &&  ib != b.end();  ++ia, ++ib  ) {
+		CHECK( ia->key == ib->key );
+	}
+	CHECK( ia == a.end()  &&  ib == b.end() );
+}
+
+
+template<class table_t, class key_t>
+static void time_table(const char *name, const vector_tpl<key_t> &keys, const vector_tpl<key_t> &misses)
+{
+	table_t *table = new table_t;
+	uint64 t0 = now_us();
+	for(  uint32 i = 0;  i < keys.get_count();  i++  ) {
+		table->put( keys[i], i );
+	}
+	uint64 t1 = now_us();
+	uint32 found = 0;
+	for(  int rounds = 0;  rounds < 10;  rounds++  ) {
+		for(  uint32 i = 0;  i < keys.get_count();  i++  ) {
+			found += table->access( keys[i] ) != NULL;
+		}
+		for(  uint32 i = 0;  i < misses.get_count();  i++  ) {
+			found += table->access( misses[i] ) != NULL;
+		}
+	}
+	uint64 t2 = now_us();
+	for(  uint32 i = 0;  i < keys.get_count();  i++  ) {
+		table->remove( keys[i] );
+	}
+	uint64 t3 = now_us();
+	printf( "  %-8s insert %7.1f ms  lookup %7.1f ms  remove %7.1f ms  (%u found)\n", name, (t1 - t0) / 1000.0, (t2 - t1) / 1000.0, (t3 - t2) / 1000.0, found );
+	delete table;
+}
+
+
+template<class key_t, class hash_t>
+static void benchmark(const char *name, const vector_tpl<key_t> &keys, const vector_tpl<key_t> &misses)
+{
+	printf( "%s, %u keys:\n", name, keys.get_count() );
+	time_table< bag_hashtable_tpl<key_t, uint32, hash_t>, key_t >( "bags", keys, misses );
+	time_table< hashtable_tpl<key_t, uint32, hash_t>, key_t >( "open", keys, misses );
+}
+
+
+int main( int argc, char** argv)
+{
+	test_correctness();
+	test_order();
+	if(  failures  ) {
+		fprintf( stderr, "%d checks failed\n", failures );
+		return 1;
+	}
+	printf( "All checks passed\n" );
+
+	if(  argc > 1  ) {
+		const uint32 n = atoi( argv[1] );
+
+		// connexions and journey times: dense ids of halts and convoys
+		vector_tpl<uint16> ids, id_misses;
+		for(  uint32 i = 1;  i <= n  &&  i < 65535;  i++  ) {
+			(i & 3 ? ids : id_misses).append( (uint16)i );
+		}
+		benchmark< uint16, inthash_tpl<uint16> >( "ids", ids, id_misses );
+
+		// positions: stops clustered within towns on a large map
+		vector_tpl<koord> pos, pos_misses;
+		uint32 seed = 1;
+		while(  pos.get_count() < n  ) {
+			seed = seed * 1103515245u + 12345u;
+			const koord town( (seed >> 4) % 4000, (seed >> 16) % 4000 );
+			for(  int j = 0;  j < 64  &&  pos.get_count() < n;  j++  ) {
+				seed = seed * 1103515245u + 12345u;
+				const koord k = town + koord( (seed >> 8) % 64, (seed >> 20) % 64 );
+				pos.append( k );
+				pos_misses.append( k + koord(0, 4000) );
+			}
+		}
+		// the duplicates are simply rejected by put()
+		benchmark< koord, koordhash_tpl<koord> >( "koord", pos, pos_misses );
+	}
+	return 0;
+}
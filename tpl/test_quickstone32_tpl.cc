@@ -0,0 +1,131 @@
+/**
+ * This file is part of the Simutrans project under the artistic license.
+ * (see license.txt)
+ *
+ * Unit test for quickstone32_tpl.h
+ * Do NOT link this into simutrans!  This is a unit test!
+ *
+ * g++ -O2 -o test_quickstone32 tpl/test_quickstone32_tpl.cc
+ */
+#include "../simtypes.h"
+#include "quickstone32_tpl.h"
+#include "vector_tpl.h"
+
+// This is a hack, but it's worth it.  The templates need logging in order to link.
+#include "../simdebug.cc"
+#include "../utils/dumb-log.cc"
+
+
+struct object_t
+{
+	uint32 value;
+};
+
+typedef quickstone32_tpl<object_t> handle_t;
+
+
+/// Just enough of loadsave_t to test rdwr()
+struct storage_t
+{
+	vector_tpl<uint32> values;
+	uint32 pos;
+	uint32 version;
+	bool saving;
+
+	storage_t(uint32 v) : pos(0), version(v), saving(true) {}
+
+	uint32 get_extended_version() const { return version; }
+
+	void rdwr_short(uint16 &i)
+	{
+		if(  saving  ) {
+			values.append(i);
+		}
+		else {
+			i = (uint16)values[pos++];
+		}
+	}
+
+	void rdwr_long(uint32 &i)
+	{
+		if(  saving  ) {
+			values.append(i | 0x80000000u);
+		}
+		else {
+			i = values[pos++] & 0x7FFFFFFFu;
+		}
+	}
+};
+
+
+static int failures = 0;
+
+#define CHECK(cond) \
+	if(  !(cond)  ) { \
+		fprintf( stderr, "FAILED line %d: %s\n", __LINE__, #cond ); \
+		failures++; \
+	}
+
+
+int main( int argc, char** argv)
+{
+	handle_t::init( 1024 );
+
+	// more objects than a 16 bit handle can address
+	const uint32 n = 100000;
+	object_t *objects = new object_t[n];
+	vector_tpl<handle_t> handles(n);
+	for(  uint32 i = 0;  i < n;  i++  ) {
+		objects[i].value = i;
+		handles.append( handle_t( &objects[i] ) );
+	}
+	CHECK( handles[n - 1].get_id() == n );
+	CHECK( handles[n - 1]->value == n - 1 );
+
+	// a stale handle must not be bound, even after its entry has been reused
+	handle_t stale = handles[10];
+	const uint32 id = stale.get_id();
+	CHECK( stale.detach() == &objects[10] );
+	CHECK( !stale.is_bound()  &&  stale.get_rep() == NULL );
+	object_t other;
+	handle_t reused( &other, id );
+	CHECK( reused.get_id() == id  &&  reused.is_bound() );
+	CHECK( !stale.is_bound()  &&  stale != reused );
+
+	// set_id() refers to the current occupant, as needed when loading
+	handle_t loaded;
+	loaded.set_id( id );
+	CHECK( loaded == reused  &&  loaded.get_rep() == &other );
+
+	// an id beyond the table is not bound
+	handle_t beyond;
+	beyond.set_id( handle_t::get_size() + 5 );
+	CHECK( !beyond.is_bound()  &&  beyond.get_rep() == NULL );
+
+	// freed entries are reused last, in the order they were freed
+	handles[20].detach();
+	handles[30].detach();
+	CHECK( handle_t::get_next_check() == n + 1 );
+
+	// ids are saved as 16 bit for old files, as 32 bit for newer ones
+	storage_t old_file(13), new_file(14);
+	handle_t large = handles[n - 1];
+	large.rdwr( &old_file, 14 );
+	large.rdwr( &new_file, 14 );
+	handles[5].rdwr( &old_file, 14 );
+	old_file.saving = new_file.saving = false;
+	handle_t h;
+	h.rdwr( &old_file, 14 );
+	CHECK( h.is_null() );
+	h.rdwr( &old_file, 14 );
+	CHECK( h == handles[5] );
+	h.rdwr( &new_file, 14 );
+	CHECK( h == large );
+
+	if(  failures  ) {
+		fprintf( stderr, "%d checks failed\n", failures );
+		return 1;
+	}
+	printf( "All checks passed\n" );
+	return 0;
+}
@@ -10,7 +10,7 @@
 #include "../simdebug.h"
 #include "dr_rdpng.h"
 
-static std::string filename_;
+static thread_local std::string filename_;
 
 static void read_png(unsigned char** block, unsigned* width, unsigned* height, FILE* file, const int base_img_size)
 {
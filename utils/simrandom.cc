@@ -2,6 +2,7 @@
 #include <assert.h>
 #include <math.h>
 #include <stdlib.h>
+#include <string.h>
 #include "simrandom.h"
 #include "../dataobj/environment.h"
 #include "../simsys.h"
@@ -102,6 +103,33 @@ uint32 simrand_plain()
 	return y;
 }
 
+simrand_scope_t::simrand_scope_t(uint32 seed)
+{
+	// the state vector, its index and the seed used for debugging
+	saved_state = new uint32[MERSENNE_TWISTER_N + 2];
+	memcpy( saved_state, mersenne_twister, sizeof(uint32) * MERSENNE_TWISTER_N );
+	saved_state[MERSENNE_TWISTER_N] = (uint32)mersenne_twister_index;
+#ifdef DEBUG_SIMRAND_CALLS
+	saved_state[MERSENNE_TWISTER_N + 1] = thread_seed;
+#endif
+	saved_mode = random_origin;
+	init_genrand( seed );
+	random_origin = 0;
+}
+
+
+simrand_scope_t::~simrand_scope_t()
+{
+	memcpy( mersenne_twister, saved_state, sizeof(uint32) * MERSENNE_TWISTER_N );
+	mersenne_twister_index = (int)saved_state[MERSENNE_TWISTER_N];
+#ifdef DEBUG_SIMRAND_CALLS
+	thread_seed = saved_state[MERSENNE_TWISTER_N + 1];
+#endif
+	random_origin = (uint8)saved_mode;
+	delete [] saved_state;
+}
+
+
 /* generates a random number on [0,max-1]-interval */
 #ifdef DEBUG_SIMRAND_CALLS
 uint32 simrand(const uint32 max, const char* caller)
@@ -31,6 +31,21 @@ uint32 simrand_normal(const uint32 max, uint32 exponent, const char*);
 /* generates a random number on [0,0xFFFFFFFFu]-interval */
 uint32 simrand_plain();
 
+/**
+ * While an instance exists, simrand() of the calling thread draws from a sequence
+ * which only depends on @p seed; afterwards the previous sequence continues unchanged.
+ * For the parts of a parallel pass, whose results must not depend on which thread
+ * did them, nor on the number of threads.
+ */
+class simrand_scope_t
+{
+	uint32 *saved_state;
+	uint16 saved_mode;
+public:
+	explicit simrand_scope_t(uint32 seed);
+	~simrand_scope_t();
+};
+
 double perlin_noise_2D(const double x, const double y, const double persistence, const sint32 map_size = 512);
 
 // for network debugging, i.e. finding hidden simrands in wrong places
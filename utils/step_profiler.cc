@@ -0,0 +1,387 @@
+/*
+ * This file is part of the Simutrans project under the artistic license.
+ * (see license.txt)
+ */
+
+#include <stdio.h>
+#include <chrono>
+
+#include "step_profiler.h"
+#include "csv.h"
+#include "cbuffer_t.h"
+#include "for.h"
+#include "simthread.h"
+#include "../simdebug.h"
+#include "../dataobj/freelist.h"
+#include "../tpl/vector_tpl.h"
+
+
+std::atomic<bool> step_profiler_t::enabled(false);
+
+namespace {
+
+/// Events beyond this are not kept for the timeline, but still summed up per step
+const uint32 MAX_EVENTS = 1u << 20;
+
+/// Steps beyond this are not kept, so that a forgotten profiler cannot use up all memory
+const uint32 MAX_STEPS = 1u << 18;
+
+struct event_t
+{
+	uint64 start;
+	uint32 duration;
+	uint16 thread;
+	uint8 phase;
+};
+
+struct step_summary_t
+{
+	uint32 step_nr;
+	uint32 phase_us[step_profiler_t::MAX_PHASES];
+};
+
+vector_tpl<event_t> events;
+vector_tpl<step_summary_t> steps;
+step_summary_t current;
+/// of all closed steps, including those no longer kept
+uint64 total_us[step_profiler_t::MAX_PHASES];
+uint32 dropped_events = 0;
+
+/// Freelist counts when profiling was started
+vector_tpl<uint64> start_gimme;
+vector_tpl<uint64> start_putback;
+
+/// What one thread recorded since it was last collected
+struct thread_record_t
+{
+	uint16 thread;
+	uint32 phase_us[step_profiler_t::MAX_PHASES];
+	vector_tpl<event_t> events;
+	uint32 dropped_events;
+#ifdef MULTI_THREAD
+	/// only ever waited for while the record is collected
+	pthread_mutex_t mutex;
+#endif
+};
+
+#ifdef MULTI_THREAD
+/// guards everything above and the list of thread records, but not the records themselves
+pthread_mutex_t profiler_mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+/// Threads are numbered in the order in which they first record something
+vector_tpl<thread_record_t *> thread_records;
+thread_local thread_record_t *own_record = NULL;
+
+void clear_record(thread_record_t *r)
+{
+	for(  int i = 0;  i < step_profiler_t::MAX_PHASES;  i++  ) {
+		r->phase_us[i] = 0;
+	}
+	r->events.clear();
+	r->dropped_events = 0;
+}
+
+/// Moves what the threads recorded into the current step; to be called with profiler_mutex held
+void collect_records()
+{
+	FOR( vector_tpl<thread_record_t *>, const r, thread_records ) {
+#ifdef MULTI_THREAD
+		pthread_mutex_lock( &r->mutex );
+#endif
+		for(  int i = 0;  i < step_profiler_t::MAX_PHASES;  i++  ) {
+			current.phase_us[i] += r->phase_us[i];
+		}
+		FOR( vector_tpl<event_t>, const& ev, r->events ) {
+			if(  events.get_count() < MAX_EVENTS  ) {
+				events.append( ev );
+			}
+			else {
+				dropped_events++;
+			}
+		}
+		dropped_events += r->dropped_events;
+		clear_record( r );
+#ifdef MULTI_THREAD
+		pthread_mutex_unlock( &r->mutex );
+#endif
+	}
+}
+
+void clear_current()
+{
+	current.step_nr = 0;
+	for(  int i = 0;  i < step_profiler_t::MAX_PHASES;  i++  ) {
+		current.phase_us[i] = 0;
+	}
+}
+
+const char *const phase_names[step_profiler_t::MAX_PHASES] = {
+	"step",
+	"sync_step",
+	"new_month",
+	"private_car_routes",
+	"seasons",
+	"path_explorer",
+	"convoys_threaded",
+	"convoys",
+	"cities",
+	"passengers_and_mail",
+	"await_passengers_and_mail",
+	"factories",
+	"powernet",
+	"players",
+	"halts",
+	"reroute",
+	"transferring_cargoes",
+	"time_interval_signals",
+	"reservations"
+};
+
+}
+
+
+void step_profiler_t::set_enabled(bool on)
+{
+#ifdef MULTI_THREAD
+	pthread_mutex_lock(&profiler_mutex);
+#endif
+	if(  on  &&  !enabled  ) {
+		events.clear();
+		steps.clear();
+		clear_current();
+		for(  int i = 0;  i < MAX_PHASES;  i++  ) {
+			total_us[i] = 0;
+		}
+		dropped_events = 0;
+		FOR( vector_tpl<thread_record_t *>, const r, thread_records ) {
+#ifdef MULTI_THREAD
+			pthread_mutex_lock( &r->mutex );
+#endif
+			clear_record( r );
+#ifdef MULTI_THREAD
+			pthread_mutex_unlock( &r->mutex );
+#endif
+		}
+		start_gimme.clear();
+		start_putback.clear();
+		for(  uint32 i = 0;  i < freelist_t::get_size_class_count();  i++  ) {
+			uint32 size;
+			uint64 gimme, putback;
+			freelist_t::get_statistics( i, size, gimme, putback );
+			start_gimme.append( gimme );
+			start_putback.append( putback );
+		}
+	}
+	enabled.store( on );
+#ifdef MULTI_THREAD
+	pthread_mutex_unlock(&profiler_mutex);
+#endif
+	dbg->message("step_profiler_t::set_enabled()", "step profiling %s", on ? "started" : "stopped");
+}
+
+
+const char *step_profiler_t::get_phase_name(phase_t phase)
+{
+	return phase < MAX_PHASES ? phase_names[phase] : "unknown";
+}
+
+
+uint64 step_profiler_t::get_time_us()
+{
+	return (uint64)std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+
+void step_profiler_t::add(phase_t phase, uint64 start, uint64 end)
+{
+	if(  !is_enabled()  ) {
+		return;
+	}
+	thread_record_t *r = own_record;
+	if(  r == NULL  ) {
+		// first event of this thread
+		r = new thread_record_t;
+		clear_record( r );
+#ifdef MULTI_THREAD
+		pthread_mutex_init( &r->mutex, NULL );
+		pthread_mutex_lock(&profiler_mutex);
+#endif
+		r->thread = (uint16)thread_records.get_count();
+		thread_records.append( r );
+#ifdef MULTI_THREAD
+		pthread_mutex_unlock(&profiler_mutex);
+#endif
+		own_record = r;
+	}
+
+#ifdef MULTI_THREAD
+	pthread_mutex_lock( &r->mutex );
+#endif
+	const uint32 duration = end - start < 0xFFFFFFFFu ? (uint32)(end - start) : 0xFFFFFFFFu;
+	r->phase_us[phase] += duration;
+	if(  r->events.get_count() < MAX_EVENTS  ) {
+		event_t ev;
+		ev.start = start;
+		ev.duration = duration;
+		ev.thread = r->thread;
+		ev.phase = (uint8)phase;
+		r->events.append(ev);
+	}
+	else {
+		r->dropped_events++;
+	}
+#ifdef MULTI_THREAD
+	pthread_mutex_unlock( &r->mutex );
+#endif
+}
+
+
+void step_profiler_t::end_step(uint32 step_nr)
+{
+	if(  !is_enabled()  ) {
+		// nothing recorded; set_enabled() starts with a fresh step
+		return;
+	}
+#ifdef MULTI_THREAD
+	pthread_mutex_lock(&profiler_mutex);
+#endif
+	// the worker threads of the last step are done; background threads may still add to the next
+	collect_records();
+	if(  is_enabled()  ) {
+		for(  int i = 0;  i < MAX_PHASES;  i++  ) {
+			total_us[i] += current.phase_us[i];
+		}
+		if(  steps.get_count() < MAX_STEPS  ) {
+			current.step_nr = step_nr;
+			steps.append(current);
+		}
+	}
+	clear_current();
+#ifdef MULTI_THREAD
+	pthread_mutex_unlock(&profiler_mutex);
+#endif
+}
+
+
+uint64 step_profiler_t::get_total_us(phase_t phase)
+{
+#ifdef MULTI_THREAD
+	pthread_mutex_lock(&profiler_mutex);
+#endif
+	collect_records();
+	const uint64 total = total_us[phase] + current.phase_us[phase];
+#ifdef MULTI_THREAD
+	pthread_mutex_unlock(&profiler_mutex);
+#endif
+	return total;
+}
+
+
+void step_profiler_t::print_allocations(cbuffer_t &buf)
+{
+	for(  uint32 i = 0;  i < freelist_t::get_size_class_count()  &&  i < start_gimme.get_count();  i++  ) {
+		uint32 size;
+		uint64 gimme, putback;
+		freelist_t::get_statistics( i, size, gimme, putback );
+		gimme -= start_gimme[i];
+		putback -= start_putback[i];
+		if(  gimme  ||  putback  ) {
+			if(  size  ) {
+				buf.printf( "  nodes of %3u bytes: %12llu allocated %12llu freed\n", size, (unsigned long long)gimme, (unsigned long long)putback );
+			}
+			else {
+				buf.printf( "  larger nodes:       %12llu allocated %12llu freed\n", (unsigned long long)gimme, (unsigned long long)putback );
+			}
+		}
+	}
+}
+
+
+bool step_profiler_t::write_csv(const char *filename)
+{
+	CSV_t csv;
+	csv.add_field("step_nr");
+	for(  int i = 0;  i < MAX_PHASES;  i++  ) {
+		csv.add_field( phase_names[i] );
+	}
+	csv.new_line();
+
+#ifdef MULTI_THREAD
+	pthread_mutex_lock(&profiler_mutex);
+#endif
+	for(  uint32 j = 0;  j < steps.get_count();  j++  ) {
+		csv.add_field( (int)steps[j].step_nr );
+		for(  int i = 0;  i < MAX_PHASES;  i++  ) {
+			csv.add_field( (int)steps[j].phase_us[i] );
+		}
+		csv.new_line();
+	}
+#ifdef MULTI_THREAD
+	pthread_mutex_unlock(&profiler_mutex);
+#endif
+
+	FILE *file = fopen(filename, "w");
+	if(  !file  ) {
+		dbg->warning("step_profiler_t::write_csv()", "Cannot write to %s", filename);
+		return false;
+	}
+	fputs( csv.get_str(), file );
+	fclose(file);
+	return true;
+}
+
+
+bool step_profiler_t::write_trace(const char *filename)
+{
+	FILE *file = fopen(filename, "w");
+	if(  !file  ) {
+		dbg->warning("step_profiler_t::write_trace()", "Cannot write to %s", filename);
+		return false;
+	}
+
+#ifdef MULTI_THREAD
+	pthread_mutex_lock(&profiler_mutex);
+#endif
+	collect_records();
+	fputs( "{\"traceEvents\":[\n", file );
+	// time stamps relative to the earliest event keep the numbers readable;
+	// events are stored when they end, so this is not necessarily the first one
+	uint64 origin = events.empty() ? 0 : events[0].start;
+	for(  uint32 i = 1;  i < events.get_count();  i++  ) {
+		if(  events[i].start < origin  ) {
+			origin = events[i].start;
+		}
+	}
+	for(  uint32 i = 0;  i < events.get_count();  i++  ) {
+		const event_t &ev = events[i];
+		fprintf( file, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%llu,\"dur\":%u}\n",
+			i > 0 ? "," : "", phase_names[ev.phase], (unsigned)ev.thread, (unsigned long long)(ev.start - origin), (unsigned)ev.duration );
+	}
+#ifdef MULTI_THREAD
+	pthread_mutex_unlock(&profiler_mutex);
+#endif
+	fprintf( file, "],\"otherData\":{\"dropped_events\":%u", (unsigned)dropped_events );
+	// "larger" counts the nodes too large for the freelist
+	for(  uint32 i = 0;  i < freelist_t::get_size_class_count()  &&  i < start_gimme.get_count();  i++  ) {
+		uint32 size;
+		uint64 gimme, putback;
+		freelist_t::get_statistics( i, size, gimme, putback );
+		gimme -= start_gimme[i];
+		putback -= start_putback[i];
+		if(  gimme  ||  putback  ) {
+			char name[16];
+			if(  size  ) {
+				sprintf( name, "%u", size );
+			}
+			else {
+				sprintf( name, "larger" );
+			}
+			fprintf( file, ",\"freelist_%s\":\"%llu allocated, %llu freed\"", name, (unsigned long long)gimme, (unsigned long long)putback );
+		}
+	}
+	fprintf( file, "}}\n" );
+
+	fclose(file);
+	return true;
+}
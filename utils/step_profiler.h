@@ -0,0 +1,117 @@
+/*
+ * This file is part of the Simutrans project under the artistic license.
+ * (see license.txt)
+ */
+
+#ifndef utils_step_profiler_h
+#define utils_step_profiler_h
+
+#include <atomic>
+
+#include "../simtypes.h"
+
+class cbuffer_t;
+
+
+/**
+ * Timing of the phases of karte_t::step() and sync_step(), including the
+ * work done on the worker threads, to find out where a slow server spends its time.
+ *
+ * While disabled, a scoped timer costs one test of a static flag.
+ * While enabled, each thread records its timer events on its own; they are
+ * collected when a step ends, summed up per phase, and kept for a timeline,
+ * up to a fixed limit.
+ *
+ * The results can be written as CSV (one line per step, one column per phase)
+ * or as a timeline in the Chrome trace event format (chrome://tracing).
+ * The timeline also contains the number of freelist nodes handed out per size.
+ */
+class step_profiler_t
+{
+public:
+	enum phase_t {
+		STEP,               ///< the whole of karte_t::step()
+		SYNC_STEP,
+		NEW_MONTH,
+		PRIVATE_CAR_ROUTES,
+		SEASONS,
+		PATH_EXPLORER,
+		CONVOYS_THREADED,
+		CONVOYS,
+		CITIES,
+		PASSENGERS_AND_MAIL,
+		AWAIT_PASSENGERS_AND_MAIL,
+		FACTORIES,
+		POWERNET,
+		PLAYERS,
+		HALTS,
+		REROUTE,
+		TRANSFERRING_CARGOES,
+		TIME_INTERVAL_SIGNALS,
+		RESERVATIONS,       ///< rail_vehicle_t::block_reserver() when reserving, within the phases above
+		MAX_PHASES
+	};
+
+private:
+	/// read by all threads which record
+	static std::atomic<bool> enabled;
+
+public:
+	static bool is_enabled() { return enabled.load( std::memory_order_relaxed ); }
+
+	/// Starts or stops recording; starting discards any earlier results
+	static void set_enabled(bool on);
+
+	static const char *get_phase_name(phase_t phase);
+
+	/// @returns a monotonic time stamp in microseconds
+	static uint64 get_time_us();
+
+	/// Records that @p phase ran from @p start to @p end on the calling thread
+	static void add(phase_t phase, uint64 start, uint64 end);
+
+	/**
+	 * Closes the summary of the current step. Time recorded between two calls
+	 * (such as the sync steps in between) is counted towards the step closed by the second.
+	 */
+	static void end_step(uint32 step_nr);
+
+	/// @returns the microseconds spent in @p phase since profiling was started, also in the steps which were not kept
+	static uint64 get_total_us(phase_t phase);
+
+	/// Appends the freelist nodes handed out and returned per size since profiling was started
+	static void print_allocations(cbuffer_t &buf);
+
+	/// Writes one line per step with the microseconds spent in each phase
+	static bool write_csv(const char *filename);
+
+	/// Writes all recorded timer events in the Chrome trace event format
+	static bool write_trace(const char *filename);
+};
+
+
+/**
+ * Times the enclosing scope as one phase, if the profiler is enabled.
+ */
+class step_profiler_scope_t
+{
+	const step_profiler_t::phase_t phase;
+	const bool active;
+	const uint64 start;
+
+public:
+	explicit step_profiler_scope_t(step_profiler_t::phase_t p) :
+		phase(p),
+		active(step_profiler_t::is_enabled()),
+		start(active ? step_profiler_t::get_time_us() : 0)
+	{}
+
+	~step_profiler_scope_t()
+	{
+		if(  active  ) {
+			step_profiler_t::add( phase, start, step_profiler_t::get_time_us() );
+		}
+	}
+};
+
+#endif
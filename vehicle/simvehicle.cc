@@ -69,9 +69,11 @@
 #include "../dataobj/loadsave.h"
 #include "../dataobj/environment.h"
 #include "../dataobj/way_constraints.h"
+#include "../dataobj/block_graph.h"
 
 #include "../utils/simstring.h"
 #include "../utils/cbuffer_t.h"
+#include "../utils/step_profiler.h"
 
 #include "../utils/simrandom.h"
 #include "../descriptor/goods_desc.h"
@@ -1646,7 +1648,7 @@ void vehicle_t::leave_tile()
 	vehicle_base_t::leave_tile();
 #ifndef DEBUG_ROUTES
 	if(last  &&  reliefkarte_t::is_visible) {
-			reliefkarte_t::get_karte()->calc_map_pixel(get_pos().get_2d());
+			reliefkarte_t::get_karte()->calc_vehicle_pixel(get_pos().get_2d());
 	}
 #endif
 }
@@ -1661,7 +1663,7 @@ void vehicle_t::enter_tile(grund_t* gr)
 {
 	vehicle_base_t::enter_tile(gr);
 	if(leading  &&  reliefkarte_t::is_visible  ) {
-		reliefkarte_t::get_karte()->calc_map_pixel( get_pos().get_2d() );  //"Set relief colour" (Babelfish)
+		reliefkarte_t::get_karte()->calc_vehicle_pixel( get_pos().get_2d() );  //"Set relief colour" (Babelfish)
 	}
 }
 
@@ -3026,7 +3028,7 @@ vehicle_t::~vehicle_t()
 {
 	if(!welt->is_destroying()) {
 		// remove vehicle's marker from the relief map
-		reliefkarte_t::get_karte()->calc_map_pixel(get_pos().get_2d());
+		reliefkarte_t::get_karte()->calc_vehicle_pixel(get_pos().get_2d());
 	}
 
 	delete[] class_reassignments;
@@ -5647,6 +5649,37 @@ void rail_vehicle_t::find_next_signal(route_t* route, uint16 start_index, uint16
 	}
 }
 
+/**
+ * Times the outermost reserving call of block_reserver() as step_profiler_t::RESERVATIONS.
+ * Reserving is only done on the main thread, so a plain counter finds the nested calls.
+ */
+class reservation_timer_t
+{
+	static uint32 depth;
+	const bool counted;
+	const bool active;
+	const uint64 start;
+
+public:
+	explicit reservation_timer_t(bool reserve) :
+		counted(reserve && step_profiler_t::is_enabled()),
+		active(counted && depth++ == 0),
+		start(active ? step_profiler_t::get_time_us() : 0)
+	{}
+
+	~reservation_timer_t()
+	{
+		if(  counted  ) {
+			depth--;
+		}
+		if(  active  ) {
+			step_profiler_t::add( step_profiler_t::RESERVATIONS, start, step_profiler_t::get_time_us() );
+		}
+	}
+};
+
+uint32 reservation_timer_t::depth = 0;
+
 /*
  * reserves or un-reserves all blocks and returns whether it succeeded.
  * if count is larger than 1, (and defined) maximum welt->get_settings().get_max_choose_route_steps() tiles will be checked
@@ -5656,6 +5689,7 @@ void rail_vehicle_t::find_next_signal(route_t* route, uint16 start_index, uint16
  */
 sint32 rail_vehicle_t::block_reserver(route_t *route, uint16 start_index, uint16 modified_sighting_distance_tiles, uint16 &next_signal_index, int count, bool reserve, bool force_unreserve, bool is_choosing, bool is_from_token, bool is_from_starter, bool is_from_directional, uint32 brake_steps, uint16 first_one_train_staff_index, bool from_call_on, bool *break_loop)
 {
+	reservation_timer_t reservation_timer(reserve);
 	bool success = true;
 	sint32 max_tiles = 2 * welt->get_settings().get_max_choose_route_steps(); // max tiles to check for choosesignals
 
@@ -5776,6 +5810,8 @@ sint32 rail_vehicle_t::block_reserver(route_t *route, uint16 start_index, uint16
 	roadsign_t::signal_aspects next_time_interval_state = roadsign_t::danger;
 	roadsign_t::signal_aspects first_time_interval_state = roadsign_t::advance_caution; // A time interval signal will never be in advance caution, so this is a placeholder to indicate that this value has not been set.
 	signal_t* station_signal_to_clear_for_entry = NULL;
+	// the section of track behind the last signal passed while reserving
+	block_graph_t::cursor_t block_cursor;
 
 	if(working_method == drive_by_sight)
 	{
@@ -5875,7 +5911,9 @@ sint32 rail_vehicle_t::block_reserver(route_t *route, uint16 start_index, uint16
 				}
 			}
 
-			roadsign_t* rs = gr->find<roadsign_t>();
+			// Between the signals, the stops and signs on the route are known from the signal block graph
+			const block_graph_t::tile_t* block_tile = block_cursor.advance(pos);
+			roadsign_t* rs = block_tile && !block_tile->has_roadsign ? NULL : gr->find<roadsign_t>();
 			ribi_t::ribi ribi = ribi_type(route->at(max(1u,i)-1u), route->at(min(route->get_count()-1u,i+1u)));
 
 			if(working_method == moving_block)
@@ -5891,7 +5929,11 @@ sint32 rail_vehicle_t::block_reserver(route_t *route, uint16 start_index, uint16
 				}
 			}
 
-			halthandle_t check_halt = haltestelle_t::get_halt(pos, NULL);
+			halthandle_t check_halt = block_tile ? block_tile->halt : haltestelle_t::get_halt(pos, NULL);
+			if(sch1->has_signal() && i + 1 < route->get_count())
+			{
+				block_cursor.enter(pos, route->at(i + 1), get_waytype());
+			}
 
 			if(check_halt.is_bound() && (check_halt == this_halt))
 			{